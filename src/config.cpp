@@ -4,12 +4,161 @@
 #include <fstream>
 #include <algorithm>
 #include <cctype>
+#include <cwchar>
+#include <memory>
 
 Config& Config::instance() {
     static Config s;
     return s;
 }
 
+std::atomic<const Config*> Config::s_current{&Config::instance()};
+std::atomic<uint32_t>      Config::s_generation{0};
+
+// ============================================================================
+// Hot reload
+// ============================================================================
+namespace {
+
+// Writes to the ini usually come as a burst (editors truncate, then write,
+// then touch metadata); wait for it to settle before parsing.
+constexpr DWORD kReloadSettleMs = 250;
+
+struct ConfigWatcher {
+    HANDLE       thread = nullptr;
+    HANDLE       stop   = nullptr;
+    HANDLE       exited = nullptr;   // set by the thread as it leaves its loop
+    std::wstring iniPath;
+    // Every snapshot ever published. Readers hold plain references, so
+    // superseded ones are kept until the DLL unloads (a few KB per edit).
+    std::vector<std::unique_ptr<const Config>> published;
+};
+
+// Never destroyed: a watcher that could not be confirmed stopped at unload
+// may still be publishing into it when the CRT runs static destructors.
+ConfigWatcher& g_watcher = *new ConfigWatcher();
+
+bool lastWriteTime(const std::wstring& path, ULONGLONG& out) {
+    WIN32_FILE_ATTRIBUTE_DATA data;
+    if (!GetFileAttributesExW(path.c_str(), GetFileExInfoStandard, &data))
+        return false;
+    out = (static_cast<ULONGLONG>(data.ftLastWriteTime.dwHighDateTime) << 32) |
+          data.ftLastWriteTime.dwLowDateTime;
+    return true;
+}
+
+} // namespace
+
+void Config::startWatching(const wchar_t* iniPath) {
+    if (g_watcher.thread || !iniPath) return;
+    g_watcher.iniPath = iniPath;
+
+    g_watcher.stop   = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+    g_watcher.exited = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+    if (g_watcher.stop && g_watcher.exited)
+        g_watcher.thread = CreateThread(nullptr, 0, &Config::watchThreadProc, nullptr, 0, nullptr);
+    if (!g_watcher.thread) {
+        LOG_WARN("Config: could not start the dinput8.ini watcher (%lu)", GetLastError());
+        if (g_watcher.stop)   CloseHandle(g_watcher.stop);
+        if (g_watcher.exited) CloseHandle(g_watcher.exited);
+        g_watcher.stop = g_watcher.exited = nullptr;
+    }
+}
+
+void Config::stopWatching() {
+    if (!g_watcher.thread) return;
+    SetEvent(g_watcher.stop);
+
+    // Under the loader lock (DLL_PROCESS_DETACH) the thread handle is not
+    // signalled until DllMain returns, so wait for the thread to leave its
+    // loop instead; the handle covers a thread already terminated at process
+    // exit. If neither comes in time, a reload may still be running: leave
+    // its events alone and the watcher marked running.
+    HANDLE handles[2] = { g_watcher.exited, g_watcher.thread };
+    if (WaitForMultipleObjects(2, handles, FALSE, 500) == WAIT_TIMEOUT) {
+        LOG_WARN("Config: dinput8.ini watcher did not stop in time");
+        return;
+    }
+    CloseHandle(g_watcher.thread);
+    CloseHandle(g_watcher.stop);
+    CloseHandle(g_watcher.exited);
+    g_watcher.thread = g_watcher.stop = g_watcher.exited = nullptr;
+}
+
+DWORD WINAPI Config::watchThreadProc(LPVOID) {
+    // Watch the directory: editors often replace the file rather than
+    // rewrite it, which a handle on the file itself would miss.
+    std::wstring dir = g_watcher.iniPath;
+    size_t slash = dir.find_last_of(L"\\/");
+    dir = slash == std::wstring::npos ? L"." : dir.substr(0, slash);
+
+    HANDLE change = FindFirstChangeNotificationW(
+        dir.c_str(), FALSE, FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_FILE_NAME);
+    if (change == INVALID_HANDLE_VALUE) {
+        LOG_WARN("Config: cannot watch %ls (%lu), hot reload disabled",
+                 dir.c_str(), GetLastError());
+        SetEvent(g_watcher.exited);
+        return 0;
+    }
+    LOG_INFO("Config: watching %ls for changes", g_watcher.iniPath.c_str());
+
+    ULONGLONG seen = 0;
+    lastWriteTime(g_watcher.iniPath, seen);
+
+    HANDLE handles[2] = { g_watcher.stop, change };
+    for (;;) {
+        if (WaitForMultipleObjects(2, handles, FALSE, INFINITE) != WAIT_OBJECT_0 + 1)
+            break;
+        // The log file lives in the same directory, so most wakeups are not
+        // for us; settling first also caps how often we look.
+        if (WaitForSingleObject(g_watcher.stop, kReloadSettleMs) == WAIT_OBJECT_0)
+            break;
+        FindNextChangeNotification(change);
+
+        ULONGLONG written = 0;
+        if (!lastWriteTime(g_watcher.iniPath, written) || written == seen)
+            continue;
+        seen = written;
+        reload(g_watcher.iniPath.c_str());
+    }
+
+    FindCloseChangeNotification(change);
+    SetEvent(g_watcher.exited);   // nothing below touches shared state
+    return 0;
+}
+
+void Config::reload(const wchar_t* iniPath) {
+    std::unique_ptr<Config> fresh(new Config());
+    if (!fresh->load(iniPath)) {
+        LOG_WARN("Config: %ls changed but could not be read, keeping current settings",
+                 iniPath);
+        return;
+    }
+
+    const Config& old = current();
+    Logger::instance().setLevel(fresh->logLevel);
+
+    // Settings wired in at startup or when a device is created.
+    if (fresh->enabled != old.enabled || fresh->ffbTrace != old.ffbTrace ||
+        fresh->ffbTraceSizeMB != old.ffbTraceSizeMB ||
+        fresh->ffbStateJournal != old.ffbStateJournal ||
+        fresh->ffbStateJournalMaxAge != old.ffbStateJournalMaxAge)
+        LOG_WARN("Config: wrapper Enabled, TraceFile and StateJournal changes "
+                 "need a restart of the game");
+    if (fresh->ffbEnabled != old.ffbEnabled || fresh->ffbCoalesceHz != old.ffbCoalesceHz ||
+        fresh->ffbAsyncCommands != old.ffbAsyncCommands ||
+        fresh->ffbAutoRestart != old.ffbAutoRestart || fresh->ffbPrewarm != old.ffbPrewarm ||
+        fresh->ffbEvictOnDeviceFull != old.ffbEvictOnDeviceFull)
+        LOG_INFO("Config: FFB enable, CoalesceHz, AsyncCommands, AutoRestart, Prewarm and "
+                 "EvictOnDeviceFull changes apply to devices created from now on");
+
+    const Config* published = fresh.get();
+    g_watcher.published.push_back(std::move(fresh));
+    s_current.store(published, std::memory_order_release);
+    uint32_t gen = s_generation.fetch_add(1, std::memory_order_acq_rel) + 1;
+    LOG_INFO("Config reloaded from %ls (generation %u)", iniPath, gen);
+}
+
 std::wstring Config::trim(const std::wstring& s) {
     auto start = s.find_first_not_of(L" \t\r\n");
     if (start == std::wstring::npos) return L"";
@@ -58,6 +207,8 @@ bool Config::load(const wchar_t* iniPath) {
                 if (lvl >= 0 && lvl <= 4)
                     logLevel = static_cast<LogLevel>(lvl);
             }
+            else if (keyLo == L"hotreload")
+                hotReload = (valLo == L"true" || valLo == L"1");
         }
         else if (section == L"ffb") {
             if (keyLo == L"enabled")
@@ -70,48 +221,271 @@ bool Config::load(const wchar_t* iniPath) {
             }
             else if (keyLo == L"autorestart")
                 ffbAutoRestart = (valLo == L"true" || valLo == L"1");
+            else if (keyLo == L"restorerampms") {
+                int ms = _wtoi(value.c_str());
+                ffbRestoreRampMs = std::clamp(ms, 0, 10000);
+            }
+            else if (keyLo == L"autoreacquire")
+                ffbAutoReacquire = (valLo == L"true" || valLo == L"1");
+            else if (keyLo == L"prewarm")
+                ffbPrewarm = (valLo == L"true" || valLo == L"1");
+            else if (keyLo == L"evictondevicefull")
+                ffbEvictOnDeviceFull = (valLo == L"true" || valLo == L"1");
+            else if (keyLo == L"statusmaxagems") {
+                int ms = _wtoi(value.c_str());
+                ffbStatusMaxAgeMs = std::clamp(ms, 0, 60000);
+            }
+            else if (keyLo == L"tracefile")
+                ffbTrace = (valLo == L"true" || valLo == L"1");
+            else if (keyLo == L"tracesizemb") {
+                int s = _wtoi(value.c_str());
+                ffbTraceSizeMB = std::clamp(s, 1, 1024);
+            }
+            else if (keyLo == L"suppressredundant")
+                ffbSuppressRedundant = (valLo == L"true" || valLo == L"1");
+            else if (keyLo == L"paramdeadband") {
+                int d = _wtoi(value.c_str());
+                ffbParamDeadband = std::clamp(d, 0, 10000);
+            }
+            else if (keyLo == L"coalescehz") {
+                int hz = _wtoi(value.c_str());
+                ffbCoalesceHz = hz <= 0 ? 0 : std::clamp(hz, 50, 4000);
+            }
+            else if (keyLo == L"asynccommands")
+                ffbAsyncCommands = (valLo == L"true" || valLo == L"1");
+            else if (keyLo == L"statejournal")
+                ffbStateJournal = (valLo == L"true" || valLo == L"1");
+            else if (keyLo == L"statejournalmaxage") {
+                int s = _wtoi(value.c_str());
+                ffbStateJournalMaxAge = std::max(s, 0);
+            }
+        }
+        else if (section == L"ffbcurves") {
+            parseCurve(key, valLo);
         }
         else if (section == L"ffbdevices") {
             DeviceRule rule;
             rule.nameMatch = key;  // keep original case for display
+            if (parseGuid(key, rule.guid))
+                rule.kind = DeviceRuleKind::Guid;
+            else if (parseVidPid(keyLo, rule.vendorId, rule.productId))
+                rule.kind = DeviceRuleKind::VidPid;
 
-            if (valLo == L"block") {
-                rule.ffbEnabled = false;
-                rule.ffbScale   = 0;
-            }
-            else if (valLo == L"allow") {
-                rule.ffbEnabled = true;
-                rule.ffbScale   = 100;
-            }
-            else {
-                int s = _wtoi(value.c_str());
-                rule.ffbEnabled = (s > 0);
-                rule.ffbScale   = std::clamp(s, 0, 100);
-            }
+            parseRuleAction(valLo, rule);
             deviceRules.push_back(rule);
         }
     }
 
+    resolveCurves();
+    compileRules();
+    return true;
+}
+
+// ============================================================================
+// [FFBCurves]
+// ============================================================================
+
+// Name = stage value [stage value ...], e.g. "Soft = gamma 1.6 softlimit 0.8".
+bool Config::parseCurve(const std::wstring& key, const std::wstring& valLo) {
+    std::wstring spec = trim(valLo.substr(0, valLo.find(L';')));
+    std::string narrow;
+    for (wchar_t c : spec)
+        narrow += (c > 0 && c < 0x80) ? static_cast<char>(c) : '?';
+
+    std::vector<FFBCurve::Step> steps;
+    if (!FFBCurve::parse(narrow, steps)) {
+        LOG_WARN("Config: [FFBCurves] %ls: cannot parse '%ls'", key.c_str(), spec.c_str());
+        return false;
+    }
+    std::wstring keyLo = toLower(key);
+    if (findCurve(keyLo)) {
+        LOG_WARN("Config: [FFBCurves] %ls defined twice, keeping the first", key.c_str());
+        return false;
+    }
+
+    char name[128];
+    int n = WideCharToMultiByte(CP_UTF8, 0, key.c_str(), static_cast<int>(key.size()),
+                                name, sizeof(name) - 1, nullptr, nullptr);
+    name[n > 0 ? n : 0] = '\0';
+    curves.push_back(FFBCurve::bake(name, std::move(steps)));
+    m_curveNames.push_back(std::move(keyLo));
     return true;
 }
 
-void Config::getDevicePolicy(const wchar_t* productName,
-                             bool& outEnabled, int& outScale) const
-{
-    // Default: use global settings
-    outEnabled = ffbEnabled;
-    outScale   = ffbDefaultScale;
+FFBCurvePtr Config::findCurve(const std::wstring& nameLo) const {
+    for (size_t i = 0; i < m_curveNames.size(); ++i)
+        if (m_curveNames[i] == nameLo) return curves[i];
+    return nullptr;
+}
+
+// Rules may name curves defined further down the file; look them up once
+// everything is read.
+void Config::resolveCurves() {
+    auto resolve = [&](const DeviceRule& rule, const std::wstring& nameLo) -> FFBCurvePtr {
+        if (nameLo.empty()) return nullptr;
+        FFBCurvePtr c = findCurve(nameLo);
+        if (!c)
+            LOG_WARN("Config: [FFBDevices] %ls: unknown curve '%ls', using linear response",
+                     rule.nameMatch.c_str(), nameLo.c_str());
+        return c;
+    };
+    for (DeviceRule& rule : deviceRules) {
+        rule.curve = resolve(rule, rule.curveName);
+        for (EffectTypeRule& e : rule.effects)
+            e.curve = resolve(rule, e.curveName);
+    }
+}
+
+// ============================================================================
+// [FFBDevices] rules
+// ============================================================================
+
+// {xxxxxxxx-xxxx-xxxx-xxxx-xxxxxxxxxxxx}, as DirectInput tools print them.
+bool Config::parseGuid(const std::wstring& s, GUID& out) {
+    if (s.size() != 38 || s.front() != L'{' || s.back() != L'}') return false;
+    unsigned long d1 = 0;
+    unsigned int  d2 = 0, d3 = 0, b[8] = {};
+    wchar_t tail = 0;
+    if (swscanf(s.c_str(), L"{%8lx-%4x-%4x-%2x%2x-%2x%2x%2x%2x%2x%2x%lc",
+                &d1, &d2, &d3, &b[0], &b[1], &b[2], &b[3], &b[4], &b[5], &b[6], &b[7],
+                &tail) != 12 || tail != L'}')
+        return false;
+    out.Data1 = static_cast<DWORD>(d1);
+    out.Data2 = static_cast<WORD>(d2);
+    out.Data3 = static_cast<WORD>(d3);
+    for (int i = 0; i < 8; ++i)
+        out.Data4[i] = static_cast<BYTE>(b[i]);
+    return true;
+}
+
+// vid_231d&pid_0200 or vid_231d (already lower-cased), hex as in device paths.
+bool Config::parseVidPid(const std::wstring& s, uint16_t& vendorId, int& productId) {
+    unsigned int vid = 0, pid = 0;
+    wchar_t tail = 0;
+    if (swscanf(s.c_str(), L"vid_%4x&pid_%4x%lc", &vid, &pid, &tail) == 2) {
+        vendorId  = static_cast<uint16_t>(vid);
+        productId = static_cast<int>(pid);
+        return true;
+    }
+    if (s.size() == 8 && swscanf(s.c_str(), L"vid_%4x%lc", &vid, &tail) == 1) {
+        vendorId  = static_cast<uint16_t>(vid);
+        productId = -1;
+        return true;
+    }
+    return false;
+}
+
+// "action[, Type:action ...]" with an optional trailing "; comment". An action
+// is block, allow or 0-100, optionally followed by "@Curve"; Type is an
+// effect kind name (Spring, Sine, ...).
+void Config::parseRuleAction(const std::wstring& valLo, DeviceRule& rule) {
+    std::wstring v = trim(valLo.substr(0, valLo.find(L';')));
 
-    if (!productName) return;
+    // "80 @soft" -> "80" and curve "soft".
+    auto splitCurve = [](const std::wstring& a, std::wstring& curve) {
+        size_t at = a.find(L'@');
+        if (at == std::wstring::npos) return a;
+        curve = trim(a.substr(at + 1));
+        return trim(a.substr(0, at));
+    };
 
-    std::wstring nameLo = toLower(productName);
+    // Only the keyword blocks; a numeric 0 is a scale like any other.
+    auto parseAction = [](const std::wstring& a, bool& blocked, int& scale) {
+        blocked = (a == L"block");
+        if (blocked)
+            scale = 0;
+        else if (a == L"allow")
+            scale = 100;
+        else
+            scale = std::clamp(_wtoi(a.c_str()), 0, 100);
+    };
 
-    for (const auto& rule : deviceRules) {
-        std::wstring matchLo = toLower(rule.nameMatch);
-        if (nameLo.find(matchLo) != std::wstring::npos) {
-            outEnabled = rule.ffbEnabled;
-            outScale   = rule.ffbScale;
-            return;  // first match wins
+    size_t comma = v.find(L',');
+    std::wstring action = splitCurve(trim(v.substr(0, comma)), rule.curveName);
+    if (action.empty() && !rule.curveName.empty())
+        action = L"allow";   // "=@soft": just the curve
+    bool blocked = false;
+    parseAction(action, blocked, rule.ffbScale);
+    rule.ffbEnabled = !blocked && rule.ffbScale > 0;   // "0" silences the whole device
+
+    while (comma != std::wstring::npos) {
+        size_t start = comma + 1;
+        comma = v.find(L',', start);
+        std::wstring entry = trim(v.substr(start, comma == std::wstring::npos
+                                                      ? std::wstring::npos : comma - start));
+        size_t colon = entry.find(L':');
+        if (entry.empty() || colon == std::wstring::npos) continue;
+
+        std::wstring type = trim(entry.substr(0, colon));
+        size_t kind = 0;
+        for (; kind < kEffectKindCount; ++kind) {
+            std::string name = effectKindName(static_cast<EffectKind>(kind));
+            if (type == toLower(std::wstring(name.begin(), name.end()))) break;
         }
+        if (kind == kEffectKindCount) {
+            LOG_WARN("Config: [FFBDevices] %ls: unknown effect type '%ls'",
+                     rule.nameMatch.c_str(), type.c_str());
+            continue;
+        }
+
+        EffectTypeRule& e = rule.effects[kind];
+        action = splitCurve(trim(entry.substr(colon + 1)), e.curveName);
+        if (action.empty() && !e.curveName.empty())
+            continue;   // "Spring:@soft": curve only, device scale
+        parseAction(action, e.blocked, e.scale);
+        e.set = true;
+    }
+}
+
+bool DeviceRule::matchesIdentity(const DeviceIdentity& device) const {
+    switch (kind) {
+    case DeviceRuleKind::VidPid:
+        return device.hasVidPid() && device.vendorId == vendorId &&
+               (productId < 0 || device.productId == productId);
+    case DeviceRuleKind::Guid:
+        return device.productGuid == guid || device.instanceGuid == guid;
+    default:
+        return false;
+    }
+}
+
+void Config::compileRules() {
+    std::vector<DeviceRuleMatcher::Pattern> patterns;
+    m_identityRules.clear();
+    for (size_t i = 0; i < deviceRules.size(); ++i) {
+        if (deviceRules[i].kind == DeviceRuleKind::Name)
+            patterns.push_back({ i, deviceRules[i].nameMatch });
+        else
+            m_identityRules.push_back(i);
+    }
+    m_ruleMatcher.build(patterns);
+}
+
+// Index of the first rule matching device, or DeviceRuleMatcher::kNoMatch.
+size_t Config::matchRule(const DeviceIdentity& device) const {
+    size_t best = m_ruleMatcher.firstMatch(device.productName.c_str());
+    for (size_t i : m_identityRules) {
+        if (i >= best) break;
+        if (deviceRules[i].matchesIdentity(device)) return i;
+    }
+    return best;
+}
+
+const DeviceRule* Config::findDeviceRule(const DeviceIdentity& device) const {
+    AcquireSRWLockShared(&m_policyCacheLock);
+    auto it = std::find_if(m_policyCache.begin(), m_policyCache.end(),
+                           [&](const std::pair<GUID, size_t>& e) {
+                               return e.first == device.instanceGuid;
+                           });
+    bool cached = it != m_policyCache.end();
+    size_t rule = cached ? it->second : DeviceRuleMatcher::kNoMatch;
+    ReleaseSRWLockShared(&m_policyCacheLock);
+
+    if (!cached) {
+        rule = matchRule(device);
+        AcquireSRWLockExclusive(&m_policyCacheLock);
+        m_policyCache.emplace_back(device.instanceGuid, rule);
+        ReleaseSRWLockExclusive(&m_policyCacheLock);
     }
+    return rule < deviceRules.size() ? &deviceRules[rule] : nullptr;
 }
@@ -2,43 +2,135 @@
 // Copyright (c) 2026 Valmantas Paliksa
 #pragma once
 
+#include <windows.h>
+#include <array>
+#include <atomic>
+#include <cstdint>
 #include <string>
 #include <vector>
+#include "device_identity.h"
+#include "device_rule_matcher.h"
+#include "effect_kind.h"
+#include "ffb_curve.h"
 #include "logger.h"
 
+// What a [FFBDevices] key matches on, decided by its form.
+enum class DeviceRuleKind : uint8_t {
+    Name,     // anything else: product name substring
+    VidPid,   // VID_231D&PID_0200, or VID_231D for every product of a vendor
+    Guid,     // {xxxxxxxx-...}: product GUID or instance GUID
+};
+
+// Per-effect-type entry of a rule ("Spring:60", "Sine:block", "Spring:@Soft"):
+// the type is blocked (scale 0), or scaled by this instead of the rule's
+// device scale, and/or shaped by its own response curve.
+struct EffectTypeRule {
+    bool set     = false;
+    bool blocked = false;   // "Type:block": never created on the device
+    int  scale   = 100;     // 0-100 percentage; 0 is silent but still created
+    std::wstring curveName;   // lower-cased [FFBCurves] name, empty = device curve
+    FFBCurvePtr  curve;       // resolved from curveName once the file is read
+};
+
 struct DeviceRule {
-    std::wstring nameMatch;    // Case-insensitive substring to match against product name
+    std::wstring nameMatch;    // key as written: name substring for Name rules
+    DeviceRuleKind kind = DeviceRuleKind::Name;
+    uint16_t     vendorId  = 0;       // VidPid
+    int          productId = -1;      // VidPid, -1 = any product
+    GUID         guid{};              // Guid
     bool         ffbEnabled;   // true = allow FFB, false = block FFB
     int          ffbScale;     // 0-100 scale percentage (only meaningful when ffbEnabled=true)
+    std::wstring curveName;    // "80 @Soft": lower-cased [FFBCurves] name
+    FFBCurvePtr  curve;        // response curve for every type, nullptr = linear
+    std::array<EffectTypeRule, kEffectKindCount> effects{};   // by effectKindIndex
+
+    // Whether a VidPid or Guid rule matches device (Name rules: false).
+    bool matchesIdentity(const DeviceIdentity& device) const;
 };
 
 class Config {
 public:
+    // Settings as loaded at startup. Process-wide things (trace file, state
+    // journal, the wrapper master switch) are set up from this and stay put.
     static Config& instance();
 
+    // Newest settings: instance() until the first hot reload, then the latest
+    // re-parsed dinput8.ini. Snapshots are immutable and never freed while the
+    // DLL is loaded, so the reference stays valid without locking.
+    static const Config& current() { return *s_current.load(std::memory_order_acquire); }
+    // Bumped each time a reload is published; cheap to poll.
+    static uint32_t generation() { return s_generation.load(std::memory_order_acquire); }
+
+    // Re-parse iniPath on a background thread whenever it is written
+    // ([General] HotReload). stopWatching stops the thread; it is bounded and
+    // safe under the loader lock, and frees nothing the thread may still use.
+    static void startWatching(const wchar_t* iniPath);
+    static void stopWatching();
+
     // Load from INI file. Returns true if file was found and parsed.
     bool load(const wchar_t* iniPath);
 
     // [General]
     bool     enabled   = true;
     LogLevel logLevel  = LogLevel::Info;
+    bool     hotReload = true;   // watch dinput8.ini and apply edits while running
 
     // [FFB]
     bool ffbEnabled      = true;
     bool ffbLogEffects   = true;
     int  ffbDefaultScale = 100;
     bool ffbAutoRestart  = true;   // auto-restart effects after device reconnect
+    int  ffbRestoreRampMs = 500;   // soft-start window for auto-restarted effects (0 = off)
+    bool ffbAutoReacquire = true;  // re-acquire a device that lost input under the game
+    bool ffbPrewarm       = false; // build a returning device's running effects at CreateDevice
+    bool ffbEvictOnDeviceFull = true;  // unload the LRU idle effect on DIERR_DEVICEFULL
+    int  ffbStatusMaxAgeMs = 0;    // status queries answered from shadows this fresh (0 = off)
+    bool ffbTrace        = false;  // binary trace of every FFB call (dinput8_ffb_trace.bin)
+    int  ffbTraceSizeMB  = 64;     // trace ring file size
+    bool ffbSuppressRedundant = true;  // skip SetParameters identical to the last one sent
+    int  ffbParamDeadband     = 0;     // magnitude change ignored by the suppression cache
+    int  ffbCoalesceHz        = 0;     // >0: latest-wins SetParameters flushed at this rate
+    bool ffbAsyncCommands     = false; // run Start/Stop/Download/commands off the game thread
+    bool ffbStateJournal      = false; // persist effect state to dinput8_ffb_state.bin
+    int  ffbStateJournalMaxAge = 600;  // seconds; older journals are not restored (0 = any)
+
+    // [FFBCurves] — named response curves, baked into lookup tables on load
+    std::vector<FFBCurvePtr> curves;
 
     // [FFBDevices] — ordered rules, first match wins
     std::vector<DeviceRule> deviceRules;
 
-    // Look up the FFB policy for a given device product name.
-    // Writes results into outEnabled and outScale.
-    void getDevicePolicy(const wchar_t* productName,
-                         bool& outEnabled, int& outScale) const;
+    // First rule matching the device's name, VID/PID or GUIDs, or nullptr
+    // (the [FFB] defaults apply). The answer is remembered per instance GUID;
+    // the cache lives and dies with this snapshot, so a reload starts over
+    // with the new rules.
+    const DeviceRule* findDeviceRule(const DeviceIdentity& device) const;
 
 private:
     Config() = default;
+    Config(const Config&) = delete;
+
+    size_t matchRule(const DeviceIdentity& device) const;
+    void   compileRules();
+    static bool parseGuid(const std::wstring& s, GUID& out);
+    static bool parseVidPid(const std::wstring& s, uint16_t& vendorId, int& productId);
+    static void parseRuleAction(const std::wstring& valLo, DeviceRule& rule);
+    bool        parseCurve(const std::wstring& key, const std::wstring& valLo);
+    void        resolveCurves();
+    FFBCurvePtr findCurve(const std::wstring& nameLo) const;
+
+    std::vector<std::wstring> m_curveNames;   // lower-cased, parallel to curves
+    DeviceRuleMatcher   m_ruleMatcher;     // Name rules, compiled by load()
+    std::vector<size_t> m_identityRules;   // VidPid/Guid rule indices, in order
+    mutable SRWLOCK   m_policyCacheLock = SRWLOCK_INIT;
+    mutable std::vector<std::pair<GUID, size_t>> m_policyCache;   // instance -> rule
+
+    static DWORD WINAPI watchThreadProc(LPVOID param);
+    static void reload(const wchar_t* iniPath);
+
+    static std::atomic<const Config*> s_current;
+    static std::atomic<uint32_t>      s_generation;
+
     static std::wstring trim(const std::wstring& s);
     static std::wstring toLower(const std::wstring& s);
 };
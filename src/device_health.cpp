@@ -0,0 +1,62 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026 Valmantas Paliksa
+#include "device_health.h"
+
+DeviceHealth::Event DeviceHealth::onAcquire(HRESULT hr, ULONGLONG now) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    State s = m_state.load(std::memory_order_relaxed);
+
+    if (FAILED(hr)) {
+        if (s == State::Lost) ++m_attempts;
+        return Event::None;
+    }
+
+    m_state.store(State::Healthy, std::memory_order_release);
+    if (s != State::Lost) return Event::None;
+
+    m_lastOutageMs = now - m_lostAt;
+    m_lastAttempts = m_attempts + 1;
+    return Event::Recovered;
+}
+
+void DeviceHealth::onUnacquire() {
+    // The game let go on purpose; a pending outage ends unrecovered.
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_state.store(State::Idle, std::memory_order_release);
+}
+
+DeviceHealth::Event DeviceHealth::onInput(HRESULT hr, ULONGLONG now) {
+    if (SUCCEEDED(hr) && m_state.load(std::memory_order_acquire) == State::Healthy)
+        return Event::None;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    State s = m_state.load(std::memory_order_relaxed);
+
+    if (SUCCEEDED(hr)) {
+        // Reads only succeed on an acquired device, whoever acquired it.
+        m_state.store(State::Healthy, std::memory_order_release);
+        if (s != State::Lost) return Event::None;
+        m_lastOutageMs = now - m_lostAt;
+        m_lastAttempts = m_attempts;
+        return Event::Recovered;
+    }
+
+    if (s != State::Healthy || !isLostResult(hr))
+        return Event::None;
+
+    m_state.store(State::Lost, std::memory_order_release);
+    m_lostAt      = now;
+    m_nextAttempt = now;   // first re-acquire right away
+    m_attempts    = 0;
+    return Event::Lost;
+}
+
+bool DeviceHealth::shouldReacquire(ULONGLONG now) {
+    if (m_state.load(std::memory_order_acquire) != State::Lost) return false;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_state.load(std::memory_order_relaxed) != State::Lost || now < m_nextAttempt)
+        return false;
+    m_nextAttempt = now + m_retryMs;
+    return true;
+}
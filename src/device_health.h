@@ -0,0 +1,63 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026 Valmantas Paliksa
+#pragma once
+
+#include <windows.h>
+#include <dinput.h>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+
+// Per-device input health, fed with the results of the game's Acquire,
+// Unacquire, Poll, GetDeviceState and GetDeviceData calls.
+//
+//   Idle     not acquired by the game (initially and after Unacquire);
+//            DIERR_NOTACQUIRED here is the game's own doing
+//   Healthy  acquired and reading
+//   Lost     DIERR_INPUTLOST / DIERR_NOTACQUIRED while the game holds the
+//            device: unplugged, or acquisition taken away
+//
+// Only decisions live here; WrapperDevice8 makes the DirectInput calls and
+// acts on the returned events. The class sees nothing but HRESULTs and
+// GetTickCount64 values, so a scripted sequence of results drives it the
+// same way a real device does.
+class DeviceHealth {
+public:
+    enum class State : uint8_t { Idle, Healthy, Lost };
+    enum class Event : uint8_t { None, Lost, Recovered };
+
+    static constexpr DWORD kDefaultRetryMs = 250;
+
+    explicit DeviceHealth(DWORD retryMs = kDefaultRetryMs) : m_retryMs(retryMs) {}
+
+    // The game's Acquire (or our own re-acquire) returned hr.
+    Event onAcquire(HRESULT hr, ULONGLONG now);
+    void  onUnacquire();
+
+    // An input call returned hr.
+    Event onInput(HRESULT hr, ULONGLONG now);
+
+    // While Lost: true at most once per retry interval. The caller then calls
+    // Acquire itself and reports the result with onAcquire.
+    bool shouldReacquire(ULONGLONG now);
+
+    State state() const { return m_state.load(std::memory_order_acquire); }
+
+    // Outage that the last Recovered event ended.
+    ULONGLONG lastOutageMs() const { return m_lastOutageMs; }
+    unsigned  lastAttempts() const { return m_lastAttempts; }
+
+private:
+    static bool isLostResult(HRESULT hr) {
+        return hr == DIERR_INPUTLOST || hr == DIERR_NOTACQUIRED;
+    }
+
+    const DWORD        m_retryMs;
+    std::atomic<State> m_state{State::Idle};   // read lock-free on the success path
+    std::mutex         m_mutex;                // transitions
+    ULONGLONG          m_lostAt       = 0;
+    ULONGLONG          m_nextAttempt  = 0;
+    unsigned           m_attempts     = 0;
+    ULONGLONG          m_lastOutageMs = 0;
+    unsigned           m_lastAttempts = 0;
+};
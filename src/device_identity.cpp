@@ -0,0 +1,50 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026 Valmantas Paliksa
+#include "device_identity.h"
+#include <algorithm>
+#include <cstring>
+
+void DeviceIdentity::decodeVidPid() {
+    static constexpr unsigned char kPidVid[8] = { 0, 0, 'P', 'I', 'D', 'V', 'I', 'D' };
+    if (productGuid.Data2 != 0 || productGuid.Data3 != 0 ||
+        std::memcmp(productGuid.Data4, kPidVid, sizeof(kPidVid)) != 0)
+    {
+        vendorId = productId = 0;
+        return;
+    }
+    vendorId  = static_cast<uint16_t>(productGuid.Data1 & 0xFFFF);
+    productId = static_cast<uint16_t>(productGuid.Data1 >> 16);
+}
+
+DeviceIdentityTable& DeviceIdentityTable::instance() {
+    static DeviceIdentityTable s;
+    return s;
+}
+
+DeviceIdentityPtr DeviceIdentityTable::find(REFGUID requested) const {
+    DeviceIdentityPtr found;
+    AcquireSRWLockShared(&m_lock);
+    for (const auto& e : m_entries) {
+        if (e.first == requested) {
+            found = e.second;
+            break;
+        }
+    }
+    ReleaseSRWLockShared(&m_lock);
+    return found;
+}
+
+DeviceIdentityPtr DeviceIdentityTable::insert(REFGUID requested, DeviceIdentity identity) {
+    auto stored = std::make_shared<const DeviceIdentity>(std::move(identity));
+    AcquireSRWLockExclusive(&m_lock);
+    auto it = std::find_if(m_entries.begin(), m_entries.end(),
+                           [&](const std::pair<GUID, DeviceIdentityPtr>& e) {
+                               return e.first == requested;
+                           });
+    if (it == m_entries.end())
+        m_entries.emplace_back(requested, stored);
+    else
+        stored = it->second;   // another thread got here first
+    ReleaseSRWLockExclusive(&m_lock);
+    return stored;
+}
@@ -0,0 +1,51 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026 Valmantas Paliksa
+#pragma once
+
+#include <windows.h>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Who a DirectInput device is: what [FFBDevices] rules match against and what
+// FFBStateRegistry keys effect state on.
+struct DeviceIdentity {
+    GUID         instanceGuid{};
+    GUID         productGuid{};
+    uint16_t     vendorId  = 0;   // HID VID/PID, decoded from productGuid;
+    uint16_t     productId = 0;   // both 0 for non-HID devices
+    std::wstring productName;
+
+    bool hasVidPid() const { return vendorId != 0 || productId != 0; }
+
+    // Fill vendorId/productId from a HID product GUID, which DirectInput
+    // builds as {PIDVID-0000-0000-0000-504944564944} ("PIDVID" in Data4).
+    void decodeVidPid();
+};
+
+using DeviceIdentityPtr = std::shared_ptr<const DeviceIdentity>;
+
+// Process-wide table of resolved identities, keyed by the GUID the game
+// passed to CreateDevice (normally the instance GUID from EnumDevices).
+//
+// DCS re-creates its devices on every re-enumeration; with the table the
+// GetDeviceInfo call, and for the ANSI interface the two MultiByteToWideChar
+// conversions, happen once per device per process instead of each time.
+class DeviceIdentityTable {
+public:
+    static DeviceIdentityTable& instance();
+
+    // Identity seen for requested before, or nullptr.
+    DeviceIdentityPtr find(REFGUID requested) const;
+
+    // Remember identity under requested; returns the stored copy.
+    DeviceIdentityPtr insert(REFGUID requested, DeviceIdentity identity);
+
+private:
+    DeviceIdentityTable() = default;
+
+    mutable SRWLOCK m_lock = SRWLOCK_INIT;
+    std::vector<std::pair<GUID, DeviceIdentityPtr>> m_entries;
+};
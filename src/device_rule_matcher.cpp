@@ -0,0 +1,77 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026 Valmantas Paliksa
+#include "device_rule_matcher.h"
+#include <algorithm>
+#include <cwctype>
+
+static bool edgeLess(const std::pair<wchar_t, uint32_t>& e, wchar_t c) {
+    return e.first < c;
+}
+
+uint32_t DeviceRuleMatcher::child(uint32_t node, wchar_t c) const {
+    const auto& next = m_nodes[node].next;
+    auto it = std::lower_bound(next.begin(), next.end(), c, edgeLess);
+    return (it != next.end() && it->first == c) ? it->second : 0;
+}
+
+void DeviceRuleMatcher::build(const std::vector<Pattern>& patterns) {
+    m_nodes.assign(1, Node{});
+    m_patterns = patterns.size();
+
+    // Trie of the lower-cased patterns.
+    for (const Pattern& p : patterns) {
+        uint32_t node = 0;
+        for (wchar_t raw : p.text) {
+            wchar_t c = static_cast<wchar_t>(towlower(raw));
+            uint32_t next = child(node, c);
+            if (!next) {
+                next = static_cast<uint32_t>(m_nodes.size());
+                m_nodes.emplace_back();
+                auto& edges = m_nodes[node].next;
+                edges.insert(std::lower_bound(edges.begin(), edges.end(), c, edgeLess),
+                             { c, next });
+            }
+            node = next;
+        }
+        m_nodes[node].first = std::min(m_nodes[node].first, p.rule);
+    }
+
+    // Failure links breadth first, so a state's fail target (shallower) is
+    // final before the state inherits its first-rule index.
+    std::vector<uint32_t> queue;
+    queue.reserve(m_nodes.size());
+    for (const auto& e : m_nodes[0].next)
+        queue.push_back(e.second);
+    for (size_t head = 0; head < queue.size(); ++head) {
+        uint32_t u = queue[head];
+        for (const auto& e : m_nodes[u].next) {
+            uint32_t f = m_nodes[u].fail;
+            while (f && !child(f, e.first))
+                f = m_nodes[f].fail;
+            uint32_t v = e.second;
+            m_nodes[v].fail  = child(f, e.first);
+            m_nodes[v].first = std::min(m_nodes[v].first, m_nodes[m_nodes[v].fail].first);
+            queue.push_back(v);
+        }
+    }
+
+    m_lowestRule = kNoMatch;
+    for (const Pattern& p : patterns)
+        m_lowestRule = std::min(m_lowestRule, p.rule);
+}
+
+size_t DeviceRuleMatcher::firstMatch(const wchar_t* text) const {
+    if (m_nodes.empty() || !text) return kNoMatch;
+
+    size_t best = m_nodes[0].first;   // empty pattern
+    uint32_t state = 0;
+    for (; *text && best != m_lowestRule; ++text) {
+        wchar_t c = static_cast<wchar_t>(towlower(*text));
+        uint32_t next;
+        while (!(next = child(state, c)) && state)
+            state = m_nodes[state].fail;
+        state = next;
+        best = std::min(best, m_nodes[state].first);
+    }
+    return best;
+}
@@ -0,0 +1,49 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026 Valmantas Paliksa
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+// [FFBDevices] name patterns compiled into one Aho-Corasick automaton.
+//
+// Built once per config load with the patterns already lower-cased, so a
+// lookup is a single pass over the product name however many rules there are,
+// instead of lower-casing and searching for every rule in turn. Each state
+// carries the lowest rule index that ends there or at any of its suffixes,
+// which keeps "first rule in file order wins" without collecting matches.
+//
+// Only name rules go in; VID/PID and GUID rules are checked by Config.
+class DeviceRuleMatcher {
+public:
+    static constexpr size_t kNoMatch = static_cast<size_t>(-1);
+
+    struct Pattern {
+        size_t       rule;   // index in Config::deviceRules
+        std::wstring text;   // case-insensitive substring; empty matches all
+    };
+
+    void build(const std::vector<Pattern>& patterns);
+
+    // Lowest rule index whose pattern occurs in text, or kNoMatch.
+    size_t firstMatch(const wchar_t* text) const;
+
+    size_t patternCount() const { return m_patterns; }
+
+private:
+    struct Node {
+        std::vector<std::pair<wchar_t, uint32_t>> next;   // sorted by character
+        uint32_t fail  = 0;
+        size_t   first = kNoMatch;   // lowest rule ending here or at a suffix state
+    };
+
+    // Child of node on c, or 0 (the root is never a child).
+    uint32_t child(uint32_t node, wchar_t c) const;
+
+    std::vector<Node> m_nodes;
+    size_t            m_patterns   = 0;
+    size_t            m_lowestRule = kNoMatch;   // no better answer: stop scanning
+};
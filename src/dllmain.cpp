@@ -15,6 +15,9 @@
 #include "proxy.h"
 #include "config.h"
 #include "logger.h"
+#include "ffb_trace.h"
+#include "ffb_state_journal.h"
+#include "ffb_state_registry.h"
 #include "wrapper_dinput8.h"
 
 // Globals
@@ -51,6 +54,19 @@ static void initWrapper(HMODULE hSelf) {
              Config::instance().ffbEnabled ? "true" : "false",
              Config::instance().ffbDefaultScale);
 
+    if (Config::instance().ffbTrace)
+        FFBTrace::instance().open(g_dllDirectory, Config::instance().ffbTraceSizeMB);
+
+    // Before any device is created, so restored records keep their handles.
+    if (Config::instance().ffbStateJournal &&
+        FFBStateJournal::instance().open(g_dllDirectory,
+                                         Config::instance().ffbStateJournalMaxAge))
+        FFBStateRegistry::instance().restoreFromJournal();
+
+    // Edits to dinput8.ini from here on reach devices without a restart.
+    if (Config::instance().enabled && Config::instance().hotReload)
+        Config::startWatching(iniPath);
+
     // Load the real system dinput8.dll
     if (!OriginalDI8::instance().load()) {
         LOG_ERROR("FATAL: could not load original dinput8.dll!");
@@ -69,7 +85,10 @@ BOOL APIENTRY DllMain(HMODULE hModule, DWORD dwReason, LPVOID /*lpReserved*/) {
 
         case DLL_PROCESS_DETACH:
             LOG_INFO("dinput8 wrapper unloading");
+            Config::stopWatching();
             OriginalDI8::instance().unload();
+            FFBTrace::instance().close();
+            FFBStateJournal::instance().close();
             Logger::instance().close();
             break;
     }
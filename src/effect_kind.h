@@ -0,0 +1,108 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026 Valmantas Paliksa
+#pragma once
+
+#include <windows.h>
+#include <dinput.h>
+#include <cstddef>
+#include <cstdint>
+
+#include "ffb_trace_format.h"
+
+// Dense effect-type index, resolved from the effect GUID exactly once (when
+// the WrapperEffect is created). Everything on the per-update path — scaling,
+// naming, registry slots, trace records — indexes tables with it instead of
+// comparing GUIDs.
+//
+// Values match FFBTraceEffect so trace records can store the kind directly.
+enum class EffectKind : uint8_t {
+    Unknown = 0,
+    ConstantForce,
+    RampForce,
+    Square,
+    Sine,
+    Triangle,
+    SawtoothUp,
+    SawtoothDown,
+    Spring,
+    Damper,
+    Inertia,
+    Friction,
+    CustomForce,
+    Count
+};
+
+constexpr size_t kEffectKindCount = static_cast<size_t>(EffectKind::Count);
+
+static_assert(static_cast<int>(EffectKind::Count) ==
+              static_cast<int>(FFBTraceEffect::Count) &&
+              static_cast<int>(EffectKind::CustomForce) ==
+              static_cast<int>(FFBTraceEffect::CustomForce),
+              "EffectKind must stay in sync with FFBTraceEffect");
+
+// Which type-specific struct lpvTypeSpecificParams points to.
+enum class EffectCategory : uint8_t {
+    None = 0,     // unknown / vendor-specific
+    Constant,     // DICONSTANTFORCE
+    Ramp,         // DIRAMPFORCE
+    Periodic,     // DIPERIODIC
+    Condition,    // DICONDITION[] (one per axis)
+    Custom,       // DICUSTOMFORCE
+    Count
+};
+
+struct EffectKindInfo {
+    const char*    name;
+    EffectCategory category;
+    DWORD          typeSpecificSize;   // size of one type-specific element
+};
+
+inline constexpr EffectKindInfo kEffectKindTable[kEffectKindCount] = {
+    { "Unknown",       EffectCategory::None,      0                       },
+    { "ConstantForce", EffectCategory::Constant,  sizeof(DICONSTANTFORCE) },
+    { "RampForce",     EffectCategory::Ramp,      sizeof(DIRAMPFORCE)     },
+    { "Square",        EffectCategory::Periodic,  sizeof(DIPERIODIC)      },
+    { "Sine",          EffectCategory::Periodic,  sizeof(DIPERIODIC)      },
+    { "Triangle",      EffectCategory::Periodic,  sizeof(DIPERIODIC)      },
+    { "SawtoothUp",    EffectCategory::Periodic,  sizeof(DIPERIODIC)      },
+    { "SawtoothDown",  EffectCategory::Periodic,  sizeof(DIPERIODIC)      },
+    { "Spring",        EffectCategory::Condition, sizeof(DICONDITION)     },
+    { "Damper",        EffectCategory::Condition, sizeof(DICONDITION)     },
+    { "Inertia",       EffectCategory::Condition, sizeof(DICONDITION)     },
+    { "Friction",      EffectCategory::Condition, sizeof(DICONDITION)     },
+    { "CustomForce",   EffectCategory::Custom,    sizeof(DICUSTOMFORCE)   },
+};
+
+constexpr const EffectKindInfo& effectKindInfo(EffectKind kind) {
+    return kEffectKindTable[static_cast<size_t>(kind) < kEffectKindCount
+                                ? static_cast<size_t>(kind) : 0];
+}
+
+constexpr const char* effectKindName(EffectKind kind) {
+    return effectKindInfo(kind).name;
+}
+
+constexpr EffectCategory effectKindCategory(EffectKind kind) {
+    return effectKindInfo(kind).category;
+}
+
+constexpr size_t effectKindIndex(EffectKind kind) {
+    return static_cast<size_t>(kind);
+}
+
+// The only place GUIDs are compared. Call once per effect, not per update.
+inline EffectKind effectKindFromGuid(REFGUID guid) {
+    if (guid == GUID_ConstantForce) return EffectKind::ConstantForce;
+    if (guid == GUID_RampForce)     return EffectKind::RampForce;
+    if (guid == GUID_Square)        return EffectKind::Square;
+    if (guid == GUID_Sine)          return EffectKind::Sine;
+    if (guid == GUID_Triangle)      return EffectKind::Triangle;
+    if (guid == GUID_SawtoothUp)    return EffectKind::SawtoothUp;
+    if (guid == GUID_SawtoothDown)  return EffectKind::SawtoothDown;
+    if (guid == GUID_Spring)        return EffectKind::Spring;
+    if (guid == GUID_Damper)        return EffectKind::Damper;
+    if (guid == GUID_Inertia)       return EffectKind::Inertia;
+    if (guid == GUID_Friction)      return EffectKind::Friction;
+    if (guid == GUID_CustomForce)   return EffectKind::CustomForce;
+    return EffectKind::Unknown;
+}
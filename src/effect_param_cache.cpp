@@ -0,0 +1,260 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026 Valmantas Paliksa
+#include "effect_param_cache.h"
+#include <cstdlib>
+#include <cstring>
+#include <utility>
+
+// Fields we know how to compare. Anything else in dwFlags (trigger fields
+// aside) disables suppression for that call.
+static constexpr DWORD kCachedFields =
+    DIEP_DURATION | DIEP_SAMPLEPERIOD | DIEP_GAIN | DIEP_TRIGGERBUTTON |
+    DIEP_TRIGGERREPEATINTERVAL | DIEP_AXES | DIEP_DIRECTION | DIEP_ENVELOPE |
+    DIEP_TYPESPECIFICPARAMS | DIEP_STARTDELAY;
+
+EffectParamCache::EffectParamCache(EffectKind kind)
+    : m_kind(kind)
+{
+    m_axes.reserve(4);
+    m_directions.reserve(4);
+    const auto& info = effectKindInfo(kind);
+    m_typeSpecific.reserve(info.category == EffectCategory::Condition
+                               ? info.typeSpecificSize * 4
+                               : info.typeSpecificSize);
+}
+
+static bool withinDeadband(LONG a, LONG b, LONG deadband) {
+    return std::labs(static_cast<long>(a) - static_cast<long>(b)) <= deadband;
+}
+
+bool EffectParamCache::typeSpecificMatches(const DIEFFECT* peff, LONG deadband) const {
+    DWORD cb = peff->cbTypeSpecificParams;
+    if (cb != m_typeSpecific.size()) return false;
+    if (cb == 0) return true;
+    if (!peff->lpvTypeSpecificParams) return false;
+
+    const void* cur  = peff->lpvTypeSpecificParams;
+    const void* prev = m_typeSpecific.data();
+
+    switch (effectKindCategory(m_kind)) {
+    case EffectCategory::Constant:
+        if (deadband > 0 && cb == sizeof(DICONSTANTFORCE)) {
+            return withinDeadband(static_cast<const DICONSTANTFORCE*>(cur)->lMagnitude,
+                                  static_cast<const DICONSTANTFORCE*>(prev)->lMagnitude,
+                                  deadband);
+        }
+        break;
+
+    case EffectCategory::Ramp:
+        if (deadband > 0 && cb == sizeof(DIRAMPFORCE)) {
+            auto* a = static_cast<const DIRAMPFORCE*>(cur);
+            auto* b = static_cast<const DIRAMPFORCE*>(prev);
+            return withinDeadband(a->lStart, b->lStart, deadband) &&
+                   withinDeadband(a->lEnd,   b->lEnd,   deadband);
+        }
+        break;
+
+    case EffectCategory::Periodic:
+        if (deadband > 0 && cb == sizeof(DIPERIODIC)) {
+            auto* a = static_cast<const DIPERIODIC*>(cur);
+            auto* b = static_cast<const DIPERIODIC*>(prev);
+            return withinDeadband(static_cast<LONG>(a->dwMagnitude),
+                                  static_cast<LONG>(b->dwMagnitude), deadband) &&
+                   a->lOffset == b->lOffset && a->dwPhase == b->dwPhase &&
+                   a->dwPeriod == b->dwPeriod;
+        }
+        break;
+
+    case EffectCategory::Condition:
+        if (deadband > 0 && cb % sizeof(DICONDITION) == 0) {
+            auto* a = static_cast<const DICONDITION*>(cur);
+            auto* b = static_cast<const DICONDITION*>(prev);
+            for (DWORD i = 0; i < cb / sizeof(DICONDITION); ++i) {
+                if (a[i].lOffset != b[i].lOffset || a[i].lDeadBand != b[i].lDeadBand ||
+                    !withinDeadband(a[i].lPositiveCoefficient, b[i].lPositiveCoefficient, deadband) ||
+                    !withinDeadband(a[i].lNegativeCoefficient, b[i].lNegativeCoefficient, deadband) ||
+                    !withinDeadband(static_cast<LONG>(a[i].dwPositiveSaturation),
+                                    static_cast<LONG>(b[i].dwPositiveSaturation), deadband) ||
+                    !withinDeadband(static_cast<LONG>(a[i].dwNegativeSaturation),
+                                    static_cast<LONG>(b[i].dwNegativeSaturation), deadband))
+                    return false;
+            }
+            return true;
+        }
+        break;
+
+    case EffectCategory::Custom:
+        if (cb >= sizeof(DICUSTOMFORCE)) {
+            auto* a = static_cast<const DICUSTOMFORCE*>(cur);
+            auto* b = static_cast<const DICUSTOMFORCE*>(prev);
+            if (a->cChannels != b->cChannels || a->cSamples != b->cSamples ||
+                a->dwSamplePeriod != b->dwSamplePeriod)
+                return false;
+            if (!a->rglForceData) return m_customSamples.empty();
+            size_t n = static_cast<size_t>(a->cSamples) * a->cChannels;
+            return n == m_customSamples.size() &&
+                   std::memcmp(a->rglForceData, m_customSamples.data(),
+                               n * sizeof(LONG)) == 0;
+        }
+        break;
+
+    default:
+        break;
+    }
+
+    return std::memcmp(cur, prev, cb) == 0;
+}
+
+bool EffectParamCache::matches(const DIEFFECT* peff, DWORD dwFlags, LONG deadband) const {
+    if (!peff) return false;
+
+    // DIEP_START also (re)starts the effect; never swallow it.
+    if (dwFlags & DIEP_START) return false;
+    if (m_notDownloaded) return false;
+
+    DWORD fields = dwFlags & DIEP_ALLPARAMS;
+    if (fields == 0 || (fields & ~kCachedFields)) return false;
+    if ((fields & m_valid) != fields) return false;
+
+    if ((fields & DIEP_DURATION)     && peff->dwDuration     != m_params.dwDuration)     return false;
+    if ((fields & DIEP_SAMPLEPERIOD) && peff->dwSamplePeriod != m_params.dwSamplePeriod) return false;
+    if ((fields & DIEP_GAIN)         && peff->dwGain         != m_params.dwGain)         return false;
+    if ((fields & DIEP_STARTDELAY)   && peff->dwStartDelay   != m_params.dwStartDelay)   return false;
+    if ((fields & DIEP_TRIGGERBUTTON) &&
+        peff->dwTriggerButton != m_params.dwTriggerButton) return false;
+    if ((fields & DIEP_TRIGGERREPEATINTERVAL) &&
+        peff->dwTriggerRepeatInterval != m_params.dwTriggerRepeatInterval) return false;
+
+    if (fields & (DIEP_AXES | DIEP_DIRECTION)) {
+        // dwFlags carries the axis addressing and coordinate system bits
+        if (peff->dwFlags != m_params.dwFlags || peff->cAxes != m_params.cAxes)
+            return false;
+        if (fields & DIEP_AXES) {
+            if (!peff->rgdwAxes || peff->cAxes != m_axes.size() ||
+                std::memcmp(peff->rgdwAxes, m_axes.data(), peff->cAxes * sizeof(DWORD)) != 0)
+                return false;
+        }
+        if (fields & DIEP_DIRECTION) {
+            if (!peff->rglDirection || peff->cAxes != m_directions.size() ||
+                std::memcmp(peff->rglDirection, m_directions.data(),
+                            peff->cAxes * sizeof(LONG)) != 0)
+                return false;
+        }
+    }
+
+    if (fields & DIEP_ENVELOPE) {
+        if ((peff->lpEnvelope != nullptr) != m_hasEnvelope) return false;
+        if (peff->lpEnvelope &&
+            (peff->lpEnvelope->dwAttackLevel != m_envelope.dwAttackLevel ||
+             peff->lpEnvelope->dwAttackTime  != m_envelope.dwAttackTime  ||
+             peff->lpEnvelope->dwFadeLevel   != m_envelope.dwFadeLevel   ||
+             peff->lpEnvelope->dwFadeTime    != m_envelope.dwFadeTime))
+            return false;
+    }
+
+    if ((fields & DIEP_TYPESPECIFICPARAMS) && !typeSpecificMatches(peff, deadband))
+        return false;
+
+    return true;
+}
+
+void EffectParamCache::update(const DIEFFECT* peff, DWORD dwFlags) {
+    if (!peff) return;
+    DWORD fields = dwFlags & kCachedFields;
+    if (peff->dwSize) m_effectSize = peff->dwSize;
+    m_effectFlags = peff->dwFlags;
+    m_notDownloaded = (dwFlags & DIEP_NODOWNLOAD) != 0;
+
+    if (fields & DIEP_DURATION)              m_params.dwDuration              = peff->dwDuration;
+    if (fields & DIEP_SAMPLEPERIOD)          m_params.dwSamplePeriod          = peff->dwSamplePeriod;
+    if (fields & DIEP_GAIN)                  m_params.dwGain                  = peff->dwGain;
+    if (fields & DIEP_STARTDELAY)            m_params.dwStartDelay            = peff->dwStartDelay;
+    if (fields & DIEP_TRIGGERBUTTON)         m_params.dwTriggerButton         = peff->dwTriggerButton;
+    if (fields & DIEP_TRIGGERREPEATINTERVAL) m_params.dwTriggerRepeatInterval = peff->dwTriggerRepeatInterval;
+
+    if (fields & (DIEP_AXES | DIEP_DIRECTION)) {
+        m_params.dwFlags = peff->dwFlags;
+        m_params.cAxes   = peff->cAxes;
+        if (fields & DIEP_AXES) {
+            if (peff->rgdwAxes)
+                m_axes.assign(peff->rgdwAxes, peff->rgdwAxes + peff->cAxes);
+            else
+                fields &= ~DIEP_AXES;
+        }
+        if (fields & DIEP_DIRECTION) {
+            if (peff->rglDirection)
+                m_directions.assign(peff->rglDirection, peff->rglDirection + peff->cAxes);
+            else
+                fields &= ~DIEP_DIRECTION;
+        }
+        // A new axis count makes the other array stale.
+        if (m_axes.size() != peff->cAxes)       m_valid &= ~DIEP_AXES;
+        if (m_directions.size() != peff->cAxes) m_valid &= ~DIEP_DIRECTION;
+    }
+
+    if (fields & DIEP_ENVELOPE) {
+        m_hasEnvelope = peff->lpEnvelope != nullptr;
+        if (m_hasEnvelope) m_envelope = *peff->lpEnvelope;
+    }
+
+    if (fields & DIEP_TYPESPECIFICPARAMS) {
+        DWORD cb = peff->cbTypeSpecificParams;
+        if (cb && peff->lpvTypeSpecificParams) {
+            auto* src = static_cast<const BYTE*>(peff->lpvTypeSpecificParams);
+            m_typeSpecific.assign(src, src + cb);
+            m_customSamples.clear();
+            if (effectKindCategory(m_kind) == EffectCategory::Custom &&
+                cb >= sizeof(DICUSTOMFORCE))
+            {
+                auto* cf = static_cast<const DICUSTOMFORCE*>(peff->lpvTypeSpecificParams);
+                if (cf->rglForceData)
+                    m_customSamples.assign(cf->rglForceData,
+                        cf->rglForceData + static_cast<size_t>(cf->cSamples) * cf->cChannels);
+                // Point the stored header at our copy, not the caller's buffer.
+                reinterpret_cast<DICUSTOMFORCE*>(m_typeSpecific.data())->rglForceData =
+                    cf->rglForceData ? m_customSamples.data() : nullptr;
+            }
+        } else if (cb == 0) {
+            m_typeSpecific.clear();
+            m_customSamples.clear();
+        } else {
+            fields &= ~DIEP_TYPESPECIFICPARAMS;
+        }
+    }
+
+    m_valid |= fields;
+}
+
+void EffectParamCache::view(DIEFFECT& out) const {
+    out = m_params;
+    out.dwSize   = m_effectSize;
+    out.dwFlags  = m_effectFlags;
+    out.rgdwAxes     = (m_valid & DIEP_AXES) ? const_cast<DWORD*>(m_axes.data()) : nullptr;
+    out.rglDirection = (m_valid & DIEP_DIRECTION) ? const_cast<LONG*>(m_directions.data()) : nullptr;
+    out.lpEnvelope   = (m_valid & DIEP_ENVELOPE) && m_hasEnvelope
+                           ? const_cast<DIENVELOPE*>(&m_envelope) : nullptr;
+    if (m_valid & DIEP_TYPESPECIFICPARAMS) {
+        out.cbTypeSpecificParams  = static_cast<DWORD>(m_typeSpecific.size());
+        out.lpvTypeSpecificParams = m_typeSpecific.empty()
+            ? nullptr : const_cast<BYTE*>(m_typeSpecific.data());
+    } else {
+        out.cbTypeSpecificParams  = 0;
+        out.lpvTypeSpecificParams = nullptr;
+    }
+}
+
+void EffectParamCache::swap(EffectParamCache& other) noexcept {
+    using std::swap;
+    swap(m_kind,          other.m_kind);
+    swap(m_valid,         other.m_valid);
+    swap(m_effectSize,    other.m_effectSize);
+    swap(m_effectFlags,   other.m_effectFlags);
+    swap(m_notDownloaded, other.m_notDownloaded);
+    swap(m_params,        other.m_params);
+    swap(m_axes,          other.m_axes);
+    swap(m_directions,    other.m_directions);
+    swap(m_hasEnvelope,   other.m_hasEnvelope);
+    swap(m_envelope,      other.m_envelope);
+    swap(m_typeSpecific,  other.m_typeSpecific);
+    swap(m_customSamples, other.m_customSamples);
+}
@@ -0,0 +1,69 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026 Valmantas Paliksa
+#pragma once
+
+#include <windows.h>
+#include <dinput.h>
+#include <vector>
+
+#include "effect_kind.h"
+
+// Last parameters forwarded to the real effect, per DIEP_* field.
+//
+// DCS re-sends ConstantForce/Spring parameters every frame even when nothing
+// changed, and every forwarded SetParameters is a USB HID write. WrapperEffect
+// asks matches() before forwarding; when every field selected by dwFlags is
+// the same as last time (magnitudes optionally within a deadband) the call is
+// skipped. Stores the caller's (unscaled) values.
+//
+// The same per-field store doubles as the coalescing mailbox: update() merges
+// successive partial calls and view() rebuilds a DIEFFECT over the result.
+//
+// Storage is reserved from the effect kind up front; only a larger axis count
+// or CustomForce buffer than seen before grows it.
+class EffectParamCache {
+public:
+    explicit EffectParamCache(EffectKind kind);
+
+    // True if every field selected by dwFlags equals the cached value.
+    // deadband > 0 lets type-specific magnitudes differ by up to that much.
+    // Never true after a DIEP_NODOWNLOAD update: the driver holds the values
+    // but the device may not, so the next identical call must go through.
+    bool matches(const DIEFFECT* peff, DWORD dwFlags, LONG deadband) const;
+
+    // Remember the fields selected by dwFlags after a successful forward.
+    void update(const DIEFFECT* peff, DWORD dwFlags);
+
+    // Whether the held values are on the device: a later Download put them
+    // there, an eviction (Unload) took them off again.
+    void setDownloaded(bool downloaded) { m_notDownloaded = !downloaded; }
+
+    // Forget everything (e.g. after a failed forward or a policy change).
+    void invalidate() { m_valid = 0; }
+
+    // DIEP_* fields currently held.
+    DWORD fields() const { return m_valid; }
+
+    // Fill out with a DIEFFECT whose pointers reference this object's storage.
+    // Valid until the next update()/swap().
+    void view(DIEFFECT& out) const;
+
+    // Exchange contents (buffers move, nothing is copied or allocated).
+    void swap(EffectParamCache& other) noexcept;
+
+private:
+    bool typeSpecificMatches(const DIEFFECT* peff, LONG deadband) const;
+
+    EffectKind         m_kind;
+    DWORD              m_valid = 0;        // DIEP_* fields currently cached
+    DWORD              m_effectSize = sizeof(DIEFFECT);   // caller's dwSize
+    DWORD              m_effectFlags = 0;  // caller's latest DIEFFECT::dwFlags
+    bool               m_notDownloaded = false;   // latest update had DIEP_NODOWNLOAD
+    DIEFFECT           m_params = {};      // scalars only, pointers unused
+    std::vector<DWORD> m_axes;
+    std::vector<LONG>  m_directions;
+    bool               m_hasEnvelope = false;
+    DIENVELOPE         m_envelope = {};
+    std::vector<BYTE>  m_typeSpecific;
+    std::vector<LONG>  m_customSamples;
+};
@@ -0,0 +1,94 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026 Valmantas Paliksa
+#include "ffb_curve.h"
+#include "ffb_scale.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <locale>
+#include <sstream>
+
+// ============================================================================
+// Definition
+// ============================================================================
+bool FFBCurve::parse(const std::string& spec, std::vector<Step>& steps) {
+    // Classic locale: the game may have set one that writes "1,5".
+    std::istringstream in(spec);
+    in.imbue(std::locale::classic());
+
+    steps.clear();
+    std::string word;
+    while (in >> word) {
+        Step s{};
+        if (word == "gamma")
+            s.stage = Stage::Gamma;
+        else if (word == "expo")
+            s.stage = Stage::Expo;
+        else if (word == "softlimit" || word == "soft")
+            s.stage = Stage::SoftLimit;
+        else
+            return false;
+        if (!(in >> s.param)) return false;
+
+        switch (s.stage) {
+        case Stage::Gamma:     s.param = std::clamp(s.param, 0.1, 10.0);  break;
+        case Stage::Expo:      s.param = std::clamp(s.param, 0.0, 1.0);   break;
+        case Stage::SoftLimit: s.param = std::clamp(s.param, 0.05, 1.0);  break;
+        }
+        steps.push_back(s);
+    }
+    return !steps.empty();
+}
+
+static double evalStep(const FFBCurve::Step& s, double x) {
+    switch (s.stage) {
+    case FFBCurve::Stage::Gamma:     return std::pow(x, s.param);
+    case FFBCurve::Stage::Expo:      return (1.0 - s.param) * x + s.param * x * x * x;
+    case FFBCurve::Stage::SoftLimit: return s.param * std::tanh(x / s.param);
+    }
+    return x;
+}
+
+FFBCurvePtr FFBCurve::bake(std::string name, std::vector<Step> steps) {
+    std::shared_ptr<FFBCurve> c(new FFBCurve());
+    c->m_name  = std::move(name);
+    c->m_steps = std::move(steps);
+
+    for (uint32_t i = 0; i <= kMaxInput; ++i) {
+        double x = static_cast<double>(i) / kMaxInput;
+        for (const Step& s : c->m_steps)
+            x = std::clamp(evalStep(s, x), 0.0, 1.0);
+        c->m_table[i] = static_cast<uint16_t>(std::lround(x * kMaxInput));
+    }
+    c->m_table[kMaxInput + 1] = c->m_table[kMaxInput];
+    return c;
+}
+
+std::string FFBCurve::describe() const {
+    std::string out;
+    char buf[32];
+    for (const Step& s : m_steps) {
+        const char* stage = s.stage == Stage::Gamma ? "gamma"
+                          : s.stage == Stage::Expo  ? "expo"
+                                                    : "softlimit";
+        snprintf(buf, sizeof(buf), "%s%s %.2f", out.empty() ? "" : " ", stage, s.param);
+        out += buf;
+    }
+    return out;
+}
+
+// ============================================================================
+// Application
+// ============================================================================
+void FFBCurve::applySamples(int32_t* data, size_t count) const {
+    if (!data || count == 0) return;
+    ffbCurveSamples(data, count, m_table.data(), kMaxInput);
+}
+
+void FFBCurve::applyConditions(int32_t* records, size_t count) const {
+    for (size_t i = 0; i < count; ++i) {
+        int32_t* c = records + i * 6;
+        c[1] = applySigned(c[1]);
+        c[2] = applySigned(c[2]);
+    }
+}
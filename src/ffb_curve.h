@@ -0,0 +1,85 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026 Valmantas Paliksa
+#pragma once
+//
+// Nonlinear force response curves ([FFBCurves] in dinput8.ini).
+//
+// A curve maps a force magnitude 0..10000 (DI_FFNOMINALMAX) onto the same
+// range through a list of stages applied left to right, x and y in 0..1:
+//
+//     gamma G       y = x^G                  G > 1 softens light forces
+//     expo E        y = (1-E)*x + E*x^3      E in 0..1, RC-style expo
+//     softlimit L   y = L * tanh(x / L)      light forces unchanged, strong
+//                                            ones flattened below L
+//
+// The curve is evaluated in double precision once, when the config loads,
+// and rounded into a table with one entry per integer magnitude. Applying it
+// is then a single load per value: out = sign(v) * table[min(|v|, 10000)].
+// Values past 10000 are out of DirectInput's range and read the last entry.
+//
+// No Windows types here, so curves can be exercised on any platform.
+//
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+class FFBCurve {
+public:
+    static constexpr uint32_t kMaxInput = 10000;
+
+    enum class Stage : uint8_t { Gamma, Expo, SoftLimit };
+
+    struct Step {
+        Stage  stage;
+        double param;
+        bool operator==(const Step& o) const { return stage == o.stage && param == o.param; }
+    };
+
+    // Parse "gamma 1.6 softlimit 0.8" (lower-case, stage names may be
+    // abbreviated to "soft"). Out-of-range parameters are clamped; returns
+    // false on an unknown stage or a missing number.
+    static bool parse(const std::string& spec, std::vector<Step>& steps);
+
+    // Evaluate and round the stages into a table.
+    static std::shared_ptr<const FFBCurve> bake(std::string name, std::vector<Step> steps);
+
+    const std::string& name() const { return m_name; }
+    // Stages as written back, e.g. "gamma 1.60 softlimit 0.80".
+    std::string describe() const;
+    // Same stages, hence the same table (names may differ).
+    bool sameShape(const FFBCurve& o) const { return m_steps == o.m_steps; }
+
+    uint32_t applyUnsigned(uint32_t v) const {
+        return m_table[v < kMaxInput ? v : kMaxInput];
+    }
+    int32_t applySigned(int32_t v) const {
+        uint32_t mag = v < 0 ? 0u - static_cast<uint32_t>(v) : static_cast<uint32_t>(v);
+        int32_t  r   = static_cast<int32_t>(applyUnsigned(mag));
+        return v < 0 ? -r : r;
+    }
+
+    // Shape a buffer of signed samples in place (DICUSTOMFORCE::rglForceData).
+    // Uses the AVX2 gather kernel in ffb_scale.cpp when available.
+    void applySamples(int32_t* data, size_t count) const;
+
+    // Shape the two coefficients of DICONDITION-shaped records in place
+    // (layout as for ffbScaleConditions). Saturations are force limits, not
+    // responses, and are left alone.
+    void applyConditions(int32_t* records, size_t count) const;
+
+    // Padded by one entry so a 32-bit gather at kMaxInput stays in bounds.
+    using Table = std::array<uint16_t, kMaxInput + 2>;
+    const Table& table() const { return m_table; }
+
+private:
+    FFBCurve() = default;
+
+    std::string       m_name;
+    std::vector<Step> m_steps;
+    Table             m_table{};
+};
+
+using FFBCurvePtr = std::shared_ptr<const FFBCurve>;
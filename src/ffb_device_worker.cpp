@@ -0,0 +1,239 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026 Valmantas Paliksa
+#include "ffb_device_worker.h"
+#include "wrapper_effect.h"
+#include "logger.h"
+#include <algorithm>
+
+FFBDeviceWorker::FFBDeviceWorker(int coalesceHz, bool asyncCommands,
+                                 const std::wstring& deviceName)
+    : m_hz(std::max(coalesceHz, 0))
+    , m_period100ns(coalesceHz > 0 ? 10000000LL / coalesceHz : 0)
+    , m_async(asyncCommands)
+    , m_deviceName(deviceName)
+{
+    LARGE_INTEGER freq;
+    if (QueryPerformanceFrequency(&freq) && freq.QuadPart > 0)
+        m_qpcFrequency = freq.QuadPart;
+
+    m_stop     = CreateEventW(nullptr, TRUE,  FALSE, nullptr);
+    m_work     = CreateEventW(nullptr, FALSE, FALSE, nullptr);
+    m_commands = CreateEventW(nullptr, FALSE, FALSE, nullptr);
+    m_progress = CreateEventW(nullptr, FALSE, FALSE, nullptr);
+
+    if (m_period100ns > 0) {
+        // Sub-millisecond periods need the high-resolution timer (Windows 10
+        // 1803+); older systems fall back to the regular ~1 ms timer.
+        m_timer = CreateWaitableTimerExW(nullptr, nullptr,
+                                         CREATE_WAITABLE_TIMER_HIGH_RESOLUTION,
+                                         TIMER_ALL_ACCESS);
+        if (!m_timer)
+            m_timer = CreateWaitableTimerExW(nullptr, nullptr, 0, TIMER_ALL_ACCESS);
+        if (!m_timer)
+            LOG_WARN("[%ls] Worker: no waitable timer, coalescing is not rate limited",
+                     m_deviceName.c_str());
+    }
+
+    if (!m_stop || !m_work || !m_commands || !m_progress) {
+        LOG_ERROR("[%ls] Worker: failed to create sync objects (%lu), "
+                  "FFB calls will be forwarded directly",
+                  m_deviceName.c_str(), GetLastError());
+        return;
+    }
+
+    if (m_async) {
+        m_slots.reset(new Slot[kQueueSlots]);
+        for (size_t i = 0; i < kQueueSlots; ++i)
+            m_slots[i].seq.store(i, std::memory_order_relaxed);
+    }
+
+    m_thread = CreateThread(nullptr, 0, &FFBDeviceWorker::threadProc, this, 0, nullptr);
+    if (m_thread) {
+        // Forces are time-critical relative to the game's own work.
+        SetThreadPriority(m_thread, THREAD_PRIORITY_ABOVE_NORMAL);
+        LOG_INFO("[%ls] FFB worker started (coalesce=%d Hz, async commands=%s)",
+                 m_deviceName.c_str(), m_hz, m_async ? "on" : "off");
+    }
+}
+
+FFBDeviceWorker::~FFBDeviceWorker() {
+    shutdown();
+
+    size_t run = m_completed.load(std::memory_order_relaxed);
+    if (m_async && run > 0) {
+        LOG_INFO("[%ls] Async FFB commands: %zu run, max queue depth %zu, "
+                 "max latency %.3f ms, %llu failed, %llu full-queue stalls",
+                 m_deviceName.c_str(), run,
+                 m_maxDepth.load(std::memory_order_relaxed),
+                 1000.0 * static_cast<double>(m_maxLatency) /
+                     static_cast<double>(m_qpcFrequency),
+                 static_cast<unsigned long long>(m_failed),
+                 static_cast<unsigned long long>(m_fullStalls.load(std::memory_order_relaxed)));
+    }
+
+    if (m_timer)    CloseHandle(m_timer);
+    if (m_progress) CloseHandle(m_progress);
+    if (m_commands) CloseHandle(m_commands);
+    if (m_work)     CloseHandle(m_work);
+    if (m_stop)     CloseHandle(m_stop);
+}
+
+void FFBDeviceWorker::shutdown() {
+    if (!m_thread) return;
+    // The thread drains the queue and the mailboxes before it exits, so the
+    // wait is as long as the device takes and no longer. Never reached from
+    // DllMain: the filter goes away with the game's last Release, and at
+    // process exit a terminated thread is already signalled.
+    SetEvent(m_stop);
+    WaitForSingleObject(m_thread, INFINITE);
+    CloseHandle(m_thread);
+    m_thread = nullptr;
+}
+
+// ---------------------------------------------------------------------------
+// Coalescing mailboxes
+// ---------------------------------------------------------------------------
+void FFBDeviceWorker::add(WrapperEffect* effect) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_effects.push_back(effect);
+}
+
+void FFBDeviceWorker::remove(WrapperEffect* effect) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = std::find(m_effects.begin(), m_effects.end(), effect);
+    if (it != m_effects.end()) {
+        *it = m_effects.back();
+        m_effects.pop_back();
+    }
+}
+
+void FFBDeviceWorker::flushAll() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (WrapperEffect* e : m_effects)
+        e->flushPending();
+}
+
+// ---------------------------------------------------------------------------
+// Command queue — producers (any thread)
+// ---------------------------------------------------------------------------
+void FFBDeviceWorker::enqueue(FFBCommand::Fn fn, void* target, DWORD arg0, DWORD arg1,
+                              FFBTraceMethod method)
+{
+    LARGE_INTEGER now;
+    QueryPerformanceCounter(&now);
+
+    size_t pos = m_head.load(std::memory_order_relaxed);
+    Slot* slot;
+    for (;;) {
+        slot = &m_slots[pos & (kQueueSlots - 1)];
+        size_t seq = slot->seq.load(std::memory_order_acquire);
+        intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+        if (diff == 0) {
+            if (m_head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                break;
+        } else if (diff < 0) {
+            // Full: the device is far behind. Dropping a Start/Stop would
+            // desynchronise the game's view, so wait for the worker instead.
+            m_fullStalls.fetch_add(1, std::memory_order_relaxed);
+            SetEvent(m_commands);
+            Sleep(0);
+            pos = m_head.load(std::memory_order_relaxed);
+        } else {
+            pos = m_head.load(std::memory_order_relaxed);
+        }
+    }
+
+    slot->cmd.fn       = fn;
+    slot->cmd.target   = target;
+    slot->cmd.arg0     = arg0;
+    slot->cmd.arg1     = arg1;
+    slot->cmd.method   = method;
+    slot->cmd.queuedAt = now.QuadPart;
+    slot->seq.store(pos + 1, std::memory_order_release);
+
+    size_t depth = pos + 1 - m_completed.load(std::memory_order_relaxed);
+    size_t prev  = m_maxDepth.load(std::memory_order_relaxed);
+    while (depth > prev &&
+           !m_maxDepth.compare_exchange_weak(prev, depth, std::memory_order_relaxed)) {}
+
+    SetEvent(m_commands);
+}
+
+void FFBDeviceWorker::waitIdle() {
+    if (!m_async || !m_thread) return;
+    size_t ticket = m_head.load(std::memory_order_acquire);
+    while (m_completed.load(std::memory_order_acquire) < ticket) {
+        // At process exit the worker may already have been terminated.
+        if (WaitForSingleObject(m_thread, 0) == WAIT_OBJECT_0) return;
+        WaitForSingleObject(m_progress, 10);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Worker thread
+// ---------------------------------------------------------------------------
+void FFBDeviceWorker::runCommands() {
+    if (!m_slots) return;
+    for (;;) {
+        Slot& slot = m_slots[m_tail & (kQueueSlots - 1)];
+        if (slot.seq.load(std::memory_order_acquire) != m_tail + 1)
+            break;
+        FFBCommand cmd = slot.cmd;
+        slot.seq.store(m_tail + kQueueSlots, std::memory_order_release);
+        ++m_tail;
+
+        HRESULT hr = cmd.fn(cmd.target, cmd.arg0, cmd.arg1);
+
+        LARGE_INTEGER done;
+        QueryPerformanceCounter(&done);
+        m_maxLatency = std::max(m_maxLatency, done.QuadPart - cmd.queuedAt);
+        if (FAILED(hr)) {
+            ++m_failed;
+            LOG_DEBUG("[%ls] Async %s failed: 0x%08X", m_deviceName.c_str(),
+                      ffbTraceMethodName(static_cast<uint8_t>(cmd.method)),
+                      static_cast<unsigned>(hr));
+        }
+
+        m_completed.store(m_tail, std::memory_order_release);
+    }
+    SetEvent(m_progress);
+}
+
+void FFBDeviceWorker::run() {
+    bool rateLimited = false;   // waiting out the period after a flush
+
+    for (;;) {
+        // Commands first (lower index wins when several are signalled); the
+        // third handle is the mailbox event, or the timer while rate limited.
+        const HANDLE handles[3] = { m_stop, m_commands, rateLimited ? m_timer : m_work };
+        DWORD r = WaitForMultipleObjects(3, handles, FALSE, INFINITE);
+
+        if (r == WAIT_OBJECT_0 + 1) {
+            runCommands();
+        } else if (r == WAIT_OBJECT_0 + 2) {
+            if (rateLimited) {
+                // Period over; updates that arrived meanwhile set m_work.
+                rateLimited = false;
+                continue;
+            }
+            flushAll();
+            if (m_timer) {
+                LARGE_INTEGER due;
+                due.QuadPart = -m_period100ns;
+                rateLimited = SetWaitableTimer(m_timer, &due, 0, nullptr, nullptr, FALSE) != 0;
+            }
+        } else if (r == WAIT_OBJECT_0) {
+            // Stop: everything already accepted still reaches the device.
+            runCommands();
+            flushAll();
+            return;
+        } else {
+            return;   // wait failure
+        }
+    }
+}
+
+DWORD WINAPI FFBDeviceWorker::threadProc(LPVOID param) {
+    static_cast<FFBDeviceWorker*>(param)->run();
+    return 0;
+}
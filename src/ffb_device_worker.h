@@ -0,0 +1,122 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026 Valmantas Paliksa
+#pragma once
+
+#include <windows.h>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "ffb_trace_format.h"
+
+class WrapperEffect;
+
+// One deferred FFB call. fn runs on the worker thread with the same target
+// and arguments the game passed; it is responsible for remembering a failure
+// so the game can be told on its next call (see WrapperEffect::runStart).
+struct FFBCommand {
+    using Fn = HRESULT (*)(void* target, DWORD arg0, DWORD arg1);
+
+    Fn             fn       = nullptr;
+    void*          target   = nullptr;
+    DWORD          arg0     = 0;
+    DWORD          arg1     = 0;
+    FFBTraceMethod method   = FFBTraceMethod::Start;   // for logging
+    LONGLONG       queuedAt = 0;                       // QPC ticks
+};
+
+// Per-device background thread that keeps HID writes off the game thread.
+//
+// Two jobs, both optional:
+//
+//  * Coalescing ([FFB] CoalesceHz > 0, or implied by AsyncCommands).
+//    WrapperEffect::SetParameters merges the call into the effect's mailbox,
+//    pokes notify() and returns. The thread forwards every effect's merged
+//    parameters, then (with a rate) sleeps one period before looking again —
+//    an idle device costs nothing and a burst reaches the device at most
+//    CoalesceHz times per second per effect.
+//
+//  * Async commands ([FFB] AsyncCommands=true). Start, Stop, Download and
+//    SendForceFeedbackCommand are pushed onto a bounded lock-free MPSC queue
+//    and executed in order. Commands take priority over mailbox flushes, and
+//    an effect command flushes that effect's mailbox first, so parameters set
+//    before a Start are on the device when it runs.
+class FFBDeviceWorker {
+public:
+    FFBDeviceWorker(int coalesceHz, bool asyncCommands, const std::wstring& deviceName);
+    ~FFBDeviceWorker();
+
+    FFBDeviceWorker(const FFBDeviceWorker&) = delete;
+    FFBDeviceWorker& operator=(const FFBDeviceWorker&) = delete;
+
+    bool running()       const { return m_thread != nullptr; }
+
+    // Run every queued command and pending mailbox, then join the thread.
+    // Called from FFBFilter teardown; the destructor does it too.
+    void shutdown();
+    bool asyncCommands() const { return m_async; }
+
+    // ---- Coalescing ----
+
+    // Effects register for their whole lifetime. remove() waits for an
+    // in-progress flush pass, so the effect can be destroyed afterwards.
+    void add(WrapperEffect* effect);
+    void remove(WrapperEffect* effect);
+
+    // A mailbox went from empty to pending.
+    void notify() { if (m_work) SetEvent(m_work); }
+
+    // ---- Async commands ----
+
+    // Queue a command (any thread). Blocks only while the queue is full.
+    void enqueue(FFBCommand::Fn fn, void* target, DWORD arg0, DWORD arg1,
+                 FFBTraceMethod method);
+
+    // Wait until every command queued so far has run. Targets call this
+    // before they are destroyed; the queue holds plain pointers.
+    void waitIdle();
+
+private:
+    static constexpr size_t kQueueSlots = 256;   // power of two
+
+    struct Slot {
+        std::atomic<size_t> seq{0};
+        FFBCommand          cmd;
+    };
+
+    static DWORD WINAPI threadProc(LPVOID param);
+    void run();
+    void flushAll();
+    void runCommands();
+
+    int          m_hz;
+    LONGLONG     m_period100ns;   // flush period, 0 = no rate limit
+    bool         m_async;
+    std::wstring m_deviceName;
+
+    std::mutex                  m_mutex;     // guards m_effects, held for a flush pass
+    std::vector<WrapperEffect*> m_effects;
+
+    // Vyukov bounded MPSC ring (same scheme as the logger)
+    std::unique_ptr<Slot[]> m_slots;
+    std::atomic<size_t>     m_head{0};       // next slot producers claim
+    size_t                  m_tail = 0;      // worker only
+    std::atomic<size_t>     m_completed{0};  // commands finished
+
+    // Statistics (logged at shutdown)
+    std::atomic<size_t>   m_maxDepth{0};
+    std::atomic<uint64_t> m_fullStalls{0};
+    uint64_t              m_failed = 0;         // worker only
+    LONGLONG              m_maxLatency = 0;     // QPC ticks, worker only
+    LONGLONG              m_qpcFrequency = 1;
+
+    HANDLE m_thread   = nullptr;
+    HANDLE m_stop     = nullptr;
+    HANDLE m_work     = nullptr;   // mailbox pending
+    HANDLE m_commands = nullptr;   // command queued
+    HANDLE m_progress = nullptr;   // a command batch finished
+    HANDLE m_timer    = nullptr;
+};
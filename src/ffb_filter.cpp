@@ -2,113 +2,317 @@
 // Copyright (c) 2026 Valmantas Paliksa
 #include "ffb_filter.h"
 #include "config.h"
+#include "ffb_trace.h"
 #include "logger.h"
+#include <cstddef>
+#include <cstdio>
 
-FFBFilter::FFBFilter(const FFBPolicy& policy, const std::wstring& deviceName)
+FFBFilter::FFBFilter(const FFBPolicy& policy, DeviceIdentityPtr identity,
+                     FFBDeviceHandle registryDevice)
     : m_policy(policy)
-    , m_deviceName(deviceName)
-{}
+    , m_identity(std::move(identity))
+    , m_deviceName(m_identity->productName)
+    , m_registryDevice(registryDevice)
+{
+    m_livePolicies.push_back(std::make_unique<LivePolicy>(makeLive(policy)));
+    m_live.store(m_livePolicies.back().get(), std::memory_order_release);
+
+    if (FFBTrace::instance().active())
+        m_traceDeviceId = FFBTrace::instance().registerDevice(m_deviceName);
+
+    if (m_policy.enabled && m_policy.autoRestart)
+        m_restore = std::make_unique<FFBRestoreScheduler>(*this);
+
+    if (m_policy.enabled && m_policy.evictOnFull)
+        m_slots = std::make_unique<FFBSlotManager>(m_deviceName);
+
+    if (m_policy.enabled && (m_policy.coalesceHz > 0 || m_policy.asyncCommands)) {
+        m_worker = std::make_unique<FFBDeviceWorker>(
+            m_policy.coalesceHz, m_policy.asyncCommands, m_deviceName);
+        if (!m_worker->running())
+            m_worker.reset();
+    }
+}
+
+FFBFilter::~FFBFilter() {
+    // Every effect (and so every mailbox) is gone by now; drain and join
+    // the worker before reading its counters.
+    if (m_worker) m_worker->shutdown();
+    m_worker.reset();
+    FFBStateRegistry::instance().releaseDevice(m_registryDevice);
+
+    uint64_t fwd = m_paramsForwarded.load(std::memory_order_relaxed);
+    uint64_t sup = m_paramsSuppressed.load(std::memory_order_relaxed);
+    uint64_t col = m_paramsCoalesced.load(std::memory_order_relaxed);
+    uint64_t bad = m_paramsFailed.load(std::memory_order_relaxed);
+    if (fwd + sup + col == 0) return;
+    LOG_INFO("[%ls] SetParameters: %llu forwarded, %llu suppressed, %llu coalesced "
+             "(%.1f%% saved)",
+             m_deviceName.c_str(),
+             static_cast<unsigned long long>(fwd),
+             static_cast<unsigned long long>(sup),
+             static_cast<unsigned long long>(col),
+             100.0 * static_cast<double>(sup + col) / static_cast<double>(fwd + sup + col));
+    if (bad)
+        LOG_WARN("[%ls] %llu coalesced SetParameters failed on the device",
+                 m_deviceName.c_str(), static_cast<unsigned long long>(bad));
+}
 
 // ---------------------------------------------------------------------------
-// Force scaling
+// Policy
 // ---------------------------------------------------------------------------
+FFBPolicy FFBFilter::resolvePolicy(const Config& cfg, const DeviceIdentity& device) {
+    FFBPolicy policy;
+    const DeviceRule* rule = cfg.findDeviceRule(device);
+    policy.enabled = rule ? rule->ffbEnabled : cfg.ffbEnabled;
+    policy.scale   = rule ? rule->ffbScale   : cfg.ffbDefaultScale;
+    policy.curve   = rule ? rule->curve : nullptr;
+    for (size_t k = 0; k < kEffectKindCount; ++k) {
+        const EffectTypeRule* e = (rule && rule->effects[k].set) ? &rule->effects[k] : nullptr;
+        policy.effectBlocked[k] = e && e->blocked;
+        policy.effectScale[k]   = e ? e->scale : policy.scale;
+        policy.effectCurve[k]   = (rule && rule->effects[k].curve) ? rule->effects[k].curve
+                                                                   : policy.curve;
+    }
+    policy.suppressRedundant = cfg.ffbSuppressRedundant;
+    policy.paramDeadband     = cfg.ffbParamDeadband;
+    policy.coalesceHz        = cfg.ffbCoalesceHz;
+    policy.asyncCommands     = cfg.ffbAsyncCommands;
+    policy.autoRestart       = cfg.ffbAutoRestart;
+    policy.restoreRampMs     = static_cast<DWORD>(cfg.ffbRestoreRampMs);
+    policy.autoReacquire     = cfg.ffbAutoReacquire;
+    policy.prewarm           = cfg.ffbPrewarm;
+    policy.evictOnFull       = cfg.ffbEvictOnDeviceFull;
+    policy.statusMaxAgeMs    = static_cast<DWORD>(cfg.ffbStatusMaxAgeMs);
+    return policy;
+}
 
-// Helper: is this a condition-type effect?
-static bool isConditionEffect(REFGUID guid) {
-    return guid == GUID_Spring || guid == GUID_Damper ||
-           guid == GUID_Inertia || guid == GUID_Friction;
+// Both linear, or baked from the same stages. A reload bakes new tables, so
+// pointer identity alone would report every curve as changed.
+static bool sameCurve(const FFBCurvePtr& a, const FFBCurvePtr& b) {
+    return a == b || (a && b && a->sameShape(*b));
 }
 
-// Helper: is this a periodic-type effect?
-static bool isPeriodicEffect(REFGUID guid) {
-    return guid == GUID_Square || guid == GUID_Sine ||
-           guid == GUID_Triangle || guid == GUID_SawtoothUp ||
-           guid == GUID_SawtoothDown;
+std::string FFBFilter::describeEffectPolicy(const FFBPolicy& policy) {
+    std::string out;
+    char buf[160];
+    for (size_t k = 0; k < kEffectKindCount; ++k) {
+        const FFBCurvePtr& curve = policy.effectCurve[k];
+        bool ownCurve = !sameCurve(curve, policy.curve);
+        if (policy.effectBlocked[k])
+            snprintf(buf, sizeof(buf), "%s%s=block", out.empty() ? "" : " ",
+                     effectKindName(static_cast<EffectKind>(k)));
+        else if (policy.effectScale[k] != policy.scale || ownCurve)
+            snprintf(buf, sizeof(buf), "%s%s=%d%%%s%s", out.empty() ? "" : " ",
+                     effectKindName(static_cast<EffectKind>(k)), policy.effectScale[k],
+                     ownCurve ? "@" : "", ownCurve ? curve->name().c_str() : "");
+        else
+            continue;
+        out += buf;
+    }
+    return out;
 }
 
-void FFBFilter::scaleEffect(DIEFFECT* pEffect, REFGUID effectGuid) const {
-    if (!pEffect || m_policy.scale >= 100) return;
+FFBFilter::LivePolicy FFBFilter::makeLive(const FFBPolicy& policy) {
+    LivePolicy live{ policy, {} };
+    for (size_t k = 0; k < kEffectKindCount; ++k)
+        live.scale[k] = ffbMakeScaleFactor(policy.effectScale[k]);
+    return live;
+}
 
-    float factor = m_policy.scale / 100.0f;
+void FFBFilter::reloadPolicy() {
+    std::lock_guard<std::mutex> lock(m_reloadMutex);
+    // Generation first: a reload landing in between is caught next call.
+    uint32_t gen = Config::generation();
+    if (gen == m_configGeneration.load(std::memory_order_relaxed)) return;
+    FFBPolicy fresh = resolvePolicy(Config::current(), *m_identity);
 
-    // Scale gain (global effect strength 0-10000)
-    pEffect->dwGain = static_cast<DWORD>(pEffect->dwGain * factor);
+    const FFBPolicy& cur = live().policy;
+    auto next = std::make_unique<LivePolicy>(live());
+    FFBPolicy& p = next->policy;
+    p.scale             = fresh.scale;
+    p.suppressRedundant = fresh.suppressRedundant;
+    p.paramDeadband     = fresh.paramDeadband;
+    p.restoreRampMs     = fresh.restoreRampMs;
+    p.autoReacquire     = fresh.autoReacquire;
+    p.statusMaxAgeMs    = fresh.statusMaxAgeMs;
+    p.effectBlocked     = fresh.effectBlocked;   // for effects created from now on
+    p.effectScale       = fresh.effectScale;
+    bool curvesChanged  = !sameCurve(fresh.curve, cur.curve);
+    for (size_t k = 0; k < kEffectKindCount; ++k)
+        curvesChanged |= !sameCurve(fresh.effectCurve[k], cur.effectCurve[k]);
+    if (curvesChanged) {
+        p.curve       = fresh.curve;
+        p.effectCurve = fresh.effectCurve;
+    }
 
-    if (!pEffect->lpvTypeSpecificParams || pEffect->cbTypeSpecificParams == 0)
-        return;
+    if (fresh.enabled != m_policy.enabled)
+        LOG_INFO("[%ls] FFB %s takes effect when the game creates the device again",
+                 m_deviceName.c_str(), fresh.enabled ? "allow" : "block");
 
-    // Constant force — DICONSTANTFORCE { lMagnitude }
-    if (effectGuid == GUID_ConstantForce &&
-        pEffect->cbTypeSpecificParams >= sizeof(DICONSTANTFORCE))
-    {
-        auto* p = static_cast<DICONSTANTFORCE*>(pEffect->lpvTypeSpecificParams);
-        p->lMagnitude = static_cast<LONG>(p->lMagnitude * factor);
-    }
-    // Ramp force — DIRAMPFORCE { lStart, lEnd }
-    else if (effectGuid == GUID_RampForce &&
-             pEffect->cbTypeSpecificParams >= sizeof(DIRAMPFORCE))
+    if (p.scale != cur.scale || p.suppressRedundant != cur.suppressRedundant ||
+        p.paramDeadband != cur.paramDeadband || p.restoreRampMs != cur.restoreRampMs ||
+        p.autoReacquire != cur.autoReacquire || p.statusMaxAgeMs != cur.statusMaxAgeMs ||
+        p.effectBlocked != cur.effectBlocked || p.effectScale != cur.effectScale ||
+        curvesChanged)
     {
-        auto* p = static_cast<DIRAMPFORCE*>(pEffect->lpvTypeSpecificParams);
-        p->lStart = static_cast<LONG>(p->lStart * factor);
-        p->lEnd   = static_cast<LONG>(p->lEnd   * factor);
+        std::string types = describeEffectPolicy(p);
+        LOG_INFO("[%ls] Policy reloaded: scale=%d%%  curve=%s  suppressRedundant=%s  "
+                 "deadband=%ld  rampMs=%lu  autoReacquire=%s  statusMaxAgeMs=%lu%s%s",
+                 m_deviceName.c_str(), p.scale, p.curve ? p.curve->name().c_str() : "linear",
+                 p.suppressRedundant ? "true" : "false",
+                 p.paramDeadband, p.restoreRampMs, p.autoReacquire ? "true" : "false",
+                 p.statusMaxAgeMs, types.empty() ? "" : "  ", types.c_str());
+        *next = makeLive(p);
+        m_live.store(next.get(), std::memory_order_release);
+        m_livePolicies.push_back(std::move(next));
+        m_policyGeneration.fetch_add(1, std::memory_order_acq_rel);
     }
-    // Periodic — DIPERIODIC { dwMagnitude, lOffset, dwPhase, dwPeriod }
-    // Scale magnitude only; offset/phase/period are positional, not force.
-    else if (isPeriodicEffect(effectGuid) &&
-             pEffect->cbTypeSpecificParams >= sizeof(DIPERIODIC))
-    {
-        auto* p = static_cast<DIPERIODIC*>(pEffect->lpvTypeSpecificParams);
-        p->dwMagnitude = static_cast<DWORD>(p->dwMagnitude * factor);
-    }
-    // Condition — DICONDITION[] (one per axis)
-    // Scale coefficients and saturation; do NOT scale offset or deadband.
-    else if (isConditionEffect(effectGuid) &&
-             pEffect->cbTypeSpecificParams >= sizeof(DICONDITION))
-    {
-        DWORD count = pEffect->cbTypeSpecificParams / sizeof(DICONDITION);
-        auto* conds = static_cast<DICONDITION*>(pEffect->lpvTypeSpecificParams);
-        for (DWORD i = 0; i < count; ++i) {
-            conds[i].lPositiveCoefficient =
-                static_cast<LONG>(conds[i].lPositiveCoefficient * factor);
-            conds[i].lNegativeCoefficient =
-                static_cast<LONG>(conds[i].lNegativeCoefficient * factor);
-            conds[i].dwPositiveSaturation =
-                static_cast<DWORD>(conds[i].dwPositiveSaturation * factor);
-            conds[i].dwNegativeSaturation =
-                static_cast<DWORD>(conds[i].dwNegativeSaturation * factor);
-            // lOffset and lDeadBand are NOT scaled — they are positional
+    m_configGeneration.store(gen, std::memory_order_release);
+}
+
+// ---------------------------------------------------------------------------
+// Effect instances
+// ---------------------------------------------------------------------------
+
+// Past this many live effects of one type, new ones share the last ordinal.
+static constexpr uint32_t kMaxLiveOrdinals = 64;
+
+uint32_t FFBFilter::acquireOrdinal(EffectKind kind, REFGUID effectGuid) {
+    std::lock_guard<std::mutex> lock(m_ordinalMutex);
+    uint64_t& live = kind == EffectKind::Unknown ? m_liveVendorOrdinals[effectGuid]
+                                                 : m_liveOrdinals[effectKindIndex(kind)];
+    for (uint32_t n = 0; n < kMaxLiveOrdinals; ++n) {
+        if (!(live & (1ULL << n))) {
+            live |= 1ULL << n;
+            return n;
         }
     }
-    // Custom force — DICUSTOMFORCE { cChannels, cSamples, dwSamplePeriod, rglForceData[] }
-    else if (effectGuid == GUID_CustomForce &&
-             pEffect->cbTypeSpecificParams >= sizeof(DICUSTOMFORCE))
-    {
-        auto* p = static_cast<DICUSTOMFORCE*>(pEffect->lpvTypeSpecificParams);
-        if (p->rglForceData) {
-            for (DWORD i = 0; i < p->cSamples * p->cChannels; ++i) {
-                p->rglForceData[i] = static_cast<LONG>(p->rglForceData[i] * factor);
-            }
-        }
+    return kMaxLiveOrdinals;
+}
+
+void FFBFilter::releaseOrdinal(EffectKind kind, REFGUID effectGuid, uint32_t ordinal) {
+    if (ordinal >= kMaxLiveOrdinals) return;
+    std::lock_guard<std::mutex> lock(m_ordinalMutex);
+    uint64_t& live = kind == EffectKind::Unknown ? m_liveVendorOrdinals[effectGuid]
+                                                 : m_liveOrdinals[effectKindIndex(kind)];
+    live &= ~(1ULL << ordinal);
+}
+
+// ---------------------------------------------------------------------------
+// Force scaling
+// ---------------------------------------------------------------------------
+
+// The integer kernel works on 32-bit lanes; DirectInput LONG/DWORD are 32-bit
+// on Windows and DICONDITION is six of them in a row.
+static_assert(sizeof(LONG) == sizeof(int32_t) && sizeof(DWORD) == sizeof(uint32_t),
+              "scaling kernel assumes 32-bit LONG/DWORD");
+static_assert(sizeof(DICONDITION) == 6 * sizeof(int32_t) &&
+              offsetof(DICONDITION, lPositiveCoefficient) == 1 * sizeof(int32_t) &&
+              offsetof(DICONDITION, dwNegativeSaturation) == 4 * sizeof(int32_t),
+              "DICONDITION layout does not match ffbScaleConditions");
+
+// Per-category scalers for the type-specific block. cb is cbTypeSpecificParams
+// and has not been validated yet. curve, when set, is applied before f.
+using TypeSpecificScaler = void (*)(void* params, DWORD cb, FFBScaleFactor f,
+                                    const FFBCurve* curve);
+
+static inline int32_t shapeSigned(int32_t v, FFBScaleFactor f, const FFBCurve* curve) {
+    return ffbScaleSigned(curve ? curve->applySigned(v) : v, f);
+}
+
+// Constant force — DICONSTANTFORCE { lMagnitude }
+static void scaleConstant(void* params, DWORD cb, FFBScaleFactor f, const FFBCurve* curve) {
+    if (cb < sizeof(DICONSTANTFORCE)) return;
+    auto* p = static_cast<DICONSTANTFORCE*>(params);
+    p->lMagnitude = shapeSigned(p->lMagnitude, f, curve);
+}
+
+// Ramp force — DIRAMPFORCE { lStart, lEnd }
+static void scaleRamp(void* params, DWORD cb, FFBScaleFactor f, const FFBCurve* curve) {
+    if (cb < sizeof(DIRAMPFORCE)) return;
+    auto* p = static_cast<DIRAMPFORCE*>(params);
+    p->lStart = shapeSigned(p->lStart, f, curve);
+    p->lEnd   = shapeSigned(p->lEnd,   f, curve);
+}
+
+// Periodic — DIPERIODIC { dwMagnitude, lOffset, dwPhase, dwPeriod }
+// Scale magnitude only; offset/phase/period are positional, not force.
+static void scalePeriodic(void* params, DWORD cb, FFBScaleFactor f, const FFBCurve* curve) {
+    if (cb < sizeof(DIPERIODIC)) return;
+    auto* p = static_cast<DIPERIODIC*>(params);
+    DWORD mag = curve ? curve->applyUnsigned(p->dwMagnitude) : p->dwMagnitude;
+    p->dwMagnitude = ffbScaleUnsigned(mag, f);
+}
+
+// Condition — DICONDITION[] (one per axis)
+// Scale coefficients and saturation; lOffset and lDeadBand are positional.
+// The curve shapes the coefficients only.
+static void scaleCondition(void* params, DWORD cb, FFBScaleFactor f, const FFBCurve* curve) {
+    if (cb < sizeof(DICONDITION)) return;
+    auto*  records = static_cast<int32_t*>(params);
+    size_t count   = cb / sizeof(DICONDITION);
+    if (curve)
+        curve->applyConditions(records, count);
+    ffbScaleConditions(records, count, f);
+}
+
+// Custom force — DICUSTOMFORCE { cChannels, cSamples, dwSamplePeriod, rglForceData[] }
+static void scaleCustom(void* params, DWORD cb, FFBScaleFactor f, const FFBCurve* curve) {
+    if (cb < sizeof(DICUSTOMFORCE)) return;
+    auto* p = static_cast<DICUSTOMFORCE*>(params);
+    if (!p->rglForceData) return;
+    auto*  samples = reinterpret_cast<int32_t*>(p->rglForceData);
+    size_t count   = static_cast<size_t>(p->cSamples) * p->cChannels;
+    if (curve)
+        curve->applySamples(samples, count);
+    ffbScaleSamples(samples, count, f);
+}
+
+// Indexed by EffectCategory.
+static constexpr TypeSpecificScaler kScalers[] = {
+    nullptr,          // None
+    scaleConstant,    // Constant
+    scaleRamp,        // Ramp
+    scalePeriodic,    // Periodic
+    scaleCondition,   // Condition
+    scaleCustom,      // Custom
+};
+static_assert(sizeof(kScalers) / sizeof(kScalers[0]) ==
+              static_cast<size_t>(EffectCategory::Count),
+              "kScalers must cover every EffectCategory");
+
+void FFBFilter::scaleEffect(DIEFFECT* pEffect, EffectKind kind) const {
+    const LivePolicy&    l     = live();
+    const FFBScaleFactor scale = l.scale[effectKindIndex(kind)];
+    const FFBCurve*      curve = l.policy.effectCurve[effectKindIndex(kind)].get();
+    if (!pEffect || (scale.identity && !curve)) return;
+
+    // Scale gain (global effect strength 0-10000)
+    pEffect->dwGain = ffbScaleUnsigned(pEffect->dwGain, scale);
+
+    // Envelope attack/fade levels are absolute magnitudes, scale them too
+    if (pEffect->lpEnvelope) {
+        pEffect->lpEnvelope->dwAttackLevel =
+            ffbScaleUnsigned(pEffect->lpEnvelope->dwAttackLevel, scale);
+        pEffect->lpEnvelope->dwFadeLevel =
+            ffbScaleUnsigned(pEffect->lpEnvelope->dwFadeLevel, scale);
     }
+
+    if (!pEffect->lpvTypeSpecificParams || pEffect->cbTypeSpecificParams == 0)
+        return;
+
+    TypeSpecificScaler scaler =
+        kScalers[static_cast<size_t>(effectKindCategory(kind))];
+    if (scaler)
+        scaler(pEffect->lpvTypeSpecificParams, pEffect->cbTypeSpecificParams, scale, curve);
 }
 
 // ---------------------------------------------------------------------------
 // GUID helpers
 // ---------------------------------------------------------------------------
 const char* FFBFilter::effectGuidToString(REFGUID guid) {
-    if (guid == GUID_ConstantForce) return "ConstantForce";
-    if (guid == GUID_RampForce)     return "RampForce";
-    if (guid == GUID_Square)        return "Square";
-    if (guid == GUID_Sine)          return "Sine";
-    if (guid == GUID_Triangle)      return "Triangle";
-    if (guid == GUID_SawtoothUp)    return "SawtoothUp";
-    if (guid == GUID_SawtoothDown)  return "SawtoothDown";
-    if (guid == GUID_Spring)        return "Spring";
-    if (guid == GUID_Damper)        return "Damper";
-    if (guid == GUID_Inertia)       return "Inertia";
-    if (guid == GUID_Friction)      return "Friction";
-    if (guid == GUID_CustomForce)   return "CustomForce";
-    return "Unknown";
+    return effectKindName(effectKindFromGuid(guid));
 }
 
 const char* FFBFilter::ffbCommandToString(DWORD cmd) {
@@ -126,28 +330,30 @@ const char* FFBFilter::ffbCommandToString(DWORD cmd) {
 // ---------------------------------------------------------------------------
 // Logging
 // ---------------------------------------------------------------------------
-void FFBFilter::logEffectCreation(REFGUID rguid) const {
-    if (!Config::instance().ffbLogEffects) return;
-    LOG_INFO("FFB [%ls] CreateEffect: type=%s  policy=%s  scale=%d%%",
+void FFBFilter::logEffectCreation(EffectKind kind) const {
+    if (!Config::current().ffbLogEffects) return;
+    const FFBCurvePtr& curve = live().policy.effectCurve[effectKindIndex(kind)];
+    LOG_INFO("FFB [%ls] CreateEffect: type=%s  policy=%s  scale=%d%%  curve=%s",
              m_deviceName.c_str(),
-             effectGuidToString(rguid),
-             m_policy.enabled ? "allow" : "BLOCK",
-             m_policy.scale);
+             effectKindName(kind),
+             isEffectAllowed(kind) ? "allow" : "BLOCK",
+             getScale(kind),
+             curve ? curve->name().c_str() : "linear");
 }
 
 void FFBFilter::logEffectStart(DWORD dwIterations, DWORD dwFlags) const {
-    if (!Config::instance().ffbLogEffects) return;
+    if (!Config::current().ffbLogEffects) return;
     LOG_INFO("FFB [%ls] Effect.Start: iterations=%lu  flags=0x%lx",
              m_deviceName.c_str(), dwIterations, dwFlags);
 }
 
 void FFBFilter::logEffectStop() const {
-    if (!Config::instance().ffbLogEffects) return;
+    if (!Config::current().ffbLogEffects) return;
     LOG_INFO("FFB [%ls] Effect.Stop", m_deviceName.c_str());
 }
 
 void FFBFilter::logEffectParams(const DIEFFECT* pEffect) const {
-    if (!Config::instance().ffbLogEffects || !pEffect) return;
+    if (!Config::current().ffbLogEffects || !pEffect) return;
     LOG_DEBUG("FFB [%ls] Effect.SetParams: gain=%lu  duration=%lu  samplePeriod=%lu  axes=%lu",
               m_deviceName.c_str(),
               pEffect->dwGain,
@@ -157,10 +363,22 @@ void FFBFilter::logEffectParams(const DIEFFECT* pEffect) const {
 }
 
 void FFBFilter::logCommand(DWORD dwCommand) const {
-    if (!Config::instance().ffbLogEffects) return;
+    if (!Config::current().ffbLogEffects) return;
     LOG_INFO("FFB [%ls] SendCommand: %s (0x%lx)  policy=%s",
              m_deviceName.c_str(),
              ffbCommandToString(dwCommand),
              dwCommand,
              m_policy.enabled ? "allow" : "BLOCK");
 }
+
+// ---------------------------------------------------------------------------
+// Binary trace
+// ---------------------------------------------------------------------------
+void FFBFilter::trace(FFBTraceMethod method, EffectKind kind, uint32_t effectSerial,
+                      HRESULT hr, const DIEFFECT* pEffect,
+                      DWORD arg0, DWORD arg1) const
+{
+    auto& t = FFBTrace::instance();
+    if (!t.active()) return;
+    t.record(method, m_traceDeviceId, kind, effectSerial, hr, pEffect, arg0, arg1);
+}
@@ -4,38 +4,201 @@
 
 #include <windows.h>
 #include <dinput.h>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <vector>
+
+#include "config.h"
+#include "effect_kind.h"
+#include "ffb_curve.h"
+#include "ffb_device_worker.h"
+#include "ffb_restore_scheduler.h"
+#include "ffb_scale.h"
+#include "ffb_slot_manager.h"
+#include "ffb_state_registry.h"
+#include "ffb_status_shadow.h"
+#include "ffb_trace_format.h"
 
 // Per-device FFB policy resolved from config.
 struct FFBPolicy {
     bool enabled = true;   // false = all FFB operations silently blocked
     int  scale   = 100;    // 0-100 force magnitude scaling
+    bool suppressRedundant = true;  // skip SetParameters that repeat the last one sent
+    LONG paramDeadband     = 0;     // magnitude change still treated as a repeat
+    int  coalesceHz        = 0;     // >0: SetParameters is latest-wins, flushed at this rate
+    bool asyncCommands     = false; // Start/Stop/Download/SendFFBCommand run on the worker
+    bool autoRestart       = true;  // restart effects that were running before a reconnect
+    DWORD restoreRampMs    = 0;     // soft-start window for restarted effects, 0 = off
+    bool autoReacquire     = true;  // re-acquire after DIERR_INPUTLOST without the game
+    bool prewarm           = false; // pre-build running effects when the device returns
+    bool evictOnFull       = true;  // DIERR_DEVICEFULL unloads the LRU idle effect
+    DWORD statusMaxAgeMs   = 0;     // answer status queries from shadows this fresh, 0 = off
+    // Per effect type (by effectKindIndex), from "Type:action" entries of the
+    // device's rule: a blocked type never reaches the device, the others are
+    // scaled by effectScale (the device scale unless an entry overrides it).
+    std::array<bool, kEffectKindCount> effectBlocked{};
+    std::array<int, kEffectKindCount>  effectScale{};
+    // Response curves ([FFBCurves]): the rule's device curve, and per type
+    // the curve applied before the scale (nullptr = linear).
+    FFBCurvePtr                               curve;
+    std::array<FFBCurvePtr, kEffectKindCount> effectCurve{};
 };
 
 // Stateless helper that applies FFB policy decisions and logging for one device.
+//
+// The policy is split in two. Settings that decide which helper objects
+// exist (enable, worker, auto-restart, slots, prewarm) are fixed when the
+// device is created. The rest (scale, suppression, ramp, re-acquire, status
+// age) follow dinput8.ini hot reloads: syncConfig() re-resolves them into a
+// new immutable snapshot and publishes it with a pointer swap, so readers
+// never lock.
 class FFBFilter {
 public:
-    FFBFilter(const FFBPolicy& policy, const std::wstring& deviceName);
+    // registryDevice is the device's FFBStateRegistry handle, interned from
+    // identity; the filter releases it when destroyed.
+    FFBFilter(const FFBPolicy& policy, DeviceIdentityPtr identity,
+              FFBDeviceHandle registryDevice);
+    ~FFBFilter();
+
+    // The policy cfg gives the device.
+    static FFBPolicy resolvePolicy(const Config& cfg, const DeviceIdentity& device);
+    // "Spring=60% Sine=block Damper=100%@Soft" for the types whose scale or
+    // curve differ from the device's, empty when none do.
+    static std::string describeEffectPolicy(const FFBPolicy& policy);
+
+    // Pick up a reloaded dinput8.ini. One atomic compare unless a reload
+    // happened since the last call; called at the top of the game's FFB calls.
+    void syncConfig() {
+        if (Config::generation() != m_configGeneration.load(std::memory_order_relaxed))
+            reloadPolicy();
+    }
+    // Bumped when a reload changed this device's settings. Effects compare it
+    // to drop their redundancy cache, so a new scale reaches the device.
+    uint32_t policyGeneration() const {
+        return m_policyGeneration.load(std::memory_order_acquire);
+    }
 
     bool isFFBAllowed() const { return m_policy.enabled; }
-    int  getScale()     const { return m_policy.scale; }
+    int  getScale()     const { return live().policy.scale; }
+    // Whether a new effect of this type is created on the device at all.
+    bool isEffectAllowed(EffectKind kind) const {
+        return m_policy.enabled && !live().policy.effectBlocked[effectKindIndex(kind)];
+    }
+    int  getScale(EffectKind kind) const {
+        return live().policy.effectScale[effectKindIndex(kind)];
+    }
+    // Whether scaleEffect changes this type's parameters at all.
+    bool shapesForces(EffectKind kind) const {
+        const LivePolicy& l = live();
+        size_t k = effectKindIndex(kind);
+        return !l.scale[k].identity || l.policy.effectCurve[k];
+    }
+    bool suppressRedundant() const { return live().policy.suppressRedundant; }
+    LONG paramDeadband()     const { return live().policy.paramDeadband; }
+
+    // Background thread for coalesced SetParameters and async commands, or
+    // nullptr when every call is forwarded on the caller's thread.
+    FFBDeviceWorker* worker() const { return m_worker.get(); }
+    bool asyncCommands() const { return m_worker && m_worker->asyncCommands(); }
+    // Auto-restart queue, or nullptr when AutoRestart is off or FFB blocked.
+    FFBRestoreScheduler* restoreScheduler() const { return m_restore.get(); }
+    DWORD restoreRampMs() const { return live().policy.restoreRampMs; }
+    bool autoReacquire() const { return live().policy.autoReacquire; }
+    bool prewarm() const { return m_policy.prewarm; }
+    // Download-slot tracking, or nullptr when EvictOnDeviceFull is off or FFB blocked.
+    FFBSlotManager* slots() const { return m_slots.get(); }
+    // Status shadows (see ffb_status_shadow.h); 0 = always ask the device.
+    DWORD statusMaxAgeMs() const { return live().policy.statusMaxAgeMs; }
+    DeviceStateShadow& stateShadow() { return m_stateShadow; }
     const std::wstring& deviceName() const { return m_deviceName; }
+    const DeviceIdentity& identity() const { return *m_identity; }
+    FFBDeviceHandle registryDevice() const { return m_registryDevice; }
+
+    // Creation ordinal for a new effect (see EffectInstanceId): the lowest
+    // one not held by a live effect of the same type on this device object.
+    // The effect hands it back with releaseOrdinal when it is destroyed.
+    uint32_t acquireOrdinal(EffectKind kind, REFGUID effectGuid);
+    void     releaseOrdinal(EffectKind kind, REFGUID effectGuid, uint32_t ordinal);
 
-    // Scale type-specific force magnitudes in a DIEFFECT copy (modifies in place).
-    // effectGuid is required to correctly identify the type-specific data struct.
-    void scaleEffect(DIEFFECT* pEffect, REFGUID effectGuid) const;
+    // Scale gain, envelope levels and type-specific force magnitudes in place.
+    // The type's response curve, if any, shapes the type-specific magnitudes
+    // first; gain and envelope are only scaled.
+    // Writes through every pointer in pEffect, so it must only be given a
+    // private copy (see WrapperEffect::buildScaledParams), never game memory.
+    // kind (resolved once per effect) selects the type-specific data struct.
+    void scaleEffect(DIEFFECT* pEffect, EffectKind kind) const;
 
     // --------------- Logging helpers ---------------
-    void logEffectCreation(REFGUID rguid) const;
+    void logEffectCreation(EffectKind kind) const;
     void logEffectStart(DWORD dwIterations, DWORD dwFlags) const;
     void logEffectStop() const;
     void logEffectParams(const DIEFFECT* pEffect) const;
     void logCommand(DWORD dwCommand) const;
 
-    static const char* effectGuidToString(REFGUID guid);
+    // Append one record to the binary trace (no-op unless TraceFile=true).
+    void trace(FFBTraceMethod method, EffectKind kind, uint32_t effectSerial,
+               HRESULT hr, const DIEFFECT* pEffect = nullptr,
+               DWORD arg0 = 0, DWORD arg1 = 0) const;
+
+    // SetParameters traffic counters (all effects on this device), logged
+    // when the filter is destroyed.
+    void countParams(bool suppressed) const {
+        (suppressed ? m_paramsSuppressed : m_paramsForwarded)
+            .fetch_add(1, std::memory_order_relaxed);
+    }
+    // A queued update was replaced by a newer one before it was flushed.
+    void countParamsCoalesced() const {
+        m_paramsCoalesced.fetch_add(1, std::memory_order_relaxed);
+    }
+    // A flush-thread SetParameters failed (the game already got DI_OK).
+    void countParamsFailed() const {
+        m_paramsFailed.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    static const char* effectGuidToString(REFGUID guid);   // slow path, GUID compare
     static const char* ffbCommandToString(DWORD cmd);
 
 private:
-    FFBPolicy    m_policy;
-    std::wstring m_deviceName;
+    // Hot-reloadable part of the policy; published snapshots are immutable.
+    struct LivePolicy {
+        FFBPolicy policy;
+        std::array<FFBScaleFactor, kEffectKindCount> scale;   // of policy.effectScale
+    };
+    static LivePolicy makeLive(const FFBPolicy& policy);
+    const LivePolicy& live() const { return *m_live.load(std::memory_order_acquire); }
+    void reloadPolicy();
+
+    FFBPolicy      m_policy;         // as created; structural fields only change here
+    DeviceIdentityPtr m_identity;
+    std::wstring   m_deviceName;
+    FFBDeviceHandle m_registryDevice = kInvalidDeviceHandle;
+    uint16_t     m_traceDeviceId = 0;
+
+    // Live ordinals as bit masks, by kind (vendor effects by GUID).
+    std::mutex                            m_ordinalMutex;
+    std::array<uint64_t, kEffectKindCount> m_liveOrdinals{};
+    std::map<GUID, uint64_t, GUIDLess>     m_liveVendorOrdinals;
+
+    // Live policy snapshots. Superseded ones are kept for the filter's life:
+    // a reader may still be looking at one (reloads are rare and small).
+    std::atomic<const LivePolicy*>           m_live{nullptr};
+    std::atomic<uint32_t>                    m_configGeneration{~0u};   // ~0: check on first use
+    std::atomic<uint32_t>                    m_policyGeneration{0};
+    std::mutex                               m_reloadMutex;
+    std::vector<std::unique_ptr<LivePolicy>> m_livePolicies;   // under m_reloadMutex
+
+    mutable std::atomic<uint64_t> m_paramsForwarded{0};
+    mutable std::atomic<uint64_t> m_paramsSuppressed{0};
+    mutable std::atomic<uint64_t> m_paramsCoalesced{0};
+    mutable std::atomic<uint64_t> m_paramsFailed{0};
+
+    std::unique_ptr<FFBRestoreScheduler> m_restore;
+    std::unique_ptr<FFBSlotManager>      m_slots;
+    DeviceStateShadow                    m_stateShadow;
+    std::unique_ptr<FFBDeviceWorker> m_worker;   // declared last: stopped first
 };
@@ -0,0 +1,87 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026 Valmantas Paliksa
+#include "ffb_prewarm_pool.h"
+#include "wrapper_effect.h"
+#include "logger.h"
+
+FFBPrewarmPool::FFBPrewarmPool(const std::wstring& deviceName)
+    : m_deviceName(deviceName)
+{
+    LARGE_INTEGER freq, now;
+    if (QueryPerformanceFrequency(&freq) && freq.QuadPart > 0)
+        m_qpcFrequency = freq.QuadPart;
+    QueryPerformanceCounter(&now);
+    m_createdAt = now.QuadPart;
+}
+
+FFBPrewarmPool::~FFBPrewarmPool() {
+    for (Entry& e : m_entries)
+        e.effect->Release();
+
+    if (m_created == 0) return;
+    // Every adopted effect is one CreateEffect the game did not wait on.
+    LOG_INFO("FFB [%ls] Prewarm: %u created, %u downloaded in one pass (%.1f ms), "
+             "%u adopted (%u game-thread round trips saved), %zu unused",
+             m_deviceName.c_str(), m_created, m_downloaded, m_prepareMs,
+             m_adopted, m_adopted, m_entries.size());
+}
+
+void FFBPrewarmPool::add(WrapperEffect* effect, const EffectStateRecord& record) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_entries.push_back({ effect, record });
+    ++m_created;
+}
+
+size_t FFBPrewarmPool::prepare() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_prepared) return 0;
+    m_prepared = true;
+
+    LARGE_INTEGER start;
+    QueryPerformanceCounter(&start);
+
+    // Parameters without downloading, then one pass of downloads.
+    std::vector<HRESULT> results(m_entries.size(), DI_OK);
+    for (size_t i = 0; i < m_entries.size(); ++i) {
+        Entry& e = m_entries[i];
+        if (!e.record.hasParams) continue;
+        DIEFFECT params = e.record.replayParams();
+        params.dwSize = sizeof(DIEFFECT);
+        results[i] = e.effect->restoreParams(
+            &params, WrapperEffect::paramFlagsFor(params) | DIEP_NODOWNLOAD);
+    }
+    for (size_t i = 0; i < m_entries.size(); ++i) {
+        if (SUCCEEDED(results[i]))
+            results[i] = m_entries[i].effect->forwardDownload();
+        if (SUCCEEDED(results[i])) {
+            ++m_downloaded;
+        } else {
+            LOG_DEBUG("FFB [%ls] Prewarm of %s#%u failed: 0x%08lx", m_deviceName.c_str(),
+                      effectKindName(m_entries[i].record.kind),
+                      m_entries[i].record.ordinal, results[i]);
+        }
+    }
+
+    LARGE_INTEGER end;
+    QueryPerformanceCounter(&end);
+    m_prepareMs = 1000.0 * static_cast<double>(end.QuadPart - start.QuadPart) /
+                  static_cast<double>(m_qpcFrequency);
+    return m_downloaded;
+}
+
+WrapperEffect* FFBPrewarmPool::take(EffectKind kind, REFGUID guid) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    size_t best = m_entries.size();
+    for (size_t i = 0; i < m_entries.size(); ++i) {
+        const EffectStateRecord& r = m_entries[i].record;
+        if (r.kind != kind || r.guid != guid) continue;
+        if (best == m_entries.size() || r.ordinal < m_entries[best].record.ordinal)
+            best = i;
+    }
+    if (best == m_entries.size()) return nullptr;
+
+    WrapperEffect* effect = m_entries[best].effect;
+    m_entries.erase(m_entries.begin() + static_cast<std::ptrdiff_t>(best));
+    ++m_adopted;
+    return effect;
+}
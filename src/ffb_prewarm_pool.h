@@ -0,0 +1,71 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026 Valmantas Paliksa
+#pragma once
+
+#include <windows.h>
+#include <dinput.h>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "effect_kind.h"
+#include "ffb_state_registry.h"
+
+class WrapperEffect;
+
+// Effects built ahead of the game for a device that reappeared ([FFB] Prewarm).
+//
+// After a reconnect DCS creates its effects one CreateEffect at a time, each
+// a device round trip on the game thread, and auto-restart then replays
+// parameters on top. With prewarming, WrapperDevice8 creates an empty effect
+// for every record that was running as soon as CreateDevice returns (no data
+// format is set yet, so no parameters), then at the game's first successful
+// Acquire sets the recorded parameters and downloads them all in one pass.
+// The game's CreateEffect is handed the matching pre-built wrapper instead
+// of creating a new one; its parameters only reach the device if they differ
+// from the recorded ones (the wrapper's redundancy cache already holds them).
+//
+// Effects are matched by type and creation order: take() returns the
+// lowest-ordinal pooled effect, the same ordinal a fresh wrapper would get.
+// Anything the game never asks for is released with the pool.
+class FFBPrewarmPool {
+public:
+    explicit FFBPrewarmPool(const std::wstring& deviceName);
+    ~FFBPrewarmPool();
+
+    FFBPrewarmPool(const FFBPrewarmPool&) = delete;
+    FFBPrewarmPool& operator=(const FFBPrewarmPool&) = delete;
+
+    // Pool effect (taking over its reference), to be given record's parameters.
+    void add(WrapperEffect* effect, const EffectStateRecord& record);
+
+    // Set parameters and download every pooled effect, once; later calls do
+    // nothing. Returns the number downloaded.
+    size_t prepare();
+
+    // Hand out the pooled effect for (kind, guid) with the lowest ordinal;
+    // the caller owns the reference. nullptr if there is none.
+    WrapperEffect* take(EffectKind kind, REFGUID guid);
+
+    // QPC tick at which the pool was built (the device's CreateDevice).
+    LONGLONG createdAt() const { return m_createdAt; }
+
+private:
+    struct Entry {
+        WrapperEffect*    effect;
+        EffectStateRecord record;
+    };
+
+    std::wstring       m_deviceName;
+    std::mutex         m_mutex;
+    std::vector<Entry> m_entries;
+    bool               m_prepared = false;
+    LONGLONG           m_createdAt = 0;
+    LONGLONG           m_qpcFrequency = 1;
+
+    // Statistics, logged on destruction
+    unsigned m_created    = 0;
+    unsigned m_downloaded = 0;
+    unsigned m_adopted    = 0;
+    double   m_prepareMs  = 0.0;
+};
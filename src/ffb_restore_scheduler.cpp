@@ -0,0 +1,309 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026 Valmantas Paliksa
+#include "ffb_restore_scheduler.h"
+#include "ffb_filter.h"
+#include "wrapper_effect.h"
+#include "logger.h"
+#include <algorithm>
+
+FFBRestoreScheduler::FFBRestoreScheduler(const FFBFilter& filter)
+    : m_filter(filter)
+{
+    LARGE_INTEGER freq;
+    if (QueryPerformanceFrequency(&freq) && freq.QuadPart > 0)
+        m_qpcFrequency = freq.QuadPart;
+}
+
+FFBRestoreScheduler::~FFBRestoreScheduler() {
+    if (m_thread) {
+        SetEvent(m_stop);
+        // The thread uses this object until it returns, so wait it out.
+        // It checks m_stop between batches and never blocks on the caller;
+        // during process exit it is already gone and this returns at once.
+        WaitForSingleObject(m_thread, INFINITE);
+        CloseHandle(m_thread);
+    }
+    if (m_wake) CloseHandle(m_wake);
+    if (m_stop) CloseHandle(m_stop);
+}
+
+// Devices that never lose their effects never pay for a thread.
+bool FFBRestoreScheduler::startThreadLocked() {
+    if (m_thread) return true;
+    if (!m_stop) m_stop = CreateEventW(nullptr, TRUE,  FALSE, nullptr);
+    if (!m_wake) m_wake = CreateEventW(nullptr, FALSE, FALSE, nullptr);
+    if (m_stop && m_wake)
+        m_thread = CreateThread(nullptr, 0, &FFBRestoreScheduler::threadProc, this, 0, nullptr);
+    if (!m_thread) {
+        LOG_ERROR("[%ls] Auto-restart: cannot start restore thread (%lu)",
+                  m_filter.deviceName().c_str(), GetLastError());
+        return false;
+    }
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// Queue (any thread)
+// ---------------------------------------------------------------------------
+void FFBRestoreScheduler::schedule(WrapperEffect* effect, const EffectStateRecord& record,
+                                   bool devicePaused)
+{
+    std::lock_guard<std::mutex> lock(m_jobsMutex);
+    if (!startThreadLocked()) return;
+
+    if (m_jobs.empty() && m_inFlight == 0) {
+        LARGE_INTEGER now;
+        QueryPerformanceCounter(&now);
+        m_roundStart = now.QuadPart;
+        m_restored = m_retries = m_abandoned = 0;
+    }
+
+    effect->markRestorePending();
+    m_jobs.push_back({ effect, record, devicePaused, 0, m_tick(), DI_OK });
+    SetEvent(m_wake);
+}
+
+void FFBRestoreScheduler::noteReconnect(LONGLONG qpc) {
+    std::lock_guard<std::mutex> lock(m_jobsMutex);
+    m_reconnectAt = qpc;
+}
+
+void FFBRestoreScheduler::add(WrapperEffect* effect) {
+    std::lock_guard<std::mutex> lock(m_effectsMutex);
+    m_effects.push_back(effect);
+}
+
+void FFBRestoreScheduler::remove(WrapperEffect* effect) {
+    {
+        std::lock_guard<std::mutex> lock(m_effectsMutex);
+        auto it = std::find(m_effects.begin(), m_effects.end(), effect);
+        if (it != m_effects.end()) {
+            *it = m_effects.back();
+            m_effects.pop_back();
+        }
+    }
+
+    std::lock_guard<std::mutex> run(m_runMutex);
+    m_ramps.erase(std::remove_if(m_ramps.begin(), m_ramps.end(),
+                                 [effect](const Ramp& r) { return r.effect == effect; }),
+                  m_ramps.end());
+    std::lock_guard<std::mutex> lock(m_jobsMutex);
+    m_jobs.erase(std::remove_if(m_jobs.begin(), m_jobs.end(),
+                                [effect](const Job& j) { return j.effect == effect; }),
+                 m_jobs.end());
+}
+
+size_t FFBRestoreScheduler::scheduleRunning(const FFBDeviceSnapshot& snap) {
+    std::lock_guard<std::mutex> lock(m_effectsMutex);
+    size_t queued = 0;
+    for (WrapperEffect* e : m_effects) {
+        if (e->restoreState() & WrapperEffect::kRestorePending) continue;
+        const EffectStateRecord* rec = snap.find(e->instanceId());
+        if (!rec || !rec->wasRunning) continue;
+        schedule(e, *rec, snap.paused);
+        ++queued;
+    }
+    return queued;
+}
+
+// ---------------------------------------------------------------------------
+// Restore thread
+// ---------------------------------------------------------------------------
+
+void FFBRestoreScheduler::runBatch(std::vector<Job>& batch) {
+    const std::wstring& name = m_filter.deviceName();
+
+    // Skip jobs the game has overtaken, then replay recorded parameters.
+    const DWORD rampMs = m_filter.restoreRampMs();
+    for (Job& j : batch) {
+        j.hr = DI_OK;
+        if (j.effect->restoreState() & WrapperEffect::kRestoreCancelled) {
+            j.hr = E_ABORT;
+            continue;
+        }
+        if (j.record.hasParams &&
+            !(j.effect->restoreState() & WrapperEffect::kRestoreParamsStale))
+        {
+            DIEFFECT params = j.record.replayParams();
+            params.dwSize = sizeof(DIEFFECT);
+            // Downloaded with the batch below.
+            j.hr = j.effect->restoreParams(
+                &params, WrapperEffect::paramFlagsFor(params) | DIEP_NODOWNLOAD);
+        }
+        // Soft start: the effect begins at zero gain.
+        if (rampMs && SUCCEEDED(j.hr))
+            j.hr = j.effect->stepRamp(0, DIEP_NODOWNLOAD);
+    }
+
+    // One pass of downloads, then one of starts.
+    for (Job& j : batch) {
+        if (FAILED(j.hr)) continue;
+        HRESULT hr = j.effect->forwardDownload();
+        if (FAILED(hr)) j.hr = hr;
+    }
+    for (Job& j : batch) {
+        if (FAILED(j.hr)) continue;
+        HRESULT hr = j.effect->forwardStart(j.record.lastIterations,
+                                            j.record.lastStartFlags);
+        if (FAILED(hr)) j.hr = hr;
+    }
+
+    // Verify: the device must report the effect as playing.
+    for (Job& j : batch) {
+        if (FAILED(j.hr) || j.devicePaused) continue;
+        DWORD status = 0;
+        HRESULT hr = j.effect->realEffect()->GetEffectStatus(&status);
+        if (FAILED(hr))
+            j.hr = hr;
+        else if (!(status & DIEGES_PLAYING))
+            j.hr = S_FALSE;   // accepted but not playing
+    }
+
+    for (Job& j : batch) {
+        DIEFFECT params = j.record.replayParams();
+        m_filter.trace(FFBTraceMethod::AutoRestart, j.record.kind, j.effect->serial(),
+                       j.hr, j.record.hasParams ? &params : nullptr,
+                       j.record.lastIterations, j.record.lastStartFlags);
+        if (j.hr == DI_OK) {
+            LOG_INFO("FFB [%ls] Auto-restarted %s#%u (attempt %u)", name.c_str(),
+                     effectKindName(j.record.kind), j.record.ordinal, j.attempts + 1);
+        } else {
+            LOG_DEBUG("FFB [%ls] Auto-restart %s#%u attempt %u failed: 0x%08lx",
+                      name.c_str(), effectKindName(j.record.kind), j.record.ordinal,
+                      j.attempts + 1, j.hr);
+        }
+    }
+}
+
+// Caller holds m_runMutex.
+void FFBRestoreScheduler::finishBatch(std::vector<Job>& batch) {
+    const DWORD rampMs = m_filter.restoreRampMs();
+    ULONGLONG now = m_tick();
+
+    std::lock_guard<std::mutex> lock(m_jobsMutex);
+    for (Job& j : batch) {
+        if (j.hr == DI_OK) {
+            j.effect->clearRestorePending();
+            ++m_restored;
+            if (rampMs) m_ramps.push_back({ j.effect, now });
+            continue;
+        }
+
+        bool cancelled = (j.effect->restoreState() & WrapperEffect::kRestoreCancelled) != 0;
+        if (cancelled || j.attempts + 1 >= kMaxAttempts) {
+            // Not restarting after all: the game's own forces must not stay
+            // scaled down by a ramp that never ran.
+            if (rampMs) j.effect->stepRamp(WrapperEffect::kRampFull);
+            j.effect->clearRestorePending();
+            if (!cancelled) {
+                ++m_abandoned;
+                LOG_WARN("FFB [%ls] Auto-restart of %s#%u gave up after %u attempts "
+                         "(last 0x%08lx)", m_filter.deviceName().c_str(),
+                         effectKindName(j.record.kind), j.record.ordinal,
+                         j.attempts + 1, j.hr);
+            }
+            continue;
+        }
+
+        ++j.attempts;
+        ++m_retries;
+        DWORD backoff = std::min<DWORD>(kFirstBackoffMs << (j.attempts - 1), kMaxBackoffMs);
+        j.dueTick = now + backoff;
+        m_jobs.push_back(j);
+    }
+    m_inFlight = 0;
+
+    if (m_jobs.empty() && (m_restored || m_abandoned)) {
+        LARGE_INTEGER qpc;
+        QueryPerformanceCounter(&qpc);
+        LOG_INFO("FFB [%ls] Auto-restart: force restored in %.1f ms "
+                 "(%u effects, %u retries, %u abandoned%s)",
+                 m_filter.deviceName().c_str(),
+                 1000.0 * static_cast<double>(qpc.QuadPart - m_roundStart) /
+                     static_cast<double>(m_qpcFrequency),
+                 m_restored, m_retries, m_abandoned,
+                 rampMs ? ", ramping up" : "");
+        if (m_reconnectAt) {
+            LOG_INFO("FFB [%ls] Auto-restart: force back %.1f ms after CreateDevice",
+                     m_filter.deviceName().c_str(),
+                     1000.0 * static_cast<double>(qpc.QuadPart - m_reconnectAt) /
+                         static_cast<double>(m_qpcFrequency));
+            m_reconnectAt = 0;
+        }
+        m_restored = m_abandoned = 0;
+    }
+}
+
+// Caller holds m_runMutex. Brings each ramping effect's gain up linearly.
+void FFBRestoreScheduler::stepRamps() {
+    const DWORD rampMs = m_filter.restoreRampMs();
+    ULONGLONG now = m_tick();
+    for (size_t i = 0; i < m_ramps.size();) {
+        ULONGLONG elapsed = now - m_ramps[i].startTick;
+        LONG permille = rampMs && elapsed < rampMs
+            ? static_cast<LONG>(elapsed * WrapperEffect::kRampFull / rampMs)
+            : WrapperEffect::kRampFull;
+
+        HRESULT hr = m_ramps[i].effect->stepRamp(permille);
+        if (FAILED(hr))
+            LOG_DEBUG("FFB [%ls] Soft-start step %ld failed: 0x%08lx",
+                      m_filter.deviceName().c_str(), permille, hr);
+
+        if (permille == WrapperEffect::kRampFull) {
+            m_ramps[i] = m_ramps.back();
+            m_ramps.pop_back();
+        } else {
+            ++i;
+        }
+    }
+}
+
+void FFBRestoreScheduler::run() {
+    std::vector<Job> batch;
+    for (;;) {
+        DWORD waitMs = INFINITE;
+        {
+            // Held from taking the jobs until the batch is done: remove()
+            // must not return while a taken job still points at its effect.
+            std::lock_guard<std::mutex> run(m_runMutex);
+
+            // Take every due job; note when the next one is due.
+            {
+                std::lock_guard<std::mutex> lock(m_jobsMutex);
+                ULONGLONG now = m_tick();
+                batch.clear();
+                for (size_t i = 0; i < m_jobs.size();) {
+                    if (m_jobs[i].dueTick <= now) {
+                        batch.push_back(m_jobs[i]);
+                        m_jobs[i] = m_jobs.back();
+                        m_jobs.pop_back();
+                    } else {
+                        waitMs = std::min<DWORD>(waitMs,
+                                                 static_cast<DWORD>(m_jobs[i].dueTick - now));
+                        ++i;
+                    }
+                }
+                m_inFlight = batch.size();
+            }
+
+            if (!batch.empty()) {
+                runBatch(batch);
+                finishBatch(batch);
+            }
+            stepRamps();
+            if (!m_ramps.empty())
+                waitMs = std::min(waitMs, kRampStepMs);
+        }
+        if (WaitForSingleObject(m_stop, 0) == WAIT_OBJECT_0) return;
+        if (!batch.empty()) continue;   // retries may already be due
+
+        const HANDLE handles[2] = { m_stop, m_wake };
+        DWORD r = WaitForMultipleObjects(2, handles, FALSE, waitMs);
+        if (r == WAIT_OBJECT_0 || r == WAIT_FAILED) return;
+    }
+}
+
+DWORD WINAPI FFBRestoreScheduler::threadProc(LPVOID param) {
+    static_cast<FFBRestoreScheduler*>(param)->run();
+    return 0;
+}
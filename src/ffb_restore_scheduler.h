@@ -0,0 +1,123 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026 Valmantas Paliksa
+#pragma once
+
+#include <windows.h>
+#include <dinput.h>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "ffb_state_registry.h"
+
+class FFBFilter;
+class WrapperEffect;
+
+// Per-device auto-restart queue, run on its own thread.
+//
+// WrapperDevice8::CreateEffect used to replay SetParameters + Start inline;
+// on a freshly reconnected USB device those calls can be slow or fail
+// transiently, stalling the game's device re-init. Now CreateEffect only
+// calls schedule() and returns.
+//
+// The thread takes every due job as one batch: replay parameters (without
+// downloading), Download all, Start all, then verify with GetEffectStatus.
+// A job that failed any step is retried with exponential backoff up to
+// kMaxAttempts times. When the queue drains, the time from the first
+// schedule() of the round to the last verified restart is logged.
+//
+// With [FFB] RestoreRampMs the effect is started at zero gain and the same
+// thread raises it to full over the ramp window in kRampStepMs steps
+// (WrapperEffect::stepRamp), so a restored spring or trim force doesn't snap
+// the stick. The game's SetParameters calls meanwhile are scaled by the
+// current ramp position.
+//
+// The game's own Start/Stop/Unload on the effect cancel its job, and its own
+// SetParameters stops the recorded parameters from being replayed (see
+// WrapperEffect::restoreState).
+//
+// The scheduler also knows the device's live effects, so when the device
+// comes back under the same device object (WrapperDevice8 re-acquiring after
+// DIERR_INPUTLOST) scheduleRunning() can restart the ones that were playing.
+class FFBRestoreScheduler {
+public:
+    explicit FFBRestoreScheduler(const FFBFilter& filter);
+    ~FFBRestoreScheduler();
+
+    FFBRestoreScheduler(const FFBRestoreScheduler&) = delete;
+    FFBRestoreScheduler& operator=(const FFBRestoreScheduler&) = delete;
+
+    // Queue a restart of effect from record. devicePaused skips the
+    // playing check (a paused device reports nothing as playing).
+    void schedule(WrapperEffect* effect, const EffectStateRecord& record, bool devicePaused);
+
+    // QPC tick of the CreateDevice that brought the device back; the next
+    // round's log line also reports the time from there to restored force.
+    void noteReconnect(LONGLONG qpc);
+
+    // Track a live effect / forget it and drop its job. remove() waits out a
+    // batch in progress so the effect can be destroyed afterwards.
+    void add(WrapperEffect* effect);
+    void remove(WrapperEffect* effect);
+
+    // Queue every tracked effect whose record in snap says it was running
+    // and that has no restart pending yet. Returns the number queued.
+    size_t scheduleRunning(const FFBDeviceSnapshot& snap);
+
+    // Millisecond clock behind backoff and ramp timing (GetTickCount64).
+    // Tests substitute a simulated one before the first schedule().
+    using TickSource = ULONGLONG (*)();
+    void setTickSource(TickSource source) { m_tick = source ? source : &systemTick; }
+
+private:
+    static constexpr unsigned kMaxAttempts    = 6;
+    static constexpr DWORD    kFirstBackoffMs = 50;
+    static constexpr DWORD    kMaxBackoffMs   = 2000;
+    static constexpr DWORD    kRampStepMs     = 20;
+
+    struct Job {
+        WrapperEffect*    effect;
+        EffectStateRecord record;
+        bool              devicePaused;
+        unsigned          attempts;
+        ULONGLONG         dueTick;   // m_tick
+        HRESULT           hr;        // first failure of the current attempt
+    };
+
+    struct Ramp {
+        WrapperEffect* effect;
+        ULONGLONG      startTick;   // m_tick at the verified start
+    };
+
+    static ULONGLONG systemTick() { return GetTickCount64(); }
+    static DWORD WINAPI threadProc(LPVOID param);
+    void run();
+    void runBatch(std::vector<Job>& batch);
+    void finishBatch(std::vector<Job>& batch);
+    void stepRamps();
+    bool startThreadLocked();
+
+    const FFBFilter& m_filter;
+    TickSource       m_tick = &systemTick;
+
+    std::mutex                  m_effectsMutex;   // m_effects
+    std::vector<WrapperEffect*> m_effects;
+
+    std::mutex       m_jobsMutex;   // m_jobs, m_inFlight, round statistics
+    std::vector<Job> m_jobs;
+    size_t           m_inFlight = 0;
+    std::mutex       m_runMutex;    // held from taking a batch to its end; guards m_ramps
+    std::vector<Ramp> m_ramps;
+
+    // Current round (schedule() on an idle queue starts one)
+    LONGLONG m_roundStart = 0;      // QPC ticks
+    unsigned m_restored   = 0;
+    unsigned m_retries    = 0;
+    unsigned m_abandoned  = 0;
+    LONGLONG m_qpcFrequency = 1;
+    LONGLONG m_reconnectAt  = 0;    // see noteReconnect
+
+    HANDLE m_thread = nullptr;
+    HANDLE m_stop   = nullptr;
+    HANDLE m_wake   = nullptr;
+};
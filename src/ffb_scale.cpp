@@ -0,0 +1,254 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026 Valmantas Paliksa
+#include "ffb_scale.h"
+#include <cstdlib>
+#include <cstring>
+
+#if defined(_M_X64) || defined(__x86_64__) || defined(_M_IX86) || defined(__i386__)
+#define FFB_SCALE_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(__clang__) || defined(__GNUC__)
+#define FFB_TARGET_AVX2 __attribute__((target("avx2")))
+#define FFB_TARGET_SSE2 __attribute__((target("sse2")))
+#else
+#define FFB_TARGET_AVX2
+#define FFB_TARGET_SSE2
+#endif
+
+FFBScaleFactor ffbMakeScaleFactor(int percent) {
+    FFBScaleFactor f;
+    if (percent >= 100) return f;
+    if (percent < 0) percent = 0;
+    // ceil(2^32 * percent / 100); < 2^32 for percent <= 99
+    uint64_t num = static_cast<uint64_t>(percent) << 32;
+    f.mul      = static_cast<uint32_t>((num + 99) / 100);
+    f.identity = false;
+    return f;
+}
+
+// ============================================================================
+// Scalar reference
+// ============================================================================
+void ffbScaleSamplesScalar(int32_t* data, size_t count, FFBScaleFactor f) {
+    if (f.identity) return;
+    for (size_t i = 0; i < count; ++i)
+        data[i] = ffbScaleSigned(data[i], f);
+}
+
+void ffbScaleConditionsScalar(int32_t* records, size_t count, FFBScaleFactor f) {
+    if (f.identity) return;
+    for (size_t i = 0; i < count; ++i) {
+        int32_t* c = records + i * 6;
+        c[1] = ffbScaleSigned(c[1], f);
+        c[2] = ffbScaleSigned(c[2], f);
+        c[3] = static_cast<int32_t>(ffbScaleUnsigned(static_cast<uint32_t>(c[3]), f));
+        c[4] = static_cast<int32_t>(ffbScaleUnsigned(static_cast<uint32_t>(c[4]), f));
+    }
+}
+
+void ffbCurveSamplesScalar(int32_t* data, size_t count, const uint16_t* table,
+                           uint32_t maxInput)
+{
+    for (size_t i = 0; i < count; ++i) {
+        int32_t  v   = data[i];
+        uint32_t mag = v < 0 ? 0u - static_cast<uint32_t>(v) : static_cast<uint32_t>(v);
+        int32_t  r   = table[mag < maxInput ? mag : maxInput];
+        data[i] = v < 0 ? -r : r;
+    }
+}
+
+#if FFB_SCALE_X86
+// ============================================================================
+// SSE2
+// ============================================================================
+
+// Scale four lanes. signMask selects which lanes are signed (all-ones) and
+// which are unsigned (zero). pmuludq only multiplies the even lanes, so the
+// odd lanes go through a second multiply after a 32-bit shift.
+FFB_TARGET_SSE2
+static inline __m128i scale4(__m128i v, __m128i mul, __m128i signMask) {
+    __m128i sign = _mm_and_si128(_mm_srai_epi32(v, 31), signMask);
+    __m128i mag  = _mm_sub_epi32(_mm_xor_si128(v, sign), sign);       // |v|
+    __m128i even = _mm_mul_epu32(mag, mul);                            // lanes 0,2
+    __m128i odd  = _mm_mul_epu32(_mm_srli_epi64(mag, 32), mul);        // lanes 1,3
+    __m128i hiMask = _mm_set_epi32(-1, 0, -1, 0);
+    __m128i r = _mm_or_si128(_mm_srli_epi64(even, 32), _mm_and_si128(odd, hiMask));
+    return _mm_sub_epi32(_mm_xor_si128(r, sign), sign);               // restore sign
+}
+
+FFB_TARGET_SSE2
+static void scaleSamplesSSE2(int32_t* data, size_t count, FFBScaleFactor f) {
+    const __m128i mul  = _mm_set1_epi32(static_cast<int32_t>(f.mul));
+    const __m128i ones = _mm_set1_epi32(-1);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(data + i), scale4(v, mul, ones));
+    }
+    for (; i < count; ++i)
+        data[i] = ffbScaleSigned(data[i], f);
+}
+
+// One DICONDITION per iteration: fields 1..4 form exactly one 128-bit vector
+// (two signed coefficients, two unsigned saturations).
+FFB_TARGET_SSE2
+static void scaleConditionsSSE2(int32_t* records, size_t count, FFBScaleFactor f) {
+    const __m128i mul      = _mm_set1_epi32(static_cast<int32_t>(f.mul));
+    const __m128i signMask = _mm_set_epi32(0, 0, -1, -1);
+    for (size_t i = 0; i < count; ++i) {
+        auto* p = reinterpret_cast<__m128i*>(records + i * 6 + 1);
+        _mm_storeu_si128(p, scale4(_mm_loadu_si128(p), mul, signMask));
+    }
+}
+
+// ============================================================================
+// AVX2
+// ============================================================================
+FFB_TARGET_AVX2
+static void scaleSamplesAVX2(int32_t* data, size_t count, FFBScaleFactor f) {
+    const __m256i mul    = _mm256_set1_epi32(static_cast<int32_t>(f.mul));
+    const __m256i hiMask = _mm256_set_epi32(-1, 0, -1, 0, -1, 0, -1, 0);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        auto* p = reinterpret_cast<__m256i*>(data + i);
+        __m256i v    = _mm256_loadu_si256(p);
+        __m256i sign = _mm256_srai_epi32(v, 31);
+        __m256i mag  = _mm256_sub_epi32(_mm256_xor_si256(v, sign), sign);
+        __m256i even = _mm256_mul_epu32(mag, mul);
+        __m256i odd  = _mm256_mul_epu32(_mm256_srli_epi64(mag, 32), mul);
+        __m256i r    = _mm256_or_si256(_mm256_srli_epi64(even, 32),
+                                       _mm256_and_si256(odd, hiMask));
+        _mm256_storeu_si256(p, _mm256_sub_epi32(_mm256_xor_si256(r, sign), sign));
+    }
+    if (i < count)
+        scaleSamplesSSE2(data + i, count - i, f);
+}
+
+// Eight table lookups per iteration. The gather reads 32 bits at
+// table + 2 * index, so the low half is the entry and the high half (the
+// next entry, or the padding slot after maxInput) is masked off.
+FFB_TARGET_AVX2
+static void curveSamplesAVX2(int32_t* data, size_t count, const uint16_t* table,
+                             uint32_t maxInput)
+{
+    const __m256i limit = _mm256_set1_epi32(static_cast<int32_t>(maxInput));
+    const __m256i low16 = _mm256_set1_epi32(0xFFFF);
+    const auto*   base  = reinterpret_cast<const int*>(table);
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        auto* p = reinterpret_cast<__m256i*>(data + i);
+        __m256i v    = _mm256_loadu_si256(p);
+        __m256i sign = _mm256_srai_epi32(v, 31);
+        __m256i mag  = _mm256_sub_epi32(_mm256_xor_si256(v, sign), sign);
+        __m256i idx  = _mm256_min_epu32(mag, limit);
+        __m256i r    = _mm256_and_si256(_mm256_i32gather_epi32(base, idx, 2), low16);
+        _mm256_storeu_si256(p, _mm256_sub_epi32(_mm256_xor_si256(r, sign), sign));
+    }
+    if (i < count)
+        ffbCurveSamplesScalar(data + i, count - i, table, maxInput);
+}
+
+static bool cpuHasAVX2() {
+#if defined(_MSC_VER) && !defined(__clang__)
+    int regs[4];
+    __cpuid(regs, 0);
+    if (regs[0] < 7) return false;
+    __cpuid(regs, 1);
+    bool osxsave = (regs[2] & (1 << 27)) != 0;
+    bool avx     = (regs[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6) return false;
+    __cpuidex(regs, 7, 0);
+    return (regs[1] & (1 << 5)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+static bool cpuHasSSE2() {
+#if defined(_M_X64) || defined(__x86_64__)
+    return true;   // baseline on x64
+#elif defined(_MSC_VER) && !defined(__clang__)
+    int regs[4];
+    __cpuid(regs, 1);
+    return (regs[3] & (1 << 26)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("sse2");
+#endif
+}
+#endif  // FFB_SCALE_X86
+
+// ============================================================================
+// Dispatch (resolved once on first use)
+// ============================================================================
+namespace {
+enum class Kernel { Scalar, SSE2, AVX2 };
+
+Kernel selectKernel() {
+    Kernel best = Kernel::Scalar;
+#if FFB_SCALE_X86
+    if (cpuHasAVX2())      best = Kernel::AVX2;
+    else if (cpuHasSSE2()) best = Kernel::SSE2;
+#endif
+    // DINPUT8_FFB_KERNEL=scalar|sse2 pins a slower path, so the tests and
+    // A/B timings can cover every kernel on one machine.
+    if (const char* env = std::getenv("DINPUT8_FFB_KERNEL")) {
+        if (std::strcmp(env, "scalar") == 0) return Kernel::Scalar;
+        if (std::strcmp(env, "sse2") == 0 && best != Kernel::Scalar) return Kernel::SSE2;
+    }
+    return best;
+}
+
+Kernel activeKernel() {
+    static const Kernel k = selectKernel();
+    return k;
+}
+}  // namespace
+
+void ffbScaleSamples(int32_t* data, size_t count, FFBScaleFactor f) {
+    if (f.identity || !data || count == 0) return;
+    switch (activeKernel()) {
+#if FFB_SCALE_X86
+    case Kernel::AVX2: scaleSamplesAVX2(data, count, f); return;
+    case Kernel::SSE2: scaleSamplesSSE2(data, count, f); return;
+#endif
+    default:           ffbScaleSamplesScalar(data, count, f); return;
+    }
+}
+
+void ffbScaleConditions(int32_t* records, size_t count, FFBScaleFactor f) {
+    if (f.identity || !records || count == 0) return;
+#if FFB_SCALE_X86
+    if (activeKernel() != Kernel::Scalar) {
+        scaleConditionsSSE2(records, count, f);
+        return;
+    }
+#endif
+    ffbScaleConditionsScalar(records, count, f);
+}
+
+// SSE2 has no gather; below AVX2 the scalar loop is as fast as anything.
+void ffbCurveSamples(int32_t* data, size_t count, const uint16_t* table, uint32_t maxInput) {
+    if (!data || !table || count == 0) return;
+#if FFB_SCALE_X86
+    if (activeKernel() == Kernel::AVX2) {
+        curveSamplesAVX2(data, count, table, maxInput);
+        return;
+    }
+#endif
+    ffbCurveSamplesScalar(data, count, table, maxInput);
+}
+
+const char* ffbScaleKernelName() {
+    switch (activeKernel()) {
+    case Kernel::AVX2: return "avx2";
+    case Kernel::SSE2: return "sse2";
+    default:           return "scalar";
+    }
+}
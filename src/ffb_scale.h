@@ -0,0 +1,66 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026 Valmantas Paliksa
+#pragma once
+//
+// Integer force-scaling kernel.
+//
+// A device's percentage scale is turned once into a 0.32 fixed-point
+// multiplier M = ceil(2^32 * percent / 100). Every magnitude is then scaled as
+//
+//     out = sign(v) * ((|v| * M) >> 32)
+//
+// i.e. truncation toward zero, the same rounding the old float path used via
+// static_cast. For |v| < 42,949,672 (far beyond DI_FFNOMINALMAX) this equals
+// the exact trunc(v * percent / 100); the float path could be off by one LSB.
+// The factor never exceeds 1, so results cannot overflow: saturation is
+// implicit and INT32_MIN maps to a representable value.
+//
+// The SSE2/AVX2 paths and the scalar fallback produce bit-identical output.
+// No Windows types here, so the kernel can be exercised on any platform.
+//
+#include <cstddef>
+#include <cstdint>
+
+struct FFBScaleFactor {
+    uint32_t mul      = 0;      // 0.32 fixed point (unused when identity)
+    bool     identity = true;   // percent >= 100: leave values untouched
+};
+
+FFBScaleFactor ffbMakeScaleFactor(int percent);
+
+inline uint32_t ffbScaleUnsigned(uint32_t v, FFBScaleFactor f) {
+    if (f.identity) return v;
+    return static_cast<uint32_t>((static_cast<uint64_t>(v) * f.mul) >> 32);
+}
+
+inline int32_t ffbScaleSigned(int32_t v, FFBScaleFactor f) {
+    if (f.identity) return v;
+    uint32_t mag = v < 0 ? 0u - static_cast<uint32_t>(v) : static_cast<uint32_t>(v);
+    uint32_t r   = static_cast<uint32_t>((static_cast<uint64_t>(mag) * f.mul) >> 32);
+    return v < 0 ? -static_cast<int32_t>(r) : static_cast<int32_t>(r);
+}
+
+// Scale a buffer of signed samples in place (DICUSTOMFORCE::rglForceData).
+// Uses AVX2 or SSE2 when available.
+void ffbScaleSamples(int32_t* data, size_t count, FFBScaleFactor f);
+
+// Scale an array of DICONDITION-shaped records in place. Each record is six
+// 32-bit fields { lOffset, lPositiveCoefficient, lNegativeCoefficient,
+// dwPositiveSaturation, dwNegativeSaturation, lDeadBand }; only the two
+// coefficients (signed) and two saturations (unsigned) are scaled.
+void ffbScaleConditions(int32_t* records, size_t count, FFBScaleFactor f);
+
+// Map signed samples in place through a magnitude lookup table (see
+// ffb_curve.h): data[i] = sign * table[min(|data[i]|, maxInput)]. table must
+// hold maxInput + 2 entries; the AVX2 path gathers 32 bits per lookup.
+void ffbCurveSamples(int32_t* data, size_t count, const uint16_t* table, uint32_t maxInput);
+
+// Reference implementations (always scalar), used as the fallback.
+void ffbScaleSamplesScalar(int32_t* data, size_t count, FFBScaleFactor f);
+void ffbScaleConditionsScalar(int32_t* records, size_t count, FFBScaleFactor f);
+void ffbCurveSamplesScalar(int32_t* data, size_t count, const uint16_t* table,
+                           uint32_t maxInput);
+
+// Which vector path ffbScaleSamples picked ("avx2", "sse2" or "scalar").
+// The environment variable DINPUT8_FFB_KERNEL=scalar|sse2 forces a slower one.
+const char* ffbScaleKernelName();
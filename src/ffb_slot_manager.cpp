@@ -0,0 +1,148 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026 Valmantas Paliksa
+#include "ffb_slot_manager.h"
+#include "wrapper_effect.h"
+#include "logger.h"
+#include <algorithm>
+
+FFBSlotManager::FFBSlotManager(const std::wstring& deviceName)
+    : m_deviceName(deviceName)
+{
+}
+
+FFBSlotManager::~FFBSlotManager() {
+    if (m_deviceFull == 0) return;
+    LOG_INFO("[%ls] Effect slots: peak %zu resident, %llu device-full, "
+             "%llu evictions, %llu unresolved",
+             m_deviceName.c_str(), m_peakResident,
+             static_cast<unsigned long long>(m_deviceFull),
+             static_cast<unsigned long long>(m_evictions),
+             static_cast<unsigned long long>(m_unresolved));
+}
+
+FFBSlotManager::Entry* FFBSlotManager::findLocked(WrapperEffect* effect) {
+    for (Entry& e : m_entries)
+        if (e.effect == effect) return &e;
+    return nullptr;
+}
+
+// ---------------------------------------------------------------------------
+// Bookkeeping (any thread)
+// ---------------------------------------------------------------------------
+
+// CreateEffect with parameters downloads at once on an acquired device, so a
+// new effect is assumed resident until shown otherwise.
+void FFBSlotManager::add(WrapperEffect* effect) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_entries.push_back({ effect, ++m_useClock, true, false });
+    m_peakResident = std::max(m_peakResident, ++m_resident);
+}
+
+void FFBSlotManager::remove(WrapperEffect* effect) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = std::find_if(m_entries.begin(), m_entries.end(),
+                           [effect](const Entry& e) { return e.effect == effect; });
+    if (it == m_entries.end()) return;
+    if (it->resident) --m_resident;
+    *it = m_entries.back();
+    m_entries.pop_back();
+}
+
+void FFBSlotManager::noteDownloaded(WrapperEffect* effect, bool started) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Entry* e = findLocked(effect);
+    if (!e) return;
+    if (!e->resident) {
+        e->resident = true;
+        m_peakResident = std::max(m_peakResident, ++m_resident);
+    }
+    if (started) e->playing = true;
+    touchLocked(*e);
+}
+
+void FFBSlotManager::noteStopped(WrapperEffect* effect) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (Entry* e = findLocked(effect)) {
+        e->playing = false;
+        touchLocked(*e);
+    }
+}
+
+void FFBSlotManager::noteUnloaded(WrapperEffect* effect) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Entry* e = findLocked(effect);
+    if (!e) return;
+    if (e->resident) --m_resident;
+    e->resident = false;
+    e->playing  = false;
+}
+
+void FFBSlotManager::noteCommand(DWORD command) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (command & DISFFC_RESET) {
+        for (Entry& e : m_entries)
+            e.resident = e.playing = false;
+        m_resident = 0;
+    } else if (command & DISFFC_STOPALL) {
+        for (Entry& e : m_entries)
+            e.playing = false;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Eviction
+// ---------------------------------------------------------------------------
+bool FFBSlotManager::evictFor(WrapperEffect* effect) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ++m_deviceFull;
+
+    // Least recently used resident effect that is not playing.
+    Entry* victim = nullptr;
+    for (Entry& e : m_entries) {
+        if (e.effect == effect || !e.resident || e.playing) continue;
+        if (!victim || e.lastUse < victim->lastUse) victim = &e;
+    }
+
+    // None idle by our count: ask the device about the "playing" ones, oldest
+    // first; a finite effect may have run out on its own.
+    if (!victim) {
+        std::vector<Entry*> playing;
+        for (Entry& e : m_entries)
+            if (e.effect != effect && e.resident && e.playing) playing.push_back(&e);
+        std::sort(playing.begin(), playing.end(),
+                  [](const Entry* a, const Entry* b) { return a->lastUse < b->lastUse; });
+        for (Entry* e : playing) {
+            DWORD status = 0;
+            if (SUCCEEDED(e->effect->realEffect()->GetEffectStatus(&status)) &&
+                !(status & DIEGES_PLAYING))
+            {
+                e->playing = false;
+                victim = e;
+                break;
+            }
+        }
+    }
+
+    if (!victim) {
+        ++m_unresolved;
+        LOG_DEBUG("[%ls] Device full, every resident effect is playing (%zu resident)",
+                  m_deviceName.c_str(), m_resident);
+        return false;
+    }
+
+    HRESULT hr = victim->effect->realEffect()->Unload();
+    if (FAILED(hr)) {
+        ++m_unresolved;
+        LOG_DEBUG("[%ls] Device full, evicting effect #%u failed: 0x%08lx",
+                  m_deviceName.c_str(), victim->effect->serial(), hr);
+        return false;
+    }
+
+    victim->effect->onEvicted();
+    victim->resident = false;
+    --m_resident;
+    ++m_evictions;
+    LOG_DEBUG("[%ls] Device full, evicted effect #%u for #%u",
+              m_deviceName.c_str(), victim->effect->serial(), effect->serial());
+    return true;
+}
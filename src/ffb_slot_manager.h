@@ -0,0 +1,75 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026 Valmantas Paliksa
+#pragma once
+
+#include <windows.h>
+#include <dinput.h>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+class WrapperEffect;
+
+// Which of a device's effects are downloaded, and how recently each was used.
+//
+// Many FFB bases hold only a handful of effects. When DCS creates more than
+// fit, the Download (or the implicit download of SetParameters/Start) fails
+// with DIERR_DEVICEFULL. WrapperEffect then asks evictFor() to unload the
+// least recently used effect that is not playing and repeats the call. The
+// evicted effect stays valid for the game: DirectInput downloads it again on
+// its next Start or SetParameters, which may in turn evict another.
+//
+// "Playing" is what the intercepted Start/Stop traffic says; an effect whose
+// finite duration ran out still counts as playing until GetEffectStatus (asked
+// only when nothing idle is left) says otherwise.
+class FFBSlotManager {
+public:
+    static constexpr unsigned kMaxEvictionsPerCall = 4;
+
+    explicit FFBSlotManager(const std::wstring& deviceName);
+    ~FFBSlotManager();   // logs the counters
+
+    FFBSlotManager(const FFBSlotManager&) = delete;
+    FFBSlotManager& operator=(const FFBSlotManager&) = delete;
+
+    void add(WrapperEffect* effect);
+    void remove(WrapperEffect* effect);   // waits out an eviction in progress
+
+    // The effect is on the device after a successful call; started says
+    // whether that call also started it.
+    void noteDownloaded(WrapperEffect* effect, bool started);
+    void noteStopped(WrapperEffect* effect);
+    void noteUnloaded(WrapperEffect* effect);
+
+    // DISFFC_RESET unloads everything, DISFFC_STOPALL stops everything.
+    void noteCommand(DWORD command);
+
+    // effect got DIERR_DEVICEFULL: unload the least recently used idle
+    // effect and tell it (WrapperEffect::onEvicted). False if there was none
+    // (the caller returns the error).
+    bool evictFor(WrapperEffect* effect);
+
+private:
+    struct Entry {
+        WrapperEffect* effect;
+        uint64_t       lastUse;   // m_useClock value, higher = more recent
+        bool           resident;
+        bool           playing;
+    };
+
+    Entry* findLocked(WrapperEffect* effect);
+    void   touchLocked(Entry& e) { e.lastUse = ++m_useClock; }
+
+    std::wstring       m_deviceName;
+    std::mutex         m_mutex;
+    std::vector<Entry> m_entries;
+    uint64_t           m_useClock = 0;
+
+    // Slot pressure
+    size_t   m_resident     = 0;
+    size_t   m_peakResident = 0;
+    uint64_t m_deviceFull   = 0;   // DIERR_DEVICEFULL seen
+    uint64_t m_evictions    = 0;
+    uint64_t m_unresolved   = 0;   // nothing idle to evict
+};
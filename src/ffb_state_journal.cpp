@@ -0,0 +1,236 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026 Valmantas Paliksa
+#include "ffb_state_journal.h"
+#include "logger.h"
+#include <algorithm>
+#include <cstring>
+
+static constexpr char     kJournalMagic[8] = {'F','F','B','S','T','A','T','E'};
+static constexpr uint32_t kJournalVersion  = 3;
+
+FFBStateJournal& FFBStateJournal::instance() {
+    static FFBStateJournal s;
+    return s;
+}
+
+// ============================================================================
+// Helpers
+// ============================================================================
+
+// FNV-1a over 32-bit words (bytes for the tail). Catches torn and stale
+// slots; the file is not exposed to anything adversarial.
+uint32_t FFBStateJournal::checksum(const void* data, size_t bytes) {
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    uint32_t h = 2166136261u;
+    size_t i = 0;
+    for (; i + 4 <= bytes; i += 4) {
+        uint32_t w;
+        std::memcpy(&w, p + i, sizeof(w));
+        h = (h ^ w) * 16777619u;
+    }
+    for (; i < bytes; ++i)
+        h = (h ^ p[i]) * 16777619u;
+    return h | 1;   // never 0, which marks an unused entry
+}
+
+uint32_t FFBStateJournal::headerChecksum(const Header& h) {
+    return checksum(&h, offsetof(Header, headerChecksum));
+}
+
+uint64_t FFBStateJournal::fileTimeNow() {
+    FILETIME ft;
+    GetSystemTimeAsFileTime(&ft);
+    return (static_cast<uint64_t>(ft.dwHighDateTime) << 32) | ft.dwLowDateTime;
+}
+
+// ============================================================================
+// Open / close
+// ============================================================================
+bool FFBStateJournal::open(const wchar_t* dllDirectory, DWORD maxAgeSec) {
+    if (active()) return true;
+
+    wchar_t path[MAX_PATH];
+    swprintf_s(path, L"%s\\dinput8_ffb_state.bin", dllDirectory);
+
+    const uint64_t total = kHeaderBytes + kSlotCount * sizeof(Slot);
+
+    // OPEN_ALWAYS keeps the previous session's contents; the mapping grows a
+    // new or shorter file to the full size (zero-filled).
+    m_file = CreateFileW(path, GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ,
+                         nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (m_file == INVALID_HANDLE_VALUE) {
+        LOG_ERROR("FFB state journal: cannot open %ls (error %lu)", path, GetLastError());
+        return false;
+    }
+
+    m_mapping = CreateFileMappingW(m_file, nullptr, PAGE_READWRITE,
+                                   static_cast<DWORD>(total >> 32),
+                                   static_cast<DWORD>(total & 0xFFFFFFFF),
+                                   nullptr);
+    void* view = m_mapping ? MapViewOfFile(m_mapping, FILE_MAP_WRITE, 0, 0, 0)
+                           : nullptr;
+    if (!view) {
+        LOG_ERROR("FFB state journal: cannot map %ls (error %lu)", path, GetLastError());
+        close();
+        return false;
+    }
+    m_header = static_cast<Header*>(view);
+
+    recover(maxAgeSec);
+    reset();
+
+    m_slots.store(reinterpret_cast<Slot*>(static_cast<uint8_t*>(view) + kHeaderBytes),
+                  std::memory_order_release);
+
+    LOG_INFO("FFB state journal: %ls (%zu records recovered)", path, m_recovered.size());
+    return true;
+}
+
+void FFBStateJournal::close() {
+    m_slots.store(nullptr, std::memory_order_release);
+    if (m_header) {
+        FlushViewOfFile(m_header, 0);
+        UnmapViewOfFile(m_header);
+        m_header = nullptr;
+    }
+    if (m_mapping) {
+        CloseHandle(m_mapping);
+        m_mapping = nullptr;
+    }
+    if (m_file != INVALID_HANDLE_VALUE) {
+        CloseHandle(m_file);
+        m_file = INVALID_HANDLE_VALUE;
+    }
+}
+
+// ============================================================================
+// Recovery
+// ============================================================================
+bool FFBStateJournal::headerValid() const {
+    const Header& h = *m_header;
+    return std::memcmp(h.magic, kJournalMagic, sizeof(kJournalMagic)) == 0 &&
+           h.version    == kJournalVersion &&
+           h.headerSize == kHeaderBytes &&
+           h.slotSize   == sizeof(Slot) &&   // also catches a 32/64-bit mismatch
+           h.maxDevices == FFBStateRegistry::kMaxDevices &&
+           h.kindCount  == kEffectKindCount &&
+           h.instancesPerKind == kEffectRecordInstances &&
+           h.headerChecksum == headerChecksum(h);
+}
+
+void FFBStateJournal::recover(DWORD maxAgeSec) {
+    m_recovered.clear();
+    if (!headerValid()) {
+        if (m_header->magic[0])
+            LOG_WARN("FFB state journal: unrecognised layout, starting empty");
+        return;
+    }
+
+    uint64_t last = m_header->lastWrite.load(std::memory_order_relaxed);
+    uint64_t now  = fileTimeNow();
+    if (maxAgeSec && (now < last || now - last > uint64_t(maxAgeSec) * 10000000ULL)) {
+        LOG_INFO("FFB state journal: previous session is older than %lus, not restored",
+                 maxAgeSec);
+        return;
+    }
+
+    const Slot* slots = reinterpret_cast<const Slot*>(
+        reinterpret_cast<const uint8_t*>(m_header) + kHeaderBytes);
+    size_t dropped = 0;
+
+    for (size_t d = 0; d < FFBStateRegistry::kMaxDevices; ++d) {
+        const DeviceEntry& entry = m_header->devices[d];
+        if (entry.checksum == 0) continue;
+        if (entry.checksum != checksum(&entry, offsetof(DeviceEntry, checksum))) {
+            ++dropped;
+            continue;
+        }
+
+        DeviceIdentity device;
+        device.instanceGuid = entry.instanceGuid;
+        device.productGuid  = entry.productGuid;
+        for (uint32_t i = 0; i < kNameChars && entry.name[i]; ++i)
+            device.productName.push_back(static_cast<wchar_t>(entry.name[i]));
+
+        // Index 0..kEffectRecordInstances-1 is EffectKind::Unknown, never dense.
+        for (size_t i = kEffectRecordInstances; i < kDenseRecordCount; ++i) {
+            const Slot& s = slots[d * kDenseRecordCount + i];
+            if (s.checksum == 0) continue;   // never written
+            if ((s.seq.load(std::memory_order_relaxed) & 1) ||
+                s.checksum != checksum(&s.rec, sizeof(s.rec)))
+            {
+                ++dropped;   // torn by a crash mid-write
+                continue;
+            }
+            if (!s.rec.hasParams && !s.rec.wasRunning) continue;
+
+            EffectInstanceId id;
+            id.kind    = static_cast<EffectKind>(i / kEffectRecordInstances);
+            id.guid    = s.rec.guid;
+            id.ordinal = static_cast<uint32_t>(i % kEffectRecordInstances);
+            m_recovered.push_back({ device, id, s.rec });
+        }
+    }
+
+    if (dropped)
+        LOG_WARN("FFB state journal: dropped %zu damaged entries", dropped);
+}
+
+// Start the file over for this session. Handles are re-assigned by the
+// registry as devices are interned, so the old table must not linger.
+void FFBStateJournal::reset() {
+    std::memset(static_cast<void*>(m_header), 0, kHeaderBytes + kSlotCount * sizeof(Slot));
+
+    Header& h = *m_header;
+    std::memcpy(h.magic, kJournalMagic, sizeof(kJournalMagic));
+    h.version    = kJournalVersion;
+    h.headerSize = kHeaderBytes;
+    h.slotSize   = sizeof(Slot);
+    h.maxDevices = FFBStateRegistry::kMaxDevices;
+    h.kindCount  = kEffectKindCount;
+    h.instancesPerKind = kEffectRecordInstances;
+    h.headerChecksum = headerChecksum(h);
+    h.lastWrite.store(fileTimeNow(), std::memory_order_relaxed);
+}
+
+std::vector<FFBStateJournal::Recovered> FFBStateJournal::takeRecovered() {
+    std::vector<Recovered> out;
+    out.swap(m_recovered);
+    return out;
+}
+
+// ============================================================================
+// Recording
+// ============================================================================
+void FFBStateJournal::registerDevice(FFBDeviceHandle handle, const DeviceIdentity& device) {
+    if (!active() || handle >= FFBStateRegistry::kMaxDevices) return;
+
+    // wchar_t is UTF-16 on Windows, so names copy unit for unit.
+    DeviceEntry& entry = m_header->devices[handle];
+    entry.instanceGuid = device.instanceGuid;
+    entry.productGuid  = device.productGuid;
+    std::memset(entry.name, 0, sizeof(entry.name));
+    size_t len = std::min<size_t>(device.productName.size(), kNameChars - 1);
+    for (size_t i = 0; i < len; ++i)
+        entry.name[i] = static_cast<uint16_t>(device.productName[i]);
+    entry.checksum = checksum(&entry, offsetof(DeviceEntry, checksum));
+}
+
+void FFBStateJournal::write(FFBDeviceHandle device, size_t denseIndex,
+                            const EffectStateRecord& rec)
+{
+    Slot* slots = m_slots.load(std::memory_order_acquire);
+    if (!slots || device >= FFBStateRegistry::kMaxDevices || denseIndex >= kDenseRecordCount)
+        return;
+
+    Slot& s = slots[static_cast<size_t>(device) * kDenseRecordCount + denseIndex];
+    uint32_t seq = s.seq.load(std::memory_order_relaxed);
+    s.seq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    std::memcpy(&s.rec, &rec, sizeof(rec));
+    s.checksum = checksum(&rec, sizeof(rec));
+
+    s.seq.store(seq + 2, std::memory_order_release);
+    m_header->lastWrite.store(fileTimeNow(), std::memory_order_relaxed);
+}
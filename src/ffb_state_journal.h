@@ -0,0 +1,111 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026 Valmantas Paliksa
+#pragma once
+
+#include <windows.h>
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "effect_kind.h"
+#include "ffb_state_registry.h"
+
+// Global singleton mirroring FFBStateRegistry into dinput8_ffb_state.bin next
+// to the DLL, so effect state survives DCS reloading the module or crashing.
+//
+// The file is a fixed layout: a header with a device table (instance and
+// product GUID, name), then one
+// slot per (device handle, dense record index — effect kind and ordinal). FFBStateRegistry writes a record's
+// slot while it holds that record's seqlock, so each slot has one writer at a
+// time and a write is a memcpy plus a checksum into mapped memory. The OS
+// keeps dirty pages of the mapping when the process dies, so no explicit
+// flush is needed on the recording path.
+//
+// On open() a valid journal from a recent previous session is read into
+// memory and the file is reset; FFBStateRegistry::restoreFromJournal() then
+// takes the records and re-writes them through the normal path, which also
+// compacts the device table to the new session's handles. Slots caught
+// mid-write (odd sequence) or with a bad checksum are dropped.
+//
+// Records without a dense slot (vendor-specific effects, ordinals past
+// kEffectRecordInstances) are not journaled.
+class FFBStateJournal {
+public:
+    static FFBStateJournal& instance();
+
+    // A record recovered from the previous session.
+    struct Recovered {
+        DeviceIdentity    device;   // GUIDs and name; no VID/PID decoded
+        EffectInstanceId  id;
+        EffectStateRecord record;
+    };
+
+    // Map <dllDirectory>\dinput8_ffb_state.bin, recovering its contents if
+    // they are valid and were last written at most maxAgeSec ago (0 = any age).
+    bool open(const wchar_t* dllDirectory, DWORD maxAgeSec);
+    void close();
+
+    bool active() const { return m_slots.load(std::memory_order_acquire) != nullptr; }
+
+    // Records recovered by open(); empties the list.
+    std::vector<Recovered> takeRecovered();
+
+    // Record the device a registry handle refers to (called on interning).
+    void registerDevice(FFBDeviceHandle handle, const DeviceIdentity& device);
+
+    // Persist rec as the current state of (device, denseRecordIndex). Caller
+    // must be the record's only writer (FFBStateRegistry holds its seqlock).
+    void write(FFBDeviceHandle device, size_t denseIndex, const EffectStateRecord& rec);
+
+private:
+    FFBStateJournal() = default;
+    ~FFBStateJournal() = default;
+
+    static constexpr uint32_t kNameChars  = 64;     // UTF-16 units incl. NUL
+    static constexpr uint32_t kHeaderBytes = 12288; // Header, padded
+    static constexpr size_t   kSlotCount   = FFBStateRegistry::kMaxDevices * kDenseRecordCount;
+
+    struct DeviceEntry {
+        GUID     instanceGuid;
+        GUID     productGuid;
+        uint16_t name[kNameChars];
+        uint32_t checksum;   // over the fields above; 0 = unused entry
+    };
+
+    struct Header {
+        char     magic[8];
+        uint32_t version;
+        uint32_t headerSize;
+        uint32_t slotSize;
+        uint32_t maxDevices;
+        uint32_t kindCount;
+        uint32_t instancesPerKind;
+        uint32_t headerChecksum;        // over the fields above
+        std::atomic<uint64_t> lastWrite;   // FILETIME of the latest write
+        DeviceEntry devices[FFBStateRegistry::kMaxDevices];
+    };
+    static_assert(sizeof(Header) <= kHeaderBytes, "journal header outgrew its padding");
+
+    // seq is odd while the record is being written.
+    struct Slot {
+        std::atomic<uint32_t> seq;
+        uint32_t              checksum;   // over rec
+        EffectStateRecord     rec;
+    };
+
+    static uint32_t checksum(const void* data, size_t bytes);
+    static uint32_t headerChecksum(const Header& h);
+    static uint64_t fileTimeNow();
+
+    bool headerValid() const;
+    void recover(DWORD maxAgeSec);
+    void reset();
+
+
+    HANDLE              m_file    = INVALID_HANDLE_VALUE;
+    HANDLE              m_mapping = nullptr;
+    Header*             m_header  = nullptr;
+    std::atomic<Slot*>  m_slots{nullptr};
+    std::vector<Recovered> m_recovered;
+};
@@ -1,6 +1,7 @@
 // SPDX-License-Identifier: MIT
 // Copyright (c) 2026 Valmantas Paliksa
 #include "ffb_state_registry.h"
+#include "ffb_state_journal.h"
 #include "logger.h"
 #include <algorithm>
 #include <cstring>
@@ -20,153 +21,444 @@ std::wstring FFBStateRegistry::toLower(const std::wstring& s) {
 }
 
 // ============================================================================
-// Deep-copy helpers
+// Record copy / replay
 // ============================================================================
 
-// Deep-copy a DIEFFECT structure into an EffectStateRecord.
-// All pointer fields are captured into owned vectors; the params struct's
-// pointers are then redirected to those vectors' data.
-static void deepCopyParams(EffectStateRecord& rec, const DIEFFECT* peff) {
-    if (!peff) {
-        rec.hasParams = false;
+// Copy a DIEFFECT into the record's inline storage. Everything that does not
+// fit (more than kEffectRecordMaxAxes axes, an oversized type-specific block)
+// is dropped from replay rather than truncated into something wrong.
+static void copyParams(EffectStateRecord& rec, EffectKind kind, const DIEFFECT* peff) {
+    rec.kind   = kind;
+    rec.params = *peff;  // scalars; pointer fields are rebuilt by replayParams
+
+    DWORD cAxes = peff->cAxes;
+    if (cAxes > kEffectRecordMaxAxes || (cAxes && !peff->rgdwAxes)) {
+        cAxes = 0;
+    } else if (cAxes) {
+        std::memcpy(rec.axes, peff->rgdwAxes, cAxes * sizeof(DWORD));
+        if (peff->rglDirection)
+            std::memcpy(rec.directions, peff->rglDirection, cAxes * sizeof(LONG));
+        else
+            std::memset(rec.directions, 0, sizeof(rec.directions));
+    }
+    rec.params.cAxes = cAxes;
+
+    // Type-specific block, checked against what the kind's struct needs.
+    DWORD cb = peff->lpvTypeSpecificParams ? peff->cbTypeSpecificParams : 0;
+    rec.typeSpecificDropped = false;
+    if (effectKindCategory(kind) == EffectCategory::Custom &&
+        cb >= sizeof(DICUSTOMFORCE))
+    {
+        // Flatten: header, then the samples it points to.
+        auto* cf = static_cast<const DICUSTOMFORCE*>(peff->lpvTypeSpecificParams);
+        size_t samples = cf->rglForceData
+            ? static_cast<size_t>(cf->cSamples) * cf->cChannels : 0;
+        size_t bytes = sizeof(DICUSTOMFORCE) + samples * sizeof(LONG);
+        if (bytes <= kEffectRecordTypeSpecificBytes) {
+            std::memcpy(rec.typeSpecific, cf, sizeof(DICUSTOMFORCE));
+            if (samples)
+                std::memcpy(rec.typeSpecific + sizeof(DICUSTOMFORCE),
+                            cf->rglForceData, samples * sizeof(LONG));
+            cb = sizeof(DICUSTOMFORCE);
+        } else {
+            cb = 0;
+            rec.typeSpecificDropped = true;
+        }
+    } else if (cb > kEffectRecordTypeSpecificBytes) {
+        cb = 0;
+        rec.typeSpecificDropped = true;
+    } else if (cb) {
+        std::memcpy(rec.typeSpecific, peff->lpvTypeSpecificParams, cb);
+    }
+    rec.params.cbTypeSpecificParams = cb;
+
+    rec.hasEnvelope = peff->lpEnvelope != nullptr;
+    if (rec.hasEnvelope)
+        rec.envelope = *peff->lpEnvelope;
+
+    rec.hasParams = true;
+}
+
+DIEFFECT EffectStateRecord::replayParams() {
+    DIEFFECT p = params;
+    p.rgdwAxes     = p.cAxes ? axes : nullptr;
+    p.rglDirection = p.cAxes ? directions : nullptr;
+    p.lpEnvelope   = hasEnvelope ? &envelope : nullptr;
+    p.lpvTypeSpecificParams = p.cbTypeSpecificParams ? typeSpecific : nullptr;
+
+    // A flattened CustomForce header still holds the game's sample pointer.
+    if (p.cbTypeSpecificParams == sizeof(DICUSTOMFORCE) &&
+        effectKindCategory(kind) == EffectCategory::Custom)
+    {
+        auto* cf = reinterpret_cast<DICUSTOMFORCE*>(typeSpecific);
+        cf->rglForceData = cf->cSamples
+            ? reinterpret_cast<LONG*>(typeSpecific + sizeof(DICUSTOMFORCE)) : nullptr;
+    }
+    return p;
+}
+
+// ============================================================================
+// Seqlock
+// ============================================================================
+
+void FFBStateRegistry::SeqRecord::load(EffectStateRecord& out) const {
+    auto* dst = reinterpret_cast<unsigned char*>(&out);
+    for (size_t i = 0; i < kRecordWords; ++i) {
+        RecordWord w = words[i].load(std::memory_order_relaxed);
+        std::memcpy(dst + i * sizeof(w), &w, sizeof(w));
+    }
+}
+
+void FFBStateRegistry::SeqRecord::publish() {
+    auto* src = reinterpret_cast<const unsigned char*>(&rec);
+    for (size_t i = 0; i < kRecordWords; ++i) {
+        RecordWord w;
+        std::memcpy(&w, src + i * sizeof(w), sizeof(w));
+        words[i].store(w, std::memory_order_relaxed);
+    }
+}
+
+template<class Fn>
+void FFBStateRegistry::write(DeviceSlot& dev, const EffectInstanceId& id, Fn&& fn) {
+    size_t index = denseRecordIndex(id);
+    if (index == kNoDenseRecord) {
+        std::lock_guard<std::mutex> lock(dev.mutex);
+        fn(dev.sparse[EffectInstanceKey{ id.guid, id.ordinal }]);
+        dev.version.fetch_add(1, std::memory_order_release);
         return;
     }
 
-    rec.params = *peff;  // shallow copy first
+    SeqRecord& r = dev.dense[index];
 
-    // Axes array
-    if (peff->rgdwAxes && peff->cAxes > 0) {
-        rec.axes.assign(peff->rgdwAxes, peff->rgdwAxes + peff->cAxes);
-        rec.params.rgdwAxes = rec.axes.data();
-    } else {
-        rec.axes.clear();
-        rec.params.rgdwAxes = nullptr;
+    // Claim the record: even -> odd. Another writer on the same effect
+    // instance is rare and only ever holds it for a copy.
+    uint32_t seq = r.seq.load(std::memory_order_relaxed);
+    for (;;) {
+        if (!(seq & 1) &&
+            r.seq.compare_exchange_weak(seq, seq + 1, std::memory_order_acquire))
+            break;
+        YieldProcessor();
+        seq = r.seq.load(std::memory_order_relaxed);
     }
+    std::atomic_thread_fence(std::memory_order_release);
+
+    fn(r.rec);
+    r.publish();
+    FFBStateJournal::instance().write(dev.handle, index, r.rec);
+
+    r.seq.store(seq + 2, std::memory_order_release);
+    dev.version.fetch_add(1, std::memory_order_release);
+}
 
-    // Direction array
-    if (peff->rglDirection && peff->cAxes > 0) {
-        rec.directions.assign(peff->rglDirection, peff->rglDirection + peff->cAxes);
-        rec.params.rglDirection = rec.directions.data();
-    } else {
-        rec.directions.clear();
-        rec.params.rglDirection = nullptr;
+void FFBStateRegistry::readDense(const SeqRecord& r, EffectStateRecord& out) {
+    for (;;) {
+        uint32_t before = r.seq.load(std::memory_order_acquire);
+        if (before & 1) {
+            YieldProcessor();   // writer inside, it will be done shortly
+            continue;
+        }
+        r.load(out);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (r.seq.load(std::memory_order_relaxed) == before)
+            return;
     }
+}
 
-    // Type-specific data (flat struct: DICONSTANTFORCE, DICONDITION[], etc.)
-    if (peff->lpvTypeSpecificParams && peff->cbTypeSpecificParams > 0) {
-        rec.typeSpecific.resize(peff->cbTypeSpecificParams);
-        std::memcpy(rec.typeSpecific.data(),
-                    peff->lpvTypeSpecificParams,
-                    peff->cbTypeSpecificParams);
-        rec.params.lpvTypeSpecificParams = rec.typeSpecific.data();
-    } else {
-        rec.typeSpecific.clear();
-        rec.params.lpvTypeSpecificParams = nullptr;
-        rec.params.cbTypeSpecificParams = 0;
+bool FFBStateRegistry::read(const DeviceSlot& dev, const EffectInstanceId& id,
+                            EffectStateRecord& out)
+{
+    size_t index = denseRecordIndex(id);
+    if (index == kNoDenseRecord) {
+        std::lock_guard<std::mutex> lock(dev.mutex);
+        auto it = dev.sparse.find(EffectInstanceKey{ id.guid, id.ordinal });
+        if (it == dev.sparse.end()) return false;
+        out = it->second;
+        return true;
     }
+    readDense(dev.dense[index], out);
+    return true;
+}
 
-    // Envelope (optional)
-    if (peff->lpEnvelope) {
-        rec.envelope = *peff->lpEnvelope;
-        rec.hasEnvelope = true;
-        rec.params.lpEnvelope = &rec.envelope;
-    } else {
-        rec.hasEnvelope = false;
-        rec.params.lpEnvelope = nullptr;
+// ============================================================================
+// Device interning
+// ============================================================================
+
+FFBDeviceHandle FFBStateRegistry::internDevice(const DeviceIdentity& device) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    FFBDeviceHandle handle = internLocked(device);
+    if (handle != kInvalidDeviceHandle)
+        ++m_slots[handle]->live;
+    return handle;
+}
+
+void FFBStateRegistry::releaseDevice(FFBDeviceHandle h) {
+    DeviceSlot* dev = device(h);
+    if (!dev) return;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (dev->live) --dev->live;
+}
+
+FFBDeviceHandle FFBStateRegistry::internLocked(const DeviceIdentity& device) {
+    for (size_t i = 0; i < m_slotCount; ++i) {
+        if (m_slots[i]->instanceGuid == device.instanceGuid)
+            return static_cast<FFBDeviceHandle>(i);
     }
 
-    rec.hasParams = true;
+    // A new instance GUID for a known product: take its slot over only when
+    // exactly one is idle, so identical devices are never mixed up.
+    std::wstring lower = toLower(device.productName);
+    DeviceSlot* adopt = nullptr;
+    size_t candidates = 0;
+    for (size_t i = 0; i < m_slotCount; ++i) {
+        DeviceSlot& slot = *m_slots[i];
+        if (slot.live == 0 && slot.productGuid == device.productGuid &&
+            slot.nameLower == lower)
+        {
+            adopt = &slot;
+            ++candidates;
+        }
+    }
+    if (candidates == 1) {
+        LOG_INFO("FFBStateRegistry: [%ls] is back under a new instance GUID",
+                 device.productName.c_str());
+        adopt->instanceGuid = device.instanceGuid;
+        FFBStateJournal::instance().registerDevice(adopt->handle, device);
+        return adopt->handle;
+    }
+
+    if (m_slotCount == kMaxDevices) {
+        LOG_WARN("FFBStateRegistry: device table full, [%ls] will not be tracked",
+                 device.productName.c_str());
+        return kInvalidDeviceHandle;
+    }
+
+    auto handle = static_cast<FFBDeviceHandle>(m_slotCount);
+    auto dev = std::make_unique<DeviceSlot>();
+    dev->handle       = handle;
+    dev->instanceGuid = device.instanceGuid;
+    dev->productGuid  = device.productGuid;
+    dev->name         = device.productName;
+    dev->nameLower    = std::move(lower);
+    m_slots[m_slotCount++] = std::move(dev);
+    FFBStateJournal::instance().registerDevice(handle, device);
+    return handle;
+}
+
+const std::wstring& FFBStateRegistry::deviceName(FFBDeviceHandle h) const {
+    static const std::wstring kNone;
+    const DeviceSlot* dev = device(h);
+    return dev ? dev->name : kNone;
 }
 
 // ============================================================================
 // Recording
 // ============================================================================
 
-void FFBStateRegistry::recordStart(const std::wstring& deviceName,
-                                   REFGUID effectGuid,
+void FFBStateRegistry::recordStart(FFBDeviceHandle h, const EffectInstanceId& id,
                                    DWORD iterations, DWORD flags)
 {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    auto& rec = m_records[toLower(deviceName)][effectGuid];
-    rec.guid           = effectGuid;
-    rec.wasRunning     = true;
-    rec.lastIterations = iterations;
-    rec.lastStartFlags = flags;
+    DeviceSlot* dev = device(h);
+    if (!dev) return;
+    write(*dev, id, [&](EffectStateRecord& rec) {
+        rec.guid           = id.guid;
+        rec.kind           = id.kind;
+        rec.ordinal        = id.ordinal;
+        rec.wasRunning     = true;
+        rec.lastIterations = iterations;
+        rec.lastStartFlags = flags;
+    });
 }
 
-void FFBStateRegistry::recordStop(const std::wstring& deviceName,
-                                  REFGUID effectGuid)
-{
-    std::lock_guard<std::mutex> lock(m_mutex);
-    auto nameIt = m_records.find(toLower(deviceName));
-    if (nameIt == m_records.end()) return;
-    auto guidIt = nameIt->second.find(effectGuid);
-    if (guidIt == nameIt->second.end()) return;
-    guidIt->second.wasRunning = false;
+void FFBStateRegistry::recordStop(FFBDeviceHandle h, const EffectInstanceId& id) {
+    DeviceSlot* dev = device(h);
+    if (!dev) return;
+    if (denseRecordIndex(id) == kNoDenseRecord) {
+        // Don't create a map entry just to say "not running".
+        std::lock_guard<std::mutex> lock(dev->mutex);
+        auto it = dev->sparse.find(EffectInstanceKey{ id.guid, id.ordinal });
+        if (it != dev->sparse.end()) {
+            it->second.wasRunning = false;
+            dev->version.fetch_add(1, std::memory_order_release);
+        }
+        return;
+    }
+    write(*dev, id, [](EffectStateRecord& rec) {
+        rec.wasRunning = false;
+    });
 }
 
-void FFBStateRegistry::recordParams(const std::wstring& deviceName,
-                                    REFGUID effectGuid,
+void FFBStateRegistry::recordParams(FFBDeviceHandle h, const EffectInstanceId& id,
                                     const DIEFFECT* peff)
 {
-    if (!peff) return;
+    DeviceSlot* dev = device(h);
+    if (!peff || !dev) return;
 
-    LOG_DEBUG("FFBStateRegistry::recordParams [%ls] axes=%lu typeSpec=%lu "
+    LOG_DEBUG("FFBStateRegistry::recordParams [%ls] %s#%u axes=%lu typeSpec=%lu "
               "gain=%lu duration=%lu envelope=%s",
-              deviceName.c_str(),
+              dev->name.c_str(), effectKindName(id.kind), id.ordinal,
               peff->cAxes,
               peff->cbTypeSpecificParams,
               peff->dwGain,
               peff->dwDuration,
               peff->lpEnvelope ? "yes" : "no");
 
-    std::lock_guard<std::mutex> lock(m_mutex);
-    auto& rec = m_records[toLower(deviceName)][effectGuid];
-    rec.guid = effectGuid;
-    deepCopyParams(rec, peff);
+    write(*dev, id, [&](EffectStateRecord& rec) {
+        rec.guid    = id.guid;
+        rec.ordinal = id.ordinal;
+        copyParams(rec, id.kind, peff);
+    });
+}
+
+void FFBStateRegistry::recordCommand(FFBDeviceHandle h, DWORD command) {
+    DeviceSlot* dev = device(h);
+    if (!dev) return;
+
+    switch (command) {
+    case DISFFC_RESET:
+        clearDevice(h);
+        break;
+
+    case DISFFC_STOPALL: {
+        // One pass over the dense records; only running ones are rewritten,
+        // so idle slots cost a seqlock read and no journal write.
+        EffectStateRecord rec;
+        for (size_t i = kEffectRecordInstances; i < kDenseRecordCount; ++i) {
+            readDense(dev->dense[i], rec);
+            if (!rec.wasRunning) continue;
+            EffectInstanceId id;
+            id.kind    = static_cast<EffectKind>(i / kEffectRecordInstances);
+            id.ordinal = static_cast<uint32_t>(i % kEffectRecordInstances);
+            write(*dev, id, [](EffectStateRecord& r) { r.wasRunning = false; });
+        }
+        std::lock_guard<std::mutex> lock(dev->mutex);
+        for (auto& entry : dev->sparse)
+            entry.second.wasRunning = false;
+        dev->version.fetch_add(1, std::memory_order_release);
+        break;
+    }
+
+    case DISFFC_PAUSE:
+    case DISFFC_CONTINUE:
+        dev->paused.store(command == DISFFC_PAUSE, std::memory_order_relaxed);
+        dev->version.fetch_add(1, std::memory_order_release);
+        break;
+
+    default:
+        break;
+    }
 }
 
 // ============================================================================
 // Querying
 // ============================================================================
 
-bool FFBStateRegistry::wasRunning(const std::wstring& deviceName,
-                                  REFGUID effectGuid,
+bool FFBStateRegistry::wasRunning(FFBDeviceHandle h, const EffectInstanceId& id,
                                   DWORD& outIterations,
                                   DWORD& outFlags) const
 {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    auto nameIt = m_records.find(toLower(deviceName));
-    if (nameIt == m_records.end()) return false;
-    auto guidIt = nameIt->second.find(effectGuid);
-    if (guidIt == nameIt->second.end()) return false;
-    if (!guidIt->second.wasRunning) return false;
-    outIterations = guidIt->second.lastIterations;
-    outFlags      = guidIt->second.lastStartFlags;
+    const DeviceSlot* dev = device(h);
+    EffectStateRecord rec;
+    if (!dev || !read(*dev, id, rec) || !rec.wasRunning) return false;
+    outIterations = rec.lastIterations;
+    outFlags      = rec.lastStartFlags;
     return true;
 }
 
-const EffectStateRecord* FFBStateRegistry::getRecord(
-    const std::wstring& deviceName, REFGUID effectGuid) const
-{
-    std::lock_guard<std::mutex> lock(m_mutex);
-    auto nameIt = m_records.find(toLower(deviceName));
-    if (nameIt == m_records.end()) return nullptr;
-    auto guidIt = nameIt->second.find(effectGuid);
-    if (guidIt == nameIt->second.end()) return nullptr;
-    return &guidIt->second;
+const EffectStateRecord* FFBDeviceSnapshot::find(const EffectInstanceId& id) const {
+    size_t index = denseRecordIndex(id);
+    if (index != kNoDenseRecord)
+        return &dense[index];
+    for (const auto& rec : sparse) {
+        if (rec.guid == id.guid && rec.ordinal == id.ordinal) return &rec;
+    }
+    return nullptr;
+}
+
+FFBDeviceSnapshotPtr FFBStateRegistry::snapshot(FFBDeviceHandle h) const {
+    const DeviceSlot* dev = device(h);
+    if (!dev) return std::make_shared<const FFBDeviceSnapshot>();
+
+    // Fast path: nothing written since the published snapshot was built.
+    FFBDeviceSnapshotPtr current = std::atomic_load(&dev->published);
+    uint64_t version = dev->version.load(std::memory_order_acquire);
+    if (current && current->version == version)
+        return current;
+
+    // Build a fresh one from seqlock reads. Each record is consistent on its
+    // own; retrying while the version moves keeps the set coherent too, but
+    // a device being written every frame must not starve us, so give up
+    // after a few attempts and take what we have.
+    auto snap = std::make_shared<FFBDeviceSnapshot>();
+    for (int attempt = 0; attempt < 4; ++attempt) {
+        snap->version = version;
+        snap->paused  = dev->paused.load(std::memory_order_relaxed);
+        for (size_t i = 0; i < kDenseRecordCount; ++i)
+            readDense(dev->dense[i], snap->dense[i]);
+        {
+            std::lock_guard<std::mutex> lock(dev->mutex);
+            snap->sparse.clear();
+            for (const auto& entry : dev->sparse)
+                snap->sparse.push_back(entry.second);
+        }
+        uint64_t after = dev->version.load(std::memory_order_acquire);
+        if (after == version) break;
+        version = after;
+    }
+
+    // Publish unless someone else already published something newer.
+    FFBDeviceSnapshotPtr built = std::move(snap);
+    while (!current || current->version < built->version) {
+        if (std::atomic_compare_exchange_weak(&dev->published, &current, built))
+            break;
+    }
+    return built;
 }
 
 // ============================================================================
 // Maintenance
 // ============================================================================
 
-void FFBStateRegistry::clearDevice(const std::wstring& deviceName) {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    m_records.erase(toLower(deviceName));
+void FFBStateRegistry::clearDevice(FFBDeviceHandle h) {
+    DeviceSlot* dev = device(h);
+    if (!dev) return;
+    for (size_t k = 1; k < kEffectKindCount; ++k) {
+        for (uint32_t n = 0; n < kEffectRecordInstances; ++n) {
+            EffectInstanceId id;
+            id.kind    = static_cast<EffectKind>(k);
+            id.ordinal = n;
+            write(*dev, id, [](EffectStateRecord& rec) { rec = EffectStateRecord{}; });
+        }
+    }
+    dev->paused.store(false, std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lock(dev->mutex);
+    dev->sparse.clear();
+    dev->version.fetch_add(1, std::memory_order_release);
 }
 
 void FFBStateRegistry::clearAll() {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    m_records.clear();
+    size_t count;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        count = m_slotCount;
+    }
+    for (size_t i = 0; i < count; ++i)
+        clearDevice(static_cast<FFBDeviceHandle>(i));
+}
+
+void FFBStateRegistry::restoreFromJournal() {
+    size_t restored = 0, running = 0;
+    for (const auto& r : FFBStateJournal::instance().takeRecovered()) {
+        DeviceSlot* dev;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            dev = device(internLocked(r.device));   // not live until created
+        }
+        if (!dev) continue;
+        write(*dev, r.id, [&](EffectStateRecord& rec) { rec = r.record; });
+        ++restored;
+        if (r.record.wasRunning) ++running;
+    }
+    if (restored)
+        LOG_INFO("FFBStateRegistry: restored %zu effect records (%zu running) "
+                 "from the state journal", restored, running);
 }
@@ -4,29 +4,73 @@
 
 #include <windows.h>
 #include <dinput.h>
+#include <array>
+#include <atomic>
+#include <cstdint>
 #include <map>
+#include <memory>
 #include <mutex>
 #include <string>
+#include <type_traits>
 #include <vector>
 
+#include "device_identity.h"
+#include "effect_kind.h"
+
+// Inline capacity of an EffectStateRecord. Four axes covers every FFB device
+// DCS drives; the type-specific block holds four DICONDITIONs, or a
+// DICUSTOMFORCE header followed by its samples.
+constexpr DWORD kEffectRecordMaxAxes           = 4;
+constexpr DWORD kEffectRecordTypeSpecificBytes = 128;
+
+// Instances of one effect kind per device that get a dense, preallocated
+// record (and a journal slot). Higher ordinals fall back to a map.
+constexpr uint32_t kEffectRecordInstances = 8;
+
+// Identity of an effect within one device: its type, plus its creation
+// ordinal — the position among the live effects of that type when it was
+// created (see FFBFilter::acquireOrdinal). Two ConstantForce effects are
+// ordinals 0 and 1; after a reconnect the game re-creates them in the same
+// order and each one finds its own predecessor's record.
+struct EffectInstanceId {
+    EffectKind kind    = EffectKind::Unknown;
+    GUID       guid    = {};   // distinguishes vendor effects of Unknown kind
+    uint32_t   ordinal = 0;
+};
+
 // Captures the last-known state of a single DirectInput effect.
 // Used to replay parameters + auto-start after device reconnection.
+//
+// Fixed-size and trivially copyable: recordParams copies straight into it
+// (no allocation) and readers take it by value under the record's seqlock.
+// The pointer fields of params are not meaningful in storage; use
+// replayParams() on a copy to get a DIEFFECT that points into that copy.
 struct EffectStateRecord {
     GUID  guid          = {};
+    EffectKind kind     = EffectKind::Unknown;
+    uint32_t ordinal    = 0;
     bool  wasRunning    = false;
     DWORD lastIterations = 0;
     DWORD lastStartFlags = 0;
 
-    // Deep-copied DIEFFECT parameters
-    bool                hasParams      = false;
-    DIEFFECT            params         = {};      // top-level struct (pointers replaced below)
-    std::vector<DWORD>  axes;                     // rgdwAxes copy
-    std::vector<LONG>   directions;               // rglDirection copy
-    std::vector<BYTE>   typeSpecific;             // lpvTypeSpecificParams copy
-    DIENVELOPE          envelope       = {};
-    bool                hasEnvelope    = false;
+    // Copied DIEFFECT parameters
+    bool       hasParams   = false;
+    bool       hasEnvelope = false;
+    bool       typeSpecificDropped = false;   // block did not fit; not replayed
+    DIEFFECT   params      = {};              // scalars; pointers rebuilt on replay
+    DWORD      axes[kEffectRecordMaxAxes]       = {};
+    LONG       directions[kEffectRecordMaxAxes] = {};
+    DIENVELOPE envelope    = {};
+    alignas(8) BYTE typeSpecific[kEffectRecordTypeSpecificBytes] = {};
+
+    // params with rgdwAxes/rglDirection/lpEnvelope/lpvTypeSpecificParams (and
+    // a CustomForce's sample pointer) aimed at this object's storage.
+    DIEFFECT replayParams();
 };
 
+static_assert(std::is_trivially_copyable<EffectStateRecord>::value,
+              "EffectStateRecord is copied under a seqlock");
+
 // Comparer for GUID as a map key
 struct GUIDLess {
     bool operator()(const GUID& a, const GUID& b) const {
@@ -34,59 +78,205 @@ struct GUIDLess {
     }
 };
 
+// Map key for effects without a dense record slot.
+struct EffectInstanceKey {
+    GUID     guid;
+    uint32_t ordinal;
+
+    bool operator<(const EffectInstanceKey& o) const {
+        int c = memcmp(&guid, &o.guid, sizeof(GUID));
+        return c < 0 || (c == 0 && ordinal < o.ordinal);
+    }
+};
+
+// Dense record index of an effect instance, or kNoDenseRecord.
+constexpr size_t kDenseRecordCount = kEffectKindCount * kEffectRecordInstances;
+constexpr size_t kNoDenseRecord    = static_cast<size_t>(-1);
+
+inline size_t denseRecordIndex(const EffectInstanceId& id) {
+    if (id.kind == EffectKind::Unknown || id.ordinal >= kEffectRecordInstances)
+        return kNoDenseRecord;
+    return effectKindIndex(id.kind) * kEffectRecordInstances + id.ordinal;
+}
+
+// Immutable, reference-counted view of one device's effect set at a given
+// registry version. Hold it as long as needed: writers never modify it.
+struct FFBDeviceSnapshot {
+    uint64_t version = 0;   // device write counter the snapshot reflects
+    bool     paused  = false;   // DISFFC_PAUSE in effect (see recordCommand)
+    std::array<EffectStateRecord, kDenseRecordCount> dense;   // by denseRecordIndex
+    std::vector<EffectStateRecord>                   sparse;  // vendor effects, high ordinals
+
+    // Record for an effect instance, or nullptr (no dense slot and never seen).
+    const EffectStateRecord* find(const EffectInstanceId& id) const;
+};
+
+using FFBDeviceSnapshotPtr = std::shared_ptr<const FFBDeviceSnapshot>;
+
+// Stable index of an interned device (see FFBStateRegistry::internDevice).
+using FFBDeviceHandle = uint16_t;
+constexpr FFBDeviceHandle kInvalidDeviceHandle = 0xFFFF;
+
 // Global singleton tracking FFB effect state across device lifetimes.
 //
 // When a device is disconnected and DCS re-creates the device + effects,
 // this registry allows the wrapper to detect which effects were previously
 // running and auto-start them with their last-known parameters.
 //
-// Keyed by device product name (case-insensitive) + effect GUID.
-// Thread-safe via internal mutex.
+// Device identities are interned once per CreateDevice into a stable
+// FFBDeviceHandle that FFBFilter carries. A reconnected device gets the same
+// handle back by instance GUID, so two identical sticks keep separate state;
+// one that comes back under a new instance GUID (another USB port) takes
+// over the idle slot of the same product. Effects are identified by
+// EffectInstanceId, so several live effects of one type keep separate
+// records. Recording then indexes a fixed slot table and a flat
+// (kind, ordinal) array — no string work, no map walk and no allocation.
+// Effects of unknown (vendor-specific) type, and ordinals past
+// kEffectRecordInstances, fall back to a map.
+//
+// Records of known effect kinds are published through a per-record seqlock:
+// writers (serialised among themselves by the sequence word) never wait for
+// readers, and readers retry until they copy a consistent record. Each write
+// also bumps the device's version.
+//
+// Readers that need more than one record use snapshot(): an immutable
+// FFBDeviceSnapshot published RCU-style. The current snapshot is swapped in
+// atomically and stays alive for as long as any reader holds it. It is built
+// lazily by the first reader after a write, so the per-frame write path still
+// never allocates.
+//
+// With [FFB] StateJournal, every write of a dense record is also copied
+// into FFBStateJournal's memory-mapped file while the seqlock is held.
+//
+// The per-device mutex only guards the sparse map; the registry-wide
+// mutex only guards interning.
 class FFBStateRegistry {
 public:
     static FFBStateRegistry& instance();
 
+    static constexpr size_t kMaxDevices = 64;
+
+    // Intern a device and count it as live until releaseDevice. Returns the
+    // handle of the same instance seen before, else of the only idle slot of
+    // the same product (product GUID and name), else a new one;
+    // kInvalidDeviceHandle if the slot table is full (the device then simply
+    // isn't tracked).
+    FFBDeviceHandle internDevice(const DeviceIdentity& device);
+    void            releaseDevice(FFBDeviceHandle device);
+
+    // Display name the handle was interned with.
+    const std::wstring& deviceName(FFBDeviceHandle device) const;
+
     // ---- Recording (called by WrapperEffect) ----
 
     // Record that effect was started. Marks wasRunning=true.
-    void recordStart(const std::wstring& deviceName, REFGUID effectGuid,
+    void recordStart(FFBDeviceHandle device, const EffectInstanceId& id,
                      DWORD iterations, DWORD flags);
 
     // Record that effect was stopped. Marks wasRunning=false.
-    void recordStop(const std::wstring& deviceName, REFGUID effectGuid);
+    void recordStop(FFBDeviceHandle device, const EffectInstanceId& id);
 
     // Deep-copy the DIEFFECT parameters for later replay.
-    void recordParams(const std::wstring& deviceName, REFGUID effectGuid,
+    void recordParams(FFBDeviceHandle device, const EffectInstanceId& id,
                       const DIEFFECT* peff);
 
+    // Apply a SendForceFeedbackCommand to every record of the device:
+    //   RESET    — all effects are gone; records cleared, device unpaused
+    //   STOPALL  — every running effect becomes stopped
+    //   PAUSE    — device paused; effects keep their running state, and a
+    //              re-created device is paused again before they restart
+    //   CONTINUE — device unpaused
+    // Other commands (actuators on/off) don't change effect state.
+    void recordCommand(FFBDeviceHandle device, DWORD command);
+
     // ---- Querying (called by WrapperDevice8::CreateEffect) ----
 
-    // Returns true if this effect type was previously running on this device.
-    // Fills outIterations/outFlags with the last Start() arguments.
-    bool wasRunning(const std::wstring& deviceName, REFGUID effectGuid,
+    // Returns true if this effect instance was previously running on this
+    // device. Fills outIterations/outFlags with the last Start() arguments.
+    bool wasRunning(FFBDeviceHandle device, const EffectInstanceId& id,
                     DWORD& outIterations, DWORD& outFlags) const;
 
-    // Get the full record for parameter replay. Returns nullptr if not found.
-    // The returned pointer remains valid only while the caller holds no other
-    // registry lock (single-threaded usage from CreateEffect is fine).
-    const EffectStateRecord* getRecord(const std::wstring& deviceName,
-                                       REFGUID effectGuid) const;
+    // Current snapshot of every effect record of the device (never null for
+    // a valid handle). Cheap when nothing was written since the last call.
+    FFBDeviceSnapshotPtr snapshot(FFBDeviceHandle device) const;
 
     // ---- Maintenance ----
 
-    // Clear all records for a device (e.g. DISFFC_RESET).
-    void clearDevice(const std::wstring& deviceName);
+    // Clear all records for a device (DISFFC_RESET). The handle stays valid.
+    void clearDevice(FFBDeviceHandle device);
 
     // Clear everything.
     void clearAll();
 
+    // Re-create the records FFBStateJournal recovered from the previous
+    // session. Call once, after the journal is opened and before any device
+    // is interned, so handles follow the recovered order.
+    void restoreFromJournal();
+
 private:
     FFBStateRegistry() = default;
     ~FFBStateRegistry() = default;
 
+    // One seqlock-published record. seq is odd while a writer is inside.
+    // Readers copy the record out of relaxed atomic words, so one racing a
+    // writer gets a mix of old and new words (which the sequence check
+    // throws away) instead of making a plain read of memory being written.
+    // Writers edit the plain copy, which only the seq holder touches, and
+    // publish it into the words.
+    using RecordWord = uintptr_t;
+    static constexpr size_t kRecordWords = sizeof(EffectStateRecord) / sizeof(RecordWord);
+    static_assert(sizeof(EffectStateRecord) % sizeof(RecordWord) == 0,
+                  "EffectStateRecord is published as whole words");
+
+    struct SeqRecord {
+        std::atomic<uint32_t>   seq{0};
+        EffectStateRecord       rec;                  // seq holder only
+        std::atomic<RecordWord> words[kRecordWords];  // published copy of rec
+
+        SeqRecord() { publish(); }
+        void load(EffectStateRecord& out) const;
+        void publish();
+    };
+
+    // All effect records of one interned device.
+    struct DeviceSlot {
+        FFBDeviceHandle                         handle;
+        GUID                                    instanceGuid{};   // latest holder
+        GUID                                    productGuid{};
+        std::wstring                            name;     // as first seen
+        std::wstring                            nameLower;
+        uint32_t                                live = 0; // device objects using it (m_mutex)
+        std::array<SeqRecord, kDenseRecordCount> dense;   // by denseRecordIndex
+        mutable std::mutex                       mutex;   // guards sparse
+        std::map<EffectInstanceKey, EffectStateRecord> sparse;  // no dense slot
+
+        std::atomic<bool>     paused{false};  // between PAUSE and CONTINUE/RESET
+        std::atomic<uint64_t> version{0};     // bumped after every write
+        // Latest built snapshot; accessed only via std::atomic_load/store.
+        mutable FFBDeviceSnapshotPtr published;
+    };
+
+    // Run fn(EffectStateRecord&) as the single writer of the effect's record.
+    template<class Fn>
+    static void write(DeviceSlot& dev, const EffectInstanceId& id, Fn&& fn);
+
+    // Copy the effect's record out; false for a sparse instance never seen.
+    static bool read(const DeviceSlot& dev, const EffectInstanceId& id,
+                     EffectStateRecord& out);
+    static void readDense(const SeqRecord& r, EffectStateRecord& out);
+
     static std::wstring toLower(const std::wstring& s);
 
-    // Device name (lowered) → (effect GUID → record)
-    std::map<std::wstring, std::map<GUID, EffectStateRecord, GUIDLess>> m_records;
-    mutable std::mutex m_mutex;
+    // Handle for device (see internDevice), under m_mutex.
+    FFBDeviceHandle internLocked(const DeviceIdentity& device);
+
+    // Slot for a handle, or nullptr for kInvalidDeviceHandle. Slots are never
+    // freed, and a handle is only handed out after its slot is constructed.
+    DeviceSlot* device(FFBDeviceHandle h) const {
+        return h < kMaxDevices ? m_slots[h].get() : nullptr;
+    }
+
+    std::array<std::unique_ptr<DeviceSlot>, kMaxDevices> m_slots;
+    size_t             m_slotCount = 0;
+    mutable std::mutex m_mutex;   // interning only
 };
@@ -0,0 +1,144 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026 Valmantas Paliksa
+#include "ffb_status_shadow.h"
+
+static ShadowFreshness freshness(bool known, ULONGLONG ageMs, DWORD maxAgeMs) {
+    if (!known) return ShadowFreshness::Unknown;
+    if (ageMs > 2ull * maxAgeMs) return ShadowFreshness::Expired;
+    if (ageMs > maxAgeMs) return ShadowFreshness::Stale;
+    return ShadowFreshness::Fresh;
+}
+
+// ============================================================================
+// DeviceStateShadow
+// ============================================================================
+void DeviceStateShadow::onCommand(DWORD command) {
+    if (command & (DISFFC_RESET | DISFFC_STOPALL))
+        m_stopEpoch.fetch_add(1, std::memory_order_acq_rel);
+
+    AcquireSRWLockExclusive(&m_lock);
+    if (command & DISFFC_RESET)
+        m_flags = (m_flags & ~DIGFFS_PAUSED) | DIGFFS_EMPTY | DIGFFS_STOPPED;
+    if (command & DISFFC_STOPALL)
+        m_flags |= DIGFFS_STOPPED;
+    if (command & DISFFC_PAUSE)
+        m_flags |= DIGFFS_PAUSED;
+    if (command & DISFFC_CONTINUE)
+        m_flags &= ~DIGFFS_PAUSED;
+    if (command & DISFFC_SETACTUATORSON)
+        m_flags = (m_flags & ~DIGFFS_ACTUATORSOFF) | DIGFFS_ACTUATORSON;
+    if (command & DISFFC_SETACTUATORSOFF)
+        m_flags = (m_flags & ~DIGFFS_ACTUATORSON) | DIGFFS_ACTUATORSOFF;
+    ReleaseSRWLockExclusive(&m_lock);
+}
+
+void DeviceStateShadow::onEffectStarted() {
+    AcquireSRWLockExclusive(&m_lock);
+    m_flags &= ~(DIGFFS_EMPTY | DIGFFS_STOPPED);
+    ReleaseSRWLockExclusive(&m_lock);
+}
+
+void DeviceStateShadow::onEffectStopped() {
+    AcquireSRWLockExclusive(&m_lock);
+    if (!(m_flags & DIGFFS_STOPPED))
+        m_known = false;
+    ReleaseSRWLockExclusive(&m_lock);
+}
+
+bool DeviceStateShadow::paused() const {
+    AcquireSRWLockShared(&m_lock);
+    bool paused = (m_flags & DIGFFS_PAUSED) != 0;
+    ReleaseSRWLockShared(&m_lock);
+    return paused;
+}
+
+void DeviceStateShadow::onDeviceState(DWORD flags, ULONGLONG now) {
+    AcquireSRWLockExclusive(&m_lock);
+    m_known    = true;
+    m_syncedAt = now;
+    m_flags    = flags;
+    ReleaseSRWLockExclusive(&m_lock);
+}
+
+void DeviceStateShadow::invalidate() {
+    AcquireSRWLockExclusive(&m_lock);
+    m_known = false;
+    ReleaseSRWLockExclusive(&m_lock);
+}
+
+ShadowFreshness DeviceStateShadow::query(DWORD& flags, ULONGLONG now, DWORD maxAgeMs) const {
+    AcquireSRWLockShared(&m_lock);
+    ShadowFreshness f = freshness(m_known, now - m_syncedAt, maxAgeMs);
+    flags = m_flags;
+    ReleaseSRWLockShared(&m_lock);
+    return f;
+}
+
+// ============================================================================
+// EffectStatusShadow
+// ============================================================================
+void EffectStatusShadow::setDuration(DWORD us) {
+    AcquireSRWLockExclusive(&m_lock);
+    m_durationUs = us;
+    ReleaseSRWLockExclusive(&m_lock);
+}
+
+void EffectStatusShadow::setStartDelay(DWORD us) {
+    AcquireSRWLockExclusive(&m_lock);
+    m_startDelayUs = us;
+    ReleaseSRWLockExclusive(&m_lock);
+}
+
+void EffectStatusShadow::onStart(DWORD iterations, uint32_t stopEpoch, ULONGLONG now) {
+    AcquireSRWLockExclusive(&m_lock);
+    m_known    = true;
+    m_syncedAt = now;
+    m_playing  = true;
+    m_epoch    = stopEpoch;
+    // A duration of 0 was never set; like INFINITE it runs until stopped.
+    if (iterations == INFINITE || m_durationUs == INFINITE || m_durationUs == 0) {
+        m_endsAt = 0;
+    } else {
+        uint64_t us = m_startDelayUs + uint64_t(m_durationUs) * iterations;
+        m_endsAt = now + (us + 999) / 1000;
+    }
+    ReleaseSRWLockExclusive(&m_lock);
+}
+
+void EffectStatusShadow::onStop(ULONGLONG now) {
+    AcquireSRWLockExclusive(&m_lock);
+    m_known    = true;
+    m_syncedAt = now;
+    m_playing  = false;
+    ReleaseSRWLockExclusive(&m_lock);
+}
+
+void EffectStatusShadow::onDeviceStatus(DWORD status, uint32_t stopEpoch, ULONGLONG now) {
+    AcquireSRWLockExclusive(&m_lock);
+    m_known      = true;
+    m_syncedAt   = now;
+    m_otherFlags = status & ~DIEGES_PLAYING;
+    bool playing = (status & DIEGES_PLAYING) != 0;
+    if (!playing || !m_playing || m_epoch != stopEpoch)
+        m_endsAt = 0;   // keep a known end only for a run we watched start
+    m_playing = playing;
+    m_epoch   = stopEpoch;
+    ReleaseSRWLockExclusive(&m_lock);
+}
+
+void EffectStatusShadow::invalidate() {
+    AcquireSRWLockExclusive(&m_lock);
+    m_known = false;
+    ReleaseSRWLockExclusive(&m_lock);
+}
+
+ShadowFreshness EffectStatusShadow::query(DWORD& status, uint32_t stopEpoch, ULONGLONG now,
+                                          DWORD maxAgeMs) const
+{
+    AcquireSRWLockShared(&m_lock);
+    ShadowFreshness f = freshness(m_known, now - m_syncedAt, maxAgeMs);
+    bool playing = m_playing && m_epoch == stopEpoch && (m_endsAt == 0 || now < m_endsAt);
+    status = m_otherFlags | (playing ? DIEGES_PLAYING : 0);
+    ReleaseSRWLockShared(&m_lock);
+    return f;
+}
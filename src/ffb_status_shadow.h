@@ -0,0 +1,89 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026 Valmantas Paliksa
+#pragma once
+
+#include <windows.h>
+#include <dinput.h>
+#include <atomic>
+#include <cstdint>
+
+// Shadow copies of GetEffectStatus / GetForceFeedbackState ([FFB] StatusMaxAgeMs).
+//
+// Games poll both often, and each real call can be a blocking HID feature
+// report read. The shadows are kept up to date from the Start/Stop/command
+// traffic the wrapper already intercepts, and a query is answered from them
+// while the last exchange with the device is at most StatusMaxAgeMs old.
+// Past that the caller asks the device again (or, with AsyncCommands, answers
+// from the shadow and lets the worker thread refresh it).
+//
+// What the shadows cannot see, such as a finite effect running out early or
+// the user flipping an actuator switch, is corrected by those refreshes; the
+// staleness bound is how long such a change can go unnoticed. With
+// AsyncCommands a Stale answer is still given while its refresh is queued,
+// but never past twice the bound (Expired): a worker stuck behind slow
+// commands must not let the shadow drift indefinitely.
+
+enum class ShadowFreshness : uint8_t {
+    Unknown,   // never synced, or invalidated by a failed call
+    Expired,   // older than twice the bound: a queued refresh never landed
+    Stale,     // answer available but older than the bound
+    Fresh,
+};
+
+// Device-wide state; owned by FFBFilter.
+class DeviceStateShadow {
+public:
+    // Bumped by STOPALL and RESET: effects started before that are stopped.
+    uint32_t stopEpoch() const { return m_stopEpoch.load(std::memory_order_acquire); }
+
+    // A DISFFC_* command was sent.
+    void onCommand(DWORD command);
+    // An effect started, so the device is neither empty nor stopped.
+    void onEffectStarted();
+    // An effect stopped or was unloaded. Whether that was the last one playing
+    // is the device's to say: a shadow that shows effects playing is dropped.
+    void onEffectStopped();
+    // DISFFC_PAUSE is in effect: no effect is reported as playing.
+    bool paused() const;
+    // The real GetForceFeedbackState returned flags.
+    void onDeviceState(DWORD flags, ULONGLONG now);
+    void invalidate();
+
+    ShadowFreshness query(DWORD& flags, ULONGLONG now, DWORD maxAgeMs) const;
+
+private:
+    mutable SRWLOCK       m_lock = SRWLOCK_INIT;
+    bool                  m_known = false;
+    ULONGLONG             m_syncedAt = 0;   // GetTickCount64
+    DWORD                 m_flags = 0;      // DIGFFS_*
+    std::atomic<uint32_t> m_stopEpoch{0};
+};
+
+// One effect's status; owned by WrapperEffect.
+class EffectStatusShadow {
+public:
+    // DIEP_DURATION / DIEP_STARTDELAY as the game set them (microseconds).
+    void setDuration(DWORD us);
+    void setStartDelay(DWORD us);
+
+    // The device accepted a Start / Stop (both count as a sync).
+    void onStart(DWORD iterations, uint32_t stopEpoch, ULONGLONG now);
+    void onStop(ULONGLONG now);
+    // The real GetEffectStatus returned status.
+    void onDeviceStatus(DWORD status, uint32_t stopEpoch, ULONGLONG now);
+    void invalidate();
+
+    ShadowFreshness query(DWORD& status, uint32_t stopEpoch, ULONGLONG now,
+                          DWORD maxAgeMs) const;
+
+private:
+    mutable SRWLOCK m_lock = SRWLOCK_INIT;
+    bool      m_known = false;
+    ULONGLONG m_syncedAt = 0;
+    bool      m_playing = false;
+    ULONGLONG m_endsAt = 0;         // tick a finite run ends, 0 = until stopped
+    uint32_t  m_epoch = 0;          // DeviceStateShadow::stopEpoch at start
+    DWORD     m_otherFlags = 0;     // DIEGES_EMULATED etc. from the device
+    DWORD     m_durationUs = INFINITE;
+    DWORD     m_startDelayUs = 0;
+};
@@ -0,0 +1,254 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026 Valmantas Paliksa
+#include "ffb_trace.h"
+#include "logger.h"
+#include <algorithm>
+#include <cstring>
+
+FFBTrace& FFBTrace::instance() {
+    static FFBTrace s;
+    return s;
+}
+
+// ============================================================================
+// Open / close
+// ============================================================================
+bool FFBTrace::open(const wchar_t* dllDirectory, DWORD sizeMB) {
+    if (active()) return true;
+
+    wchar_t path[MAX_PATH];
+    swprintf_s(path, L"%s\\dinput8_ffb_trace.bin", dllDirectory);
+
+    uint64_t bytes = static_cast<uint64_t>(std::max<DWORD>(sizeMB, 1)) << 20;
+    uint64_t capacity = (bytes - kFFBTraceHeaderSize) / sizeof(FFBTraceRecord);
+    uint64_t total = kFFBTraceHeaderSize + capacity * sizeof(FFBTraceRecord);
+
+    m_file = CreateFileW(path, GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ,
+                         nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (m_file == INVALID_HANDLE_VALUE) {
+        LOG_ERROR("FFB trace: cannot create %ls (error %lu)", path, GetLastError());
+        return false;
+    }
+
+    m_mapping = CreateFileMappingW(m_file, nullptr, PAGE_READWRITE,
+                                   static_cast<DWORD>(total >> 32),
+                                   static_cast<DWORD>(total & 0xFFFFFFFF),
+                                   nullptr);
+    void* view = m_mapping ? MapViewOfFile(m_mapping, FILE_MAP_WRITE, 0, 0, 0)
+                           : nullptr;
+    if (!view) {
+        LOG_ERROR("FFB trace: cannot map %ls (error %lu)", path, GetLastError());
+        close();
+        return false;
+    }
+
+    // A fresh mapping is zero-filled, so every record slot starts empty.
+    m_header = static_cast<FFBTraceFileHeader*>(view);
+    std::memcpy(m_header->magic, kFFBTraceMagic, sizeof(kFFBTraceMagic));
+    m_header->version     = kFFBTraceVersion;
+    m_header->headerSize  = kFFBTraceHeaderSize;
+    m_header->recordSize  = sizeof(FFBTraceRecord);
+    m_header->capacity    = capacity;
+
+    LARGE_INTEGER freq, now;
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&now);
+    FILETIME ft;
+    GetSystemTimeAsFileTime(&ft);
+    m_header->ticksPerSecond = static_cast<uint64_t>(freq.QuadPart);
+    m_header->startTicks     = static_cast<uint64_t>(now.QuadPart);
+    m_header->startFileTime  = (static_cast<uint64_t>(ft.dwHighDateTime) << 32) |
+                               ft.dwLowDateTime;
+
+    m_capacity = capacity;
+    m_sequence.store(0);
+    m_records.store(reinterpret_cast<FFBTraceRecord*>(
+                        static_cast<uint8_t*>(view) + kFFBTraceHeaderSize),
+                    std::memory_order_release);
+
+    LOG_INFO("FFB trace: writing %llu records (%lu MB) to %ls",
+             static_cast<unsigned long long>(capacity), sizeMB, path);
+    return true;
+}
+
+void FFBTrace::close() {
+    // Stop new producers, then wait for the ones already inside record().
+    // If some are still there (a game thread stuck mid-call while the DLL
+    // detaches), flush but leave the view mapped; the OS reclaims it at exit.
+    m_records.store(nullptr, std::memory_order_seq_cst);
+    bool quiet = false;
+    for (int i = 0; i < 100 && !(quiet = m_writers.load(std::memory_order_seq_cst) == 0); ++i)
+        Sleep(1);
+
+    if (m_header) {
+        m_header->nextSequence = m_sequence.load();
+        FlushViewOfFile(m_header, 0);
+        if (!quiet) {
+            LOG_WARN("FFB trace: producers still active at close, view left mapped");
+            return;
+        }
+        UnmapViewOfFile(m_header);
+        m_header = nullptr;
+    }
+    if (m_mapping) {
+        CloseHandle(m_mapping);
+        m_mapping = nullptr;
+    }
+    if (m_file != INVALID_HANDLE_VALUE) {
+        CloseHandle(m_file);
+        m_file = INVALID_HANDLE_VALUE;
+    }
+}
+
+// ============================================================================
+// Devices
+// ============================================================================
+uint16_t FFBTrace::registerDevice(const std::wstring& deviceName) {
+    if (!active()) return 0;
+
+    std::lock_guard<std::mutex> lock(m_deviceMutex);
+
+    // wchar_t is UTF-16 on Windows, so names copy unit for unit.
+    uint16_t units[kFFBTraceNameChars] = {};
+    size_t len = std::min<size_t>(deviceName.size(), kFFBTraceNameChars - 1);
+    for (size_t i = 0; i < len; ++i)
+        units[i] = static_cast<uint16_t>(deviceName[i]);
+
+    for (uint32_t i = 0; i < m_header->deviceCount; ++i) {
+        if (std::memcmp(m_header->devices[i].name, units, sizeof(units)) == 0)
+            return static_cast<uint16_t>(i);
+    }
+
+    if (m_header->deviceCount >= kFFBTraceMaxDevices) {
+        LOG_WARN("FFB trace: device table full, [%ls] shares id %u",
+                 deviceName.c_str(), kFFBTraceMaxDevices - 1);
+        return static_cast<uint16_t>(kFFBTraceMaxDevices - 1);
+    }
+
+    uint32_t id = m_header->deviceCount;
+    std::memcpy(m_header->devices[id].name, units, sizeof(units));
+    m_header->deviceCount = id + 1;
+    return static_cast<uint16_t>(id);
+}
+
+// ============================================================================
+// Recording
+// ============================================================================
+
+// Flatten the type-specific block. DICUSTOMFORCE holds a pointer, so it is
+// rewritten as {cChannels, dwSamplePeriod, cSamples, samples...}.
+static void copyTypeSpecific(FFBTraceRecord& r, EffectKind kind,
+                             const DIEFFECT* peff)
+{
+    r.cbTypeSpecific = peff->cbTypeSpecificParams;
+    if (!peff->lpvTypeSpecificParams || peff->cbTypeSpecificParams == 0)
+        return;
+
+    if (effectKindCategory(kind) == EffectCategory::Custom &&
+        peff->cbTypeSpecificParams >= sizeof(DICUSTOMFORCE))
+    {
+        auto* cf = static_cast<const DICUSTOMFORCE*>(peff->lpvTypeSpecificParams);
+        uint32_t hdr[3] = { static_cast<uint32_t>(cf->cChannels),
+                            static_cast<uint32_t>(cf->dwSamplePeriod),
+                            static_cast<uint32_t>(cf->cSamples) };
+        std::memcpy(r.typeSpecific, hdr, sizeof(hdr));
+
+        uint64_t total = static_cast<uint64_t>(cf->cChannels) * cf->cSamples;
+        uint64_t room  = (kFFBTraceTypeSpecificBytes - sizeof(hdr)) / sizeof(int32_t);
+        uint64_t n     = cf->rglForceData ? std::min(total, room) : 0;
+        for (uint64_t i = 0; i < n; ++i) {
+            int32_t v = cf->rglForceData[i];
+            std::memcpy(r.typeSpecific + sizeof(hdr) + i * sizeof(v), &v, sizeof(v));
+        }
+        r.typeSpecificBytes = static_cast<uint32_t>(sizeof(hdr) + n * sizeof(int32_t));
+        if (n < total) r.payloadFlags |= kFFBTraceTypeSpecTruncated;
+        return;
+    }
+
+    DWORD n = std::min<DWORD>(peff->cbTypeSpecificParams, kFFBTraceTypeSpecificBytes);
+    std::memcpy(r.typeSpecific, peff->lpvTypeSpecificParams, n);
+    r.typeSpecificBytes = n;
+    if (n < peff->cbTypeSpecificParams) r.payloadFlags |= kFFBTraceTypeSpecTruncated;
+}
+
+void FFBTrace::record(FFBTraceMethod method, uint16_t deviceId, EffectKind kind,
+                      uint32_t effectSerial, HRESULT hr, const DIEFFECT* peff,
+                      DWORD arg0, DWORD arg1)
+{
+    // Counted so close() can tell when no producer still holds the view.
+    m_writers.fetch_add(1, std::memory_order_seq_cst);
+    FFBTraceRecord* records = m_records.load(std::memory_order_seq_cst);
+    if (!records) {
+        m_writers.fetch_sub(1, std::memory_order_release);
+        return;
+    }
+
+    uint64_t seq = m_sequence.fetch_add(1, std::memory_order_relaxed) + 1;
+    FFBTraceRecord& slot = records[(seq - 1) % m_capacity];
+
+    FFBTraceRecord r = {};
+    LARGE_INTEGER now;
+    QueryPerformanceCounter(&now);
+
+    r.timestamp    = static_cast<uint64_t>(now.QuadPart);
+    r.deviceId     = deviceId;
+    r.effect       = static_cast<uint8_t>(kind);
+    r.method       = static_cast<uint8_t>(method);
+    r.hresult      = static_cast<int32_t>(hr);
+    r.effectSerial = effectSerial;
+    r.arg0         = arg0;
+    r.arg1         = arg1;
+
+    if (peff) {
+        // Only what the call declares valid is read: SetParameters names the
+        // fields in its dwFlags (arg0), CreateEffect and the auto-restart
+        // replay pass a complete structure. A DX5-sized DIEFFECT ends before
+        // dwStartDelay.
+        DWORD params = method == FFBTraceMethod::SetParameters ? arg0 : DIEP_ALLPARAMS;
+        if (peff->dwSize < sizeof(DIEFFECT)) params &= ~DIEP_STARTDELAY;
+
+        r.payloadFlags           |= kFFBTraceHasParams;
+        r.dwFlags                 = peff->dwFlags;
+        r.dwDuration              = peff->dwDuration;
+        r.dwSamplePeriod          = peff->dwSamplePeriod;
+        r.dwGain                  = peff->dwGain;
+        r.dwTriggerButton         = peff->dwTriggerButton;
+        r.dwTriggerRepeatInterval = peff->dwTriggerRepeatInterval;
+        if (params & DIEP_STARTDELAY)
+            r.dwStartDelay        = peff->dwStartDelay;
+
+        if (params & (DIEP_AXES | DIEP_DIRECTION)) {
+            r.cAxes = peff->cAxes;
+            DWORD axes = std::min<DWORD>(peff->cAxes, kFFBTraceMaxAxes);
+            for (DWORD i = 0; i < axes; ++i) {
+                if ((params & DIEP_AXES) && peff->rgdwAxes)
+                    r.axes[i] = peff->rgdwAxes[i];
+                if ((params & DIEP_DIRECTION) && peff->rglDirection)
+                    r.directions[i] = peff->rglDirection[i];
+            }
+        }
+
+        if ((params & DIEP_ENVELOPE) && peff->lpEnvelope) {
+            r.payloadFlags |= kFFBTraceHasEnvelope;
+            r.attackLevel   = peff->lpEnvelope->dwAttackLevel;
+            r.attackTime    = peff->lpEnvelope->dwAttackTime;
+            r.fadeLevel     = peff->lpEnvelope->dwFadeLevel;
+            r.fadeTime      = peff->lpEnvelope->dwFadeTime;
+        }
+
+        if (params & DIEP_TYPESPECIFICPARAMS)
+            copyTypeSpecific(r, kind, peff);
+    }
+
+    // Publish: clear the old sequence (ring wrap), copy the body, then store
+    // the new sequence last so readers never see a torn record.
+    slot.sequence = 0;
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(reinterpret_cast<uint8_t*>(&slot) + sizeof(slot.sequence),
+                reinterpret_cast<const uint8_t*>(&r) + sizeof(r.sequence),
+                sizeof(r) - sizeof(r.sequence));
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.sequence = seq;
+
+    m_writers.fetch_sub(1, std::memory_order_release);
+}
@@ -0,0 +1,51 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026 Valmantas Paliksa
+#pragma once
+
+#include <windows.h>
+#include <dinput.h>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+#include "effect_kind.h"
+#include "ffb_trace_format.h"
+
+// Global singleton writing the binary FFB trace (see ffb_trace_format.h).
+//
+// Every intercepted FFB call is appended as one fixed-size record to a
+// memory-mapped ring file next to the DLL. Writers only claim a slot with an
+// atomic increment and copy the call into mapped memory — no locks, no
+// formatting, no file I/O on the game thread. Decode offline with
+// tools/ffb_trace_decode.
+class FFBTrace {
+public:
+    static FFBTrace& instance();
+
+    // Create/overwrite <dllDirectory>\dinput8_ffb_trace.bin sized sizeMB.
+    bool open(const wchar_t* dllDirectory, DWORD sizeMB);
+    void close();
+
+    bool active() const { return m_records.load(std::memory_order_acquire) != nullptr; }
+
+    // Assign a stable device id for a product name (same name → same id).
+    uint16_t registerDevice(const std::wstring& deviceName);
+
+    void record(FFBTraceMethod method, uint16_t deviceId, EffectKind kind,
+                uint32_t effectSerial, HRESULT hr, const DIEFFECT* peff,
+                DWORD arg0, DWORD arg1);
+
+private:
+    FFBTrace() = default;
+    ~FFBTrace() = default;
+
+    HANDLE                        m_file    = INVALID_HANDLE_VALUE;
+    HANDLE                        m_mapping = nullptr;
+    FFBTraceFileHeader*           m_header  = nullptr;
+    std::atomic<FFBTraceRecord*>  m_records{nullptr};
+    uint64_t                      m_capacity = 0;
+    std::atomic<uint64_t>         m_sequence{0};
+    std::atomic<uint32_t>         m_writers{0};   // producers inside record()
+    std::mutex                    m_deviceMutex;
+};
@@ -0,0 +1,154 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026 Valmantas Paliksa
+#pragma once
+//
+// On-disk layout of the binary FFB trace (dinput8_ffb_trace.bin).
+//
+// Shared between the DLL (writer, Windows) and tools/ffb_trace_decode
+// (reader, any platform), so this header must stay free of Windows types:
+// only fixed-width integers, little-endian, naturally aligned.
+//
+// File layout:
+//   [FFBTraceFileHeader]           — kFFBTraceHeaderSize bytes
+//   [FFBTraceRecord] * capacity    — fixed-size ring of records
+//
+// Records are written into slot (sequence - 1) % capacity. A slot whose
+// sequence is 0 was never written. The sequence field is stored last, so a
+// reader that sees a non-zero sequence sees a complete record.
+//
+#include <cstddef>
+#include <cstdint>
+
+constexpr char     kFFBTraceMagic[8]   = {'F','F','B','T','R','A','C','E'};
+constexpr uint32_t kFFBTraceVersion    = 1;
+constexpr uint32_t kFFBTraceHeaderSize = 4096;
+constexpr uint32_t kFFBTraceMaxDevices = 30;
+constexpr uint32_t kFFBTraceNameChars  = 64;    // UTF-16 code units incl. NUL
+constexpr uint32_t kFFBTraceMaxAxes    = 4;
+constexpr uint32_t kFFBTraceTypeSpecificBytes = 128;
+
+// Dense effect-type index (matches the order of effectGuidToString).
+enum class FFBTraceEffect : uint8_t {
+    Unknown = 0,
+    ConstantForce,
+    RampForce,
+    Square,
+    Sine,
+    Triangle,
+    SawtoothUp,
+    SawtoothDown,
+    Spring,
+    Damper,
+    Inertia,
+    Friction,
+    CustomForce,
+    Count
+};
+
+enum class FFBTraceMethod : uint8_t {
+    CreateEffect = 0,
+    SetParameters,
+    Start,
+    Stop,
+    Download,
+    Unload,
+    GetEffectStatus,
+    SendCommand,
+    AutoRestart,
+    GetForceFeedbackState,
+    Count
+};
+
+// FFBTraceRecord::payloadFlags
+constexpr uint32_t kFFBTraceHasParams        = 0x1;  // DIEFFECT fields valid
+constexpr uint32_t kFFBTraceHasEnvelope      = 0x2;
+constexpr uint32_t kFFBTraceTypeSpecTruncated = 0x4; // typeSpecific did not fit
+
+// FFBTraceRecord::arg1 for SetParameters: what happened to the update
+constexpr uint32_t kFFBTraceParamsForwarded  = 0;  // sent to the device
+constexpr uint32_t kFFBTraceParamsSuppressed = 1;  // same as last sent, skipped
+constexpr uint32_t kFFBTraceParamsQueued     = 2;  // coalescing mailbox
+
+// FFBTraceRecord::arg0 for GetEffectStatus/GetForceFeedbackState: where the
+// answer came from
+constexpr uint32_t kFFBTraceStatusDevice     = 0;  // the real device
+constexpr uint32_t kFFBTraceStatusShadow     = 1;  // status shadow
+
+struct FFBTraceDeviceEntry {
+    uint16_t name[kFFBTraceNameChars];   // UTF-16LE product name
+};
+
+struct FFBTraceFileHeader {
+    char     magic[8];
+    uint32_t version;
+    uint32_t headerSize;
+    uint32_t recordSize;
+    uint32_t deviceCount;
+    uint64_t capacity;          // number of record slots
+    uint64_t nextSequence;      // last sequence handed out (written on close)
+    uint64_t ticksPerSecond;    // timestamp frequency (QPC)
+    uint64_t startTicks;        // QPC value at trace open
+    uint64_t startFileTime;     // FILETIME (UTC, 100 ns since 1601) at trace open
+    FFBTraceDeviceEntry devices[kFFBTraceMaxDevices];
+};
+static_assert(sizeof(FFBTraceFileHeader) <= kFFBTraceHeaderSize,
+              "trace header does not fit its reserved block");
+
+// One intercepted call. Mirrors DIEFFECT with the pointers flattened inline.
+// Custom forces store {cChannels, dwSamplePeriod, cSamples} followed by as
+// many samples as fit; the rest is dropped and kFFBTraceTypeSpecTruncated set.
+struct FFBTraceRecord {
+    uint64_t sequence;          // 1-based, 0 = empty slot; written last
+    uint64_t timestamp;         // QPC ticks
+    uint16_t deviceId;          // index into FFBTraceFileHeader::devices
+    uint8_t  effect;            // FFBTraceEffect
+    uint8_t  method;            // FFBTraceMethod
+    int32_t  hresult;
+    uint32_t effectSerial;      // per-process WrapperEffect instance number
+    uint32_t arg0;              // Start: iterations, SetParameters: dwFlags, SendCommand: command,
+                                //   GetEffectStatus/GetForceFeedbackState: kFFBTraceStatus*
+    uint32_t arg1;              // Start: flags, GetEffectStatus/GetForceFeedbackState: status flags,
+                                //   SetParameters: kFFBTraceParams*
+    uint32_t payloadFlags;
+
+    // DIEFFECT scalars
+    uint32_t dwFlags;
+    uint32_t dwDuration;
+    uint32_t dwSamplePeriod;
+    uint32_t dwGain;
+    uint32_t dwTriggerButton;
+    uint32_t dwTriggerRepeatInterval;
+    uint32_t dwStartDelay;
+    uint32_t cAxes;
+    uint32_t axes[kFFBTraceMaxAxes];
+    int32_t  directions[kFFBTraceMaxAxes];
+
+    // DIENVELOPE (without dwSize)
+    uint32_t attackLevel;
+    uint32_t attackTime;
+    uint32_t fadeLevel;
+    uint32_t fadeTime;
+
+    uint32_t cbTypeSpecific;    // original cbTypeSpecificParams
+    uint32_t typeSpecificBytes; // bytes actually stored below
+    uint8_t  typeSpecific[kFFBTraceTypeSpecificBytes];
+};
+static_assert(sizeof(FFBTraceRecord) == 256, "FFBTraceRecord layout changed");
+
+inline const char* ffbTraceEffectName(uint8_t e) {
+    static const char* const names[] = {
+        "Unknown", "ConstantForce", "RampForce", "Square", "Sine", "Triangle",
+        "SawtoothUp", "SawtoothDown", "Spring", "Damper", "Inertia",
+        "Friction", "CustomForce",
+    };
+    return e < static_cast<uint8_t>(FFBTraceEffect::Count) ? names[e] : "Unknown";
+}
+
+inline const char* ffbTraceMethodName(uint8_t m) {
+    static const char* const names[] = {
+        "CreateEffect", "SetParameters", "Start", "Stop", "Download",
+        "Unload", "GetEffectStatus", "SendCommand", "AutoRestart",
+        "GetForceFeedbackState",
+    };
+    return m < static_cast<uint8_t>(FFBTraceMethod::Count) ? names[m] : "Unknown";
+}
@@ -3,15 +3,16 @@
 #include "logger.h"
 #include <cstdarg>
 #include <cstring>
-#include <windows.h>
+#include <cwchar>
 
 Logger& Logger::instance() {
     static Logger s;
     return s;
 }
 
+Logger::Logger() = default;
+
 void Logger::init(const wchar_t* dllDirectory) {
-    std::lock_guard<std::mutex> lock(m_mutex);
     if (m_file) return;
 
     wchar_t path[MAX_PATH];
@@ -19,57 +20,92 @@ void Logger::init(const wchar_t* dllDirectory) {
     wcscat_s(path, L"\\dinput8_wrapper.log");
 
     m_file = _wfopen(path, L"a");
-    if (m_file) {
-        fprintf(m_file, "\n=== dinput8 wrapper loaded ===\n");
-        fflush(m_file);
-    }
+    if (!m_file) return;
+
+    fprintf(m_file, "\n=== dinput8 wrapper loaded ===\n");
+    fflush(m_file);
+
+    m_stop.store(false);
+    m_wake   = CreateEventW(nullptr, FALSE, FALSE, nullptr);
+    m_exited = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+    m_thread = CreateThread(nullptr, 0, &Logger::writerThreadProc, this, 0, nullptr);
+    if (m_thread)
+        SetThreadPriority(m_thread, THREAD_PRIORITY_BELOW_NORMAL);
+
+    m_open.store(true, std::memory_order_release);
 }
 
 void Logger::setLevel(LogLevel level) {
-    m_level = level;
+    m_level.store(level, std::memory_order_relaxed);
 }
 
-void Logger::log(LogLevel level, const char* fmt, ...) {
-    if (level > m_level || !m_file) return;
+// ---------------------------------------------------------------------------
+// Producer side (any thread)
+// ---------------------------------------------------------------------------
 
-    std::lock_guard<std::mutex> lock(m_mutex);
+Logger::Entry* Logger::acquireEntry(LogLevel level, bool wide, size_t& pos) {
+    Entry* entry = m_ring.tryAcquire(pos);
+    if (!entry) {
+        m_dropped.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+    GetSystemTimeAsFileTime(&entry->time);
+    entry->level = level;
+    entry->wide  = wide;
+    return entry;
+}
 
-    SYSTEMTIME st;
-    GetLocalTime(&st);
-    fprintf(m_file, "[%02d:%02d:%02d.%03d] ",
-            st.wHour, st.wMinute, st.wSecond, st.wMilliseconds);
+void Logger::log(LogLevel level, const char* fmt, ...) {
+    if (level > m_level.load(std::memory_order_relaxed) ||
+        !m_open.load(std::memory_order_acquire))
+        return;
 
-    const char* prefix = "";
-    switch (level) {
-        case LogLevel::Error: prefix = "[ERROR] "; break;
-        case LogLevel::Warn:  prefix = "[WARN]  "; break;
-        case LogLevel::Info:  prefix = "[INFO]  "; break;
-        case LogLevel::Debug: prefix = "[DEBUG] "; break;
-        default: break;
-    }
-    fputs(prefix, m_file);
+    size_t pos;
+    Entry* entry = acquireEntry(level, false, pos);
+    if (!entry) return;
 
+    // Arguments are rendered here rather than deferred: %s/%ls frequently
+    // point at caller-owned strings that are gone by the time we drain.
     va_list args;
     va_start(args, fmt);
-    vfprintf(m_file, fmt, args);
+    vsnprintf(entry->text, sizeof(entry->text), fmt, args);
     va_end(args);
 
-    fputc('\n', m_file);
-    fflush(m_file);
+    m_ring.publish(pos);
 }
 
 void Logger::logW(LogLevel level, const wchar_t* fmt, ...) {
-    if (level > m_level || !m_file) return;
+    if (level > m_level.load(std::memory_order_relaxed) ||
+        !m_open.load(std::memory_order_acquire))
+        return;
+
+    size_t pos;
+    Entry* entry = acquireEntry(level, true, pos);
+    if (!entry) return;
 
-    std::lock_guard<std::mutex> lock(m_mutex);
+    constexpr size_t count = sizeof(entry->wtext) / sizeof(entry->wtext[0]);
+    va_list args;
+    va_start(args, fmt);
+    vswprintf(entry->wtext, count, fmt, args);
+    va_end(args);
+    entry->wtext[count - 1] = L'\0';
 
-    SYSTEMTIME st;
-    GetLocalTime(&st);
+    m_ring.publish(pos);
+}
+
+// ---------------------------------------------------------------------------
+// Consumer side (writer thread, or close() once the writer is gone)
+// ---------------------------------------------------------------------------
+void Logger::writeEntry(const Entry& entry) {
+    FILETIME local;
+    SYSTEMTIME st = {};
+    FileTimeToLocalFileTime(&entry.time, &local);
+    FileTimeToSystemTime(&local, &st);
     fprintf(m_file, "[%02d:%02d:%02d.%03d] ",
             st.wHour, st.wMinute, st.wSecond, st.wMilliseconds);
 
     const char* prefix = "";
-    switch (level) {
+    switch (entry.level) {
         case LogLevel::Error: prefix = "[ERROR] "; break;
         case LogLevel::Warn:  prefix = "[WARN]  "; break;
         case LogLevel::Info:  prefix = "[INFO]  "; break;
@@ -78,17 +114,80 @@ void Logger::logW(LogLevel level, const wchar_t* fmt, ...) {
     }
     fputs(prefix, m_file);
 
-    va_list args;
-    va_start(args, fmt);
-    vfwprintf(m_file, fmt, args);
-    va_end(args);
+    if (entry.wide)
+        fprintf(m_file, "%ls", entry.wtext);
+    else
+        fputs(entry.text, m_file);
 
     fputc('\n', m_file);
-    fflush(m_file);
+}
+
+size_t Logger::drain() {
+    if (!m_file) return 0;
+
+    size_t written = m_ring.consume([this](const Entry& entry) { writeEntry(entry); });
+
+    unsigned long long dropped = m_dropped.load(std::memory_order_relaxed);
+    if (dropped != m_droppedReported) {
+        fprintf(m_file, "[WARN]  Logger: %llu message(s) dropped (ring full)\n",
+                dropped - m_droppedReported);
+        m_droppedReported = dropped;
+        ++written;
+    }
+
+    if (written) fflush(m_file);
+    return written;
+}
+
+DWORD WINAPI Logger::writerThreadProc(LPVOID param) {
+    auto* self = static_cast<Logger*>(param);
+    while (!self->m_stop.load(std::memory_order_acquire)) {
+        WaitForSingleObject(self->m_wake, kFlushIntervalMs);
+        if (self->m_consumerBusy.exchange(true, std::memory_order_acquire))
+            continue;
+        self->drain();
+        self->m_consumerBusy.store(false, std::memory_order_release);
+    }
+    // Signalled rather than joined: close() runs under the loader lock, where
+    // a thread handle only becomes signalled after DllMain returns.
+    SetEvent(self->m_exited);
+    return 0;
 }
 
 void Logger::close() {
-    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_open.exchange(false)) return;
+
+    m_stop.store(true, std::memory_order_release);
+    if (m_wake) SetEvent(m_wake);
+
+    // The writer is gone once it has left its loop, or once it has been
+    // terminated (process exit) while not inside drain(). Anything else means
+    // it may still touch the ring or the file: skip the final drain, leave
+    // the file and the wake event alone and let the CRT flush at exit.
+    bool writerGone = !m_thread;
+    if (m_thread) {
+        HANDLE handles[2] = { m_exited, m_thread };
+        DWORD wait = WaitForMultipleObjects(2, handles, FALSE, 500);
+        writerGone = wait == WAIT_OBJECT_0 ||
+                     (wait == WAIT_OBJECT_0 + 1 &&
+                      !m_consumerBusy.load(std::memory_order_acquire));
+        CloseHandle(m_thread);
+        m_thread = nullptr;
+    }
+    if (!writerGone) return;
+
+    if (m_wake) {
+        CloseHandle(m_wake);
+        m_wake = nullptr;
+    }
+    if (m_exited) {
+        CloseHandle(m_exited);
+        m_exited = nullptr;
+    }
+
+    // Final flush on the detaching thread, now the single consumer.
+    drain();
+
     if (m_file) {
         fclose(m_file);
         m_file = nullptr;
@@ -2,8 +2,11 @@
 // Copyright (c) 2026 Valmantas Paliksa
 #pragma once
 
+#include <windows.h>
+#include <atomic>
+#include <cstddef>
 #include <cstdio>
-#include <mutex>
+#include "mpsc_ring.h"
 
 enum class LogLevel : int {
     None  = 0,
@@ -13,27 +16,74 @@ enum class LogLevel : int {
     Debug = 4
 };
 
+// Asynchronous file logger.
+//
+// log()/logW() run on whatever game thread triggered them (often the DCS
+// input thread inside SetParameters/Start), so they never touch the file.
+// Each call renders its message into a slot of a bounded lock-free MPSC ring
+// together with a timestamp; a background writer thread drains the ring,
+// adds the prefix and writes the batch with a single fflush.
+//
+// When the ring is full new messages are dropped and counted; the writer
+// reports the drop count in the log. close() (called from DLL_PROCESS_DETACH)
+// stops the writer and drains whatever is still queued, unless the writer
+// could not be confirmed stopped; then the file is left to the CRT.
 class Logger {
 public:
     static Logger& instance();
 
     void init(const wchar_t* dllDirectory);
     void setLevel(LogLevel level);
-    LogLevel level() const { return m_level; }
+    LogLevel level() const { return m_level.load(std::memory_order_relaxed); }
 
     void log(LogLevel level, const char* fmt, ...);
     void logW(LogLevel level, const wchar_t* fmt, ...);
     void close();
 
+    // Number of messages discarded because the ring was full.
+    unsigned long long droppedCount() const {
+        return m_dropped.load(std::memory_order_relaxed);
+    }
+
 private:
-    Logger() = default;
+    Logger();
     ~Logger();
     Logger(const Logger&) = delete;
     Logger& operator=(const Logger&) = delete;
 
+    static constexpr size_t kSlotCount = 2048;   // must be a power of two
+    static constexpr size_t kTextChars = 480;    // bytes of narrow text per slot
+    static constexpr DWORD  kFlushIntervalMs = 20;
+
+    struct Entry {
+        LogLevel level = LogLevel::None;
+        bool     wide  = false;
+        FILETIME time  = {};
+        union {
+            char    text[kTextChars] = {};
+            wchar_t wtext[kTextChars / sizeof(wchar_t)];
+        };
+    };
+
+    Entry* acquireEntry(LogLevel level, bool wide, size_t& pos);   // nullptr when full
+    size_t drain();                                  // single consumer only
+    void   writeEntry(const Entry& entry);
+
+    static DWORD WINAPI writerThreadProc(LPVOID param);
+
     FILE*      m_file  = nullptr;
-    LogLevel   m_level = LogLevel::Info;
-    std::mutex m_mutex;
+
+    std::atomic<LogLevel> m_level{LogLevel::Info};   // Config hot reload sets it
+    std::atomic<bool>   m_open{false};
+    std::atomic<bool>   m_stop{false};
+    std::atomic<bool>   m_consumerBusy{false};   // writer is inside drain()
+    HANDLE              m_thread = nullptr;
+    HANDLE              m_wake   = nullptr;
+    HANDLE              m_exited = nullptr;      // writer left its loop
+
+    MpscRing<Entry, kSlotCount> m_ring;
+    alignas(64) std::atomic<unsigned long long> m_dropped{0};
+    unsigned long long              m_droppedReported = 0;
 };
 
 #define LOG_ERROR(fmt, ...) Logger::instance().log(LogLevel::Error, fmt, ##__VA_ARGS__)
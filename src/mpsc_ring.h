@@ -0,0 +1,90 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026 Valmantas Paliksa
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// Bounded lock-free multi-producer / single-consumer ring (Vyukov style).
+//
+// Each slot carries a sequence number that tells producers whether it is
+// free and the consumer whether it is published:
+//
+//     seq == pos             free, producer at pos may claim it
+//     seq == pos + 1         published, consumer may read it
+//     seq == pos + Slots     consumed, free again for the next lap
+//
+// A producer claims a position with one CAS on the head, fills the payload
+// in place and publishes with a release store; the consumer never waits on
+// a producer that is still filling, it simply stops there. No Windows types,
+// so the ring can be exercised on any platform.
+template<typename T, size_t Slots>
+class MpscRing {
+    static_assert(Slots && (Slots & (Slots - 1)) == 0, "Slots must be a power of two");
+
+public:
+    MpscRing() {
+        for (size_t i = 0; i < Slots; ++i)
+            m_slots[i].seq.store(i, std::memory_order_relaxed);
+    }
+
+    MpscRing(const MpscRing&) = delete;
+    MpscRing& operator=(const MpscRing&) = delete;
+
+    // Claim the next slot (any thread), or nullptr when the ring is full.
+    // The payload must be passed to publish() with the returned pos.
+    T* tryAcquire(size_t& pos) {
+        size_t p = m_head.load(std::memory_order_relaxed);
+        for (;;) {
+            Slot& slot = m_slots[p & (Slots - 1)];
+            size_t seq = slot.seq.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(p);
+            if (diff == 0) {
+                if (m_head.compare_exchange_weak(p, p + 1, std::memory_order_relaxed)) {
+                    pos = p;
+                    return &slot.value;
+                }
+            } else if (diff < 0) {
+                return nullptr;   // full
+            } else {
+                p = m_head.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    void publish(size_t pos) {
+        m_slots[pos & (Slots - 1)].seq.store(pos + 1, std::memory_order_release);
+    }
+
+    // Hand every published slot, in order, to fn(const T&) and free it.
+    // Single consumer only. Returns the number of slots consumed.
+    template<typename Fn>
+    size_t consume(Fn&& fn) {
+        size_t n = 0;
+        for (;;) {
+            Slot& slot = m_slots[m_tail & (Slots - 1)];
+            if (slot.seq.load(std::memory_order_acquire) != m_tail + 1)
+                break;   // empty (or the next producer is still filling)
+            fn(static_cast<const T&>(slot.value));
+            slot.seq.store(m_tail + Slots, std::memory_order_release);
+            ++m_tail;
+            ++n;
+        }
+        return n;
+    }
+
+    // Positions claimed so far (monotonic; a depth estimate with consumed()).
+    size_t claimed()  const { return m_head.load(std::memory_order_relaxed); }
+    size_t consumed() const { return m_tail; }   // consumer thread only
+
+private:
+    struct Slot {
+        std::atomic<size_t> seq{0};
+        T                   value{};
+    };
+
+    Slot                            m_slots[Slots];
+    alignas(64) std::atomic<size_t> m_head{0};   // next position to claim (producers)
+    alignas(64) size_t              m_tail = 0;  // next position to read (consumer)
+};
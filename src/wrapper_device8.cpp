@@ -2,8 +2,8 @@
 // Copyright (c) 2026 Valmantas Paliksa
 #include "wrapper_device8.h"
 #include "wrapper_effect.h"
+#include "ffb_prewarm_pool.h"
 #include "ffb_state_registry.h"
-#include "config.h"
 #include "logger.h"
 
 // ============================================================================
@@ -24,9 +24,50 @@ template<bool U>
 WrapperDevice8<U>::~WrapperDevice8() {
     LOG_DEBUG("WrapperDevice8<%s> destroyed for [%ls]", U ? "W" : "A",
               m_filter->deviceName().c_str());
+    if (auto* worker = m_filter->worker())
+        worker->waitIdle();   // queued commands still point at us
+    m_prewarm.reset();        // effects the game never asked for
     if (m_real) m_real->Release();
 }
 
+template<bool U>
+void WrapperDevice8<U>::prewarmEffects() {
+    if (!m_filter->prewarm() || !m_filter->restoreScheduler()) return;
+
+    FFBDeviceSnapshotPtr snap =
+        FFBStateRegistry::instance().snapshot(m_filter->registryDevice());
+    auto pool = std::make_unique<FFBPrewarmPool>(m_filter->deviceName());
+
+    // No data format is set yet, so the effects are created empty; the
+    // pool sets their parameters at the first Acquire.
+    size_t built = 0;
+    auto build = [&](const EffectStateRecord& rec) {
+        if (!rec.wasRunning || !m_filter->isEffectAllowed(rec.kind)) return;
+        IDirectInputEffect* real = nullptr;
+        HRESULT hr = m_real->CreateEffect(rec.guid, nullptr, &real, nullptr);
+        if (FAILED(hr) || !real) {
+            LOG_DEBUG("FFB [%ls] Prewarm: CreateEffect %s failed: 0x%08lx",
+                      m_filter->deviceName().c_str(), effectKindName(rec.kind), hr);
+            return;
+        }
+        auto* effect = new WrapperEffect(real, m_filter);
+        if (effect->instanceId().ordinal != rec.ordinal) {
+            // A gap in the old ordinals; the game's own CreateEffect covers it.
+            effect->Release();
+            return;
+        }
+        pool->add(effect, rec);
+        ++built;
+    };
+    for (const EffectStateRecord& rec : snap->dense)  build(rec);
+    for (const EffectStateRecord& rec : snap->sparse) build(rec);
+
+    if (built == 0) return;
+    LOG_INFO("FFB [%ls] Prewarm: %zu effects built ahead of the game",
+             m_filter->deviceName().c_str(), built);
+    m_prewarm = std::move(pool);
+}
+
 // ============================================================================
 // IUnknown
 // ============================================================================
@@ -72,6 +113,69 @@ ULONG STDMETHODCALLTYPE WrapperDevice8<U>::Release() {
     return c;
 }
 
+// ============================================================================
+// Lost-input recovery
+// ============================================================================
+
+// Feeds an input call's result to m_health. While the device is lost it is
+// re-acquired (at most once per DeviceHealth retry interval) and the call is
+// repeated, so the game gets data on the frame the device comes back.
+template<bool U>
+template<typename Call>
+HRESULT WrapperDevice8<U>::watchInput(Call&& call) {
+    HRESULT hr = call();
+    if (SUCCEEDED(hr) && m_health.state() == DeviceHealth::State::Healthy)
+        return hr;
+
+    m_filter->syncConfig();   // AutoReacquire may have been edited
+    ULONGLONG now = GetTickCount64();
+    switch (m_health.onInput(hr, now)) {
+    case DeviceHealth::Event::Lost:
+        LOG_WARN("[%ls] Input lost (0x%08lx)%s", m_filter->deviceName().c_str(), hr,
+                 m_filter->autoReacquire() ? ", re-acquiring" : "");
+        break;
+    case DeviceHealth::Event::Recovered:
+        onInputRecovered();
+        return hr;
+    default:
+        break;
+    }
+
+    if (FAILED(hr) && m_filter->autoReacquire() && m_health.shouldReacquire(now)) {
+        HRESULT acquired = m_real->Acquire();
+        if (m_health.onAcquire(acquired, GetTickCount64()) == DeviceHealth::Event::Recovered) {
+            onInputRecovered();
+            hr = call();
+        }
+    }
+    return hr;
+}
+
+// The device object survived the outage but the hardware lost its effects;
+// restart the ones the registry still has as running.
+template<bool U>
+void WrapperDevice8<U>::onInputRecovered() {
+    LOG_INFO("[%ls] Input back after %llu ms (%u acquire attempts)",
+             m_filter->deviceName().c_str(), m_health.lastOutageMs(),
+             m_health.lastAttempts());
+
+    auto* restore = m_filter->restoreScheduler();
+    if (!restore) return;
+
+    FFBDeviceSnapshotPtr snap =
+        FFBStateRegistry::instance().snapshot(m_filter->registryDevice());
+    if (snap->paused) {
+        HRESULT pauseHr = m_real->SendForceFeedbackCommand(DISFFC_PAUSE);
+        LOG_INFO("FFB [%ls] Auto-restart: re-pausing device (0x%08lx)",
+                 m_filter->deviceName().c_str(), pauseHr);
+    }
+
+    size_t queued = restore->scheduleRunning(*snap);
+    if (queued)
+        LOG_INFO("FFB [%ls] Auto-restart of %zu effects queued after lost input",
+                 m_filter->deviceName().c_str(), queued);
+}
+
 // ============================================================================
 // Simple pass-through methods
 // ============================================================================
@@ -127,24 +231,39 @@ HRESULT STDMETHODCALLTYPE WrapperDevice8<U>::SetProperty(
 
 template<bool U>
 HRESULT STDMETHODCALLTYPE WrapperDevice8<U>::Acquire() {
-    return m_real->Acquire();
+    HRESULT hr = m_real->Acquire();
+    if (m_health.onAcquire(hr, GetTickCount64()) == DeviceHealth::Event::Recovered)
+        onInputRecovered();
+    // Data format and cooperative level are set now: download the pool.
+    if (SUCCEEDED(hr) && m_prewarm)
+        m_prewarm->prepare();
+    return hr;
 }
 
 template<bool U>
 HRESULT STDMETHODCALLTYPE WrapperDevice8<U>::Unacquire() {
+    // Queued Stop/commands need the device acquired; let them land first.
+    if (auto* worker = m_filter->worker())
+        worker->waitIdle();
+    m_health.onUnacquire();   // NOTACQUIRED from now on is the game's choice
     return m_real->Unacquire();
 }
 
 template<bool U>
 HRESULT STDMETHODCALLTYPE WrapperDevice8<U>::GetDeviceState(DWORD cbData, LPVOID lpvData) {
-    return m_real->GetDeviceState(cbData, lpvData);
+    return watchInput([&] { return m_real->GetDeviceState(cbData, lpvData); });
 }
 
 template<bool U>
 HRESULT STDMETHODCALLTYPE WrapperDevice8<U>::GetDeviceData(
     DWORD cbObjectData, LPDIDEVICEOBJECTDATA rgdod, LPDWORD pdwInOut, DWORD dwFlags)
 {
-    return m_real->GetDeviceData(cbObjectData, rgdod, pdwInOut, dwFlags);
+    // A retry after re-acquiring must see the caller's buffer size again.
+    const DWORD inOut = pdwInOut ? *pdwInOut : 0;
+    return watchInput([&] {
+        if (pdwInOut) *pdwInOut = inOut;
+        return m_real->GetDeviceData(cbObjectData, rgdod, pdwInOut, dwFlags);
+    });
 }
 
 template<bool U>
@@ -193,7 +312,7 @@ HRESULT STDMETHODCALLTYPE WrapperDevice8<U>::Escape(LPDIEFFESCAPE pesc) {
 
 template<bool U>
 HRESULT STDMETHODCALLTYPE WrapperDevice8<U>::Poll() {
-    return m_real->Poll();
+    return watchInput([&] { return m_real->Poll(); });
 }
 
 template<bool U>
@@ -245,76 +364,85 @@ template<bool U>
 HRESULT STDMETHODCALLTYPE WrapperDevice8<U>::CreateEffect(
     REFGUID rguid, LPCDIEFFECT lpeff, LPDIRECTINPUTEFFECT* ppdeff, LPUNKNOWN punkOuter)
 {
-    m_filter->logEffectCreation(rguid);
+    // Resolve the effect type once; everything below indexes by kind.
+    const EffectKind kind = effectKindFromGuid(rguid);
+    m_filter->syncConfig();
+    m_filter->logEffectCreation(kind);
 
     if (!ppdeff) return E_POINTER;
 
-    // Try to create the real effect on the underlying device
-    IDirectInputEffect* realEffect = nullptr;
-    HRESULT hr = m_real->CreateEffect(rguid, lpeff, &realEffect, punkOuter);
+    // An effect type blocked by a [FFBDevices] entry never reaches the
+    // device: the game gets a silent stub and no download slot is used.
+    if (m_filter->isFFBAllowed() && !m_filter->isEffectAllowed(kind)) {
+        auto* nullEffect = new WrapperEffect(rguid, m_filter);
+        *ppdeff = nullEffect;
+        m_filter->trace(FFBTraceMethod::CreateEffect, kind, nullEffect->serial(), DI_OK, lpeff);
+        return DI_OK;
+    }
+
+    // A queued RESET must not wipe the effect we are about to create.
+    if (auto* worker = m_filter->worker())
+        worker->waitIdle();
+
+    // A pre-built effect stands in for the real CreateEffect; the game's
+    // parameters only reach the device if they differ from the recorded ones.
+    HRESULT hr = DI_OK;
+    WrapperEffect* wrapper = nullptr;
+    if (m_prewarm && !punkOuter && (wrapper = m_prewarm->take(kind, rguid)) != nullptr) {
+        if (lpeff)
+            hr = wrapper->restoreParams(lpeff, WrapperEffect::paramFlagsFor(*lpeff));
+        if (FAILED(hr)) {
+            wrapper->Release();
+            wrapper = nullptr;
+        } else if (auto* restore = m_filter->restoreScheduler()) {
+            restore->noteReconnect(m_prewarm->createdAt());
+        }
+    }
+
+    // Otherwise create the real effect on the underlying device
+    if (!wrapper) {
+        IDirectInputEffect* realEffect = nullptr;
+        hr = m_real->CreateEffect(rguid, lpeff, &realEffect, punkOuter);
+        if (SUCCEEDED(hr) && realEffect)
+            wrapper = new WrapperEffect(realEffect, m_filter);   // wrap with our filter
+    }
 
-    if (SUCCEEDED(hr) && realEffect) {
-        // Wrap the real effect with our filter
-        auto* wrapper = new WrapperEffect(realEffect, m_filter);
+    if (wrapper) {
         *ppdeff = wrapper;
+        m_filter->trace(FFBTraceMethod::CreateEffect, kind, wrapper->serial(), hr, lpeff);
+
+        // Creation parameters count as the effect's first SetParameters.
+        FFBStateRegistry& registry = FFBStateRegistry::instance();
+        if (lpeff)
+            registry.recordParams(m_filter->registryDevice(), wrapper->instanceId(), lpeff);
 
         // --- Auto-restart: check if this effect was previously running ---
-        if (Config::instance().ffbAutoRestart && m_filter->isFFBAllowed()) {
-            auto& registry = FFBStateRegistry::instance();
-            DWORD iterations = 0, startFlags = 0;
-            if (registry.wasRunning(m_filter->deviceName(), rguid,
-                                    iterations, startFlags))
+        if (auto* restore = m_filter->restoreScheduler()) {
+            FFBDeviceSnapshotPtr snap = registry.snapshot(m_filter->registryDevice());
+            // Same type and creation ordinal as this effect's predecessor.
+            const EffectStateRecord* found = snap->find(wrapper->instanceId());
+            if (found && found->wasRunning)
             {
-                LOG_INFO("FFB [%ls] Auto-restarting %s after reconnect"
+                LOG_INFO("FFB [%ls] Auto-restart of %s#%u queued"
                          " (iterations=%lu flags=0x%lx)",
                          m_filter->deviceName().c_str(),
-                         FFBFilter::effectGuidToString(rguid),
-                         iterations, startFlags);
-
-                // Replay last-known parameters if available
-                const auto* record = registry.getRecord(
-                    m_filter->deviceName(), rguid);
-                if (record && record->hasParams) {
-                    DIEFFECT paramsCopy = record->params;
-                    paramsCopy.dwSize = sizeof(DIEFFECT);
-
-                    // Build DIEP flags dynamically — only include flags for
-                    // fields that are actually populated, otherwise DI
-                    // returns E_INVALIDARG.
-                    DWORD setFlags = DIEP_NODOWNLOAD;  // don't auto-download yet
-                    if (paramsCopy.dwDuration)   setFlags |= DIEP_DURATION;
-                    if (paramsCopy.dwGain)       setFlags |= DIEP_GAIN;
-                    if (paramsCopy.dwSamplePeriod) setFlags |= DIEP_SAMPLEPERIOD;
-                    if (paramsCopy.dwStartDelay) setFlags |= DIEP_STARTDELAY;
-                    if (paramsCopy.cAxes > 0 && paramsCopy.rgdwAxes)
-                        setFlags |= DIEP_AXES | DIEP_DIRECTION;
-                    if (paramsCopy.cbTypeSpecificParams > 0 &&
-                        paramsCopy.lpvTypeSpecificParams)
-                        setFlags |= DIEP_TYPESPECIFICPARAMS;
-                    if (paramsCopy.lpEnvelope)
-                        setFlags |= DIEP_ENVELOPE;
-
-                    LOG_DEBUG("FFB [%ls] Auto-restart SetParameters flags=0x%lx"
-                              " axes=%lu typeSpec=%lu envelope=%s",
-                              m_filter->deviceName().c_str(), setFlags,
-                              paramsCopy.cAxes,
-                              paramsCopy.cbTypeSpecificParams,
-                              paramsCopy.lpEnvelope ? "yes" : "no");
-
-                    HRESULT spHr = realEffect->SetParameters(
-                        &paramsCopy, setFlags);
-                    if (FAILED(spHr)) {
-                        LOG_WARN("FFB [%ls] Auto-restart SetParameters failed: 0x%08lx",
-                                 m_filter->deviceName().c_str(), spHr);
-                    }
+                         effectKindName(kind), found->ordinal,
+                         found->lastIterations, found->lastStartFlags);
+
+                // The device was paused when it went away: pause the new
+                // one (once) so the effect resumes only on CONTINUE.
+                if (snap->paused && !InterlockedExchange(&m_pauseReplayed, 1)) {
+                    HRESULT pauseHr = m_real->SendForceFeedbackCommand(DISFFC_PAUSE);
+                    LOG_INFO("FFB [%ls] Auto-restart: re-pausing device (0x%08lx)",
+                             m_filter->deviceName().c_str(), pauseHr);
                 }
 
-                // Auto-start the effect
-                HRESULT startHr = realEffect->Start(iterations, startFlags);
-                if (FAILED(startHr)) {
-                    LOG_WARN("FFB [%ls] Auto-restart Start failed: 0x%08lx",
-                             m_filter->deviceName().c_str(), startHr);
-                }
+                // Parameters, download, start and verification run on the
+                // restore thread; the game's device re-init is not held up.
+                // Created with parameters: those are already on the device.
+                EffectStateRecord record = *found;
+                if (lpeff) record.hasParams = false;
+                restore->schedule(wrapper, record, snap->paused);
             }
         }
 
@@ -325,12 +453,15 @@ HRESULT STDMETHODCALLTYPE WrapperDevice8<U>::CreateEffect(
     // return a null-effect so the caller doesn't see an error.
     if (!m_filter->isFFBAllowed()) {
         LOG_DEBUG("Real CreateEffect failed (hr=0x%08lx) but FFB blocked — returning null effect", hr);
-        *ppdeff = new WrapperEffect(rguid, m_filter);
+        auto* nullEffect = new WrapperEffect(rguid, m_filter);
+        *ppdeff = nullEffect;
+        m_filter->trace(FFBTraceMethod::CreateEffect, kind, nullEffect->serial(), DI_OK, lpeff);
         return DI_OK;
     }
 
     // Otherwise propagate the real error
     *ppdeff = nullptr;
+    m_filter->trace(FFBTraceMethod::CreateEffect, kind, 0, hr, lpeff);
     return hr;
 }
 
@@ -352,17 +483,89 @@ HRESULT STDMETHODCALLTYPE WrapperDevice8<U>::GetForceFeedbackState(LPDWORD pdwOu
         if (pdwOut) *pdwOut = 0;
         return DI_OK;
     }
-    return m_real->GetForceFeedbackState(pdwOut);
+
+    HRESULT hr = DI_OK;
+    uint32_t source = kFFBTraceStatusDevice;
+    DWORD maxAge = m_filter->statusMaxAgeMs();
+    if (!maxAge || !pdwOut) {
+        hr = m_real->GetForceFeedbackState(pdwOut);
+    } else {
+        DeviceStateShadow& shadow = m_filter->stateShadow();
+        DWORD flags = 0;
+        ShadowFreshness f = shadow.query(flags, GetTickCount64(), maxAge);
+        if (f == ShadowFreshness::Stale && m_filter->asyncCommands()) {
+            if (!InterlockedExchange(&m_stateRefreshQueued, 1))
+                m_filter->worker()->enqueue(&WrapperDevice8::runStateRefresh, this, 0, 0,
+                                            FFBTraceMethod::GetForceFeedbackState);
+            f = ShadowFreshness::Fresh;   // until the refresh lands, or Expired
+        }
+        if (f == ShadowFreshness::Fresh) {
+            *pdwOut = flags;
+            source = kFFBTraceStatusShadow;
+        } else {
+            if (auto* worker = m_filter->worker())
+                worker->waitIdle();   // report the state after our queued commands
+            hr = m_real->GetForceFeedbackState(pdwOut);
+            if (SUCCEEDED(hr))
+                shadow.onDeviceState(*pdwOut, GetTickCount64());
+        }
+    }
+
+    m_filter->trace(FFBTraceMethod::GetForceFeedbackState, EffectKind::Unknown, 0, hr,
+                    nullptr, source, (SUCCEEDED(hr) && pdwOut) ? *pdwOut : 0);
+    return hr;
+}
+
+// Background resync of a stale state shadow; a failure is not the game's.
+template<bool U>
+HRESULT WrapperDevice8<U>::runStateRefresh(void* self, DWORD, DWORD) {
+    auto* dev = static_cast<WrapperDevice8*>(self);
+    DWORD flags = 0;
+    HRESULT hr = dev->m_real->GetForceFeedbackState(&flags);
+    if (SUCCEEDED(hr))
+        dev->m_filter->stateShadow().onDeviceState(flags, GetTickCount64());
+    InterlockedExchange(&dev->m_stateRefreshQueued, 0);
+    return hr;
 }
 
 template<bool U>
 HRESULT STDMETHODCALLTYPE WrapperDevice8<U>::SendForceFeedbackCommand(DWORD dwFlags) {
+    m_filter->syncConfig();
     m_filter->logCommand(dwFlags);
 
-    if (!m_filter->isFFBAllowed()) {
-        return DI_OK;  // silently swallow
+    // Bulk state change for auto-restart (STOPALL'd effects stay stopped)
+    FFBStateRegistry::instance().recordCommand(m_filter->registryDevice(), dwFlags);
+    if (FFBSlotManager* slots = m_filter->slots())
+        slots->noteCommand(dwFlags);
+    m_filter->stateShadow().onCommand(dwFlags);
+
+    HRESULT hr = DI_OK;  // blocked: silently swallow
+    if (m_filter->isFFBAllowed()) {
+        if (m_filter->asyncCommands()) {
+            // Optimistic DI_OK; a failure is returned by the next command.
+            hr = static_cast<HRESULT>(InterlockedExchange(&m_deferredError, DI_OK));
+            m_filter->worker()->enqueue(&WrapperDevice8::runSendCommand, this,
+                                        dwFlags, 0, FFBTraceMethod::SendCommand);
+        } else {
+            hr = m_real->SendForceFeedbackCommand(dwFlags);
+            if (FAILED(hr))
+                m_filter->stateShadow().invalidate();
+        }
     }
-    return m_real->SendForceFeedbackCommand(dwFlags);
+
+    m_filter->trace(FFBTraceMethod::SendCommand, EffectKind::Unknown, 0, hr, nullptr, dwFlags);
+    return hr;
+}
+
+template<bool U>
+HRESULT WrapperDevice8<U>::runSendCommand(void* self, DWORD dwFlags, DWORD) {
+    auto* dev = static_cast<WrapperDevice8*>(self);
+    HRESULT hr = dev->m_real->SendForceFeedbackCommand(dwFlags);
+    if (FAILED(hr)) {
+        InterlockedExchange(&dev->m_deferredError, hr);
+        dev->m_filter->stateShadow().invalidate();   // it assumed the command landed
+    }
+    return hr;
 }
 
 template<bool U>
@@ -5,8 +5,9 @@
 // WrapperDevice8<Unicode>
 //
 // Wraps IDirectInputDevice8A (Unicode=false) or IDirectInputDevice8W (Unicode=true).
-// Intercepts FFB-related calls (CreateEffect, SendForceFeedbackCommand) and
-// delegates everything else to the real device.
+// Intercepts FFB-related calls (CreateEffect, SendForceFeedbackCommand),
+// watches Acquire and the input calls for a device dropping out (see
+// DeviceHealth) and delegates everything else to the real device.
 //
 #include <windows.h>
 #include <dinput.h>
@@ -14,8 +15,10 @@
 #include <string>
 #include <type_traits>
 
+#include "device_health.h"
 #include "ffb_filter.h"
 
+class FFBPrewarmPool;
 class WrapperEffect;
 
 template<bool Unicode>
@@ -38,6 +41,10 @@ public:
     WrapperDevice8(Base* real, std::shared_ptr<FFBFilter> filter);
     virtual ~WrapperDevice8();
 
+    // Called by CreateDevice: with [FFB] Prewarm, build the effects the
+    // registry has as running for this device (see FFBPrewarmPool).
+    void prewarmEffects();
+
     // ---- IUnknown ----
     HRESULT STDMETHODCALLTYPE QueryInterface(REFIID riid, void** ppvObj) override;
     ULONG   STDMETHODCALLTYPE AddRef() override;
@@ -83,9 +90,25 @@ public:
     HRESULT STDMETHODCALLTYPE WriteEffectToFile(const Char* lpszFileName, DWORD dwEntries, LPDIFILEEFFECT rgDiFileEft, DWORD dwFlags) override;
 
 private:
+    // Worker-thread half of an async SendForceFeedbackCommand.
+    static HRESULT runSendCommand(void* self, DWORD dwFlags, DWORD);
+    // Worker-thread refresh of a stale GetForceFeedbackState shadow.
+    static HRESULT runStateRefresh(void* self, DWORD, DWORD);
+
+    // Run an input call, track lost input and re-acquire if allowed.
+    template<typename Call>
+    HRESULT watchInput(Call&& call);
+    // The device is readable again after an outage: restart its effects.
+    void onInputRecovered();
+
     Base*                      m_real;
     std::shared_ptr<FFBFilter> m_filter;
     volatile LONG              m_refCount = 1;
+    volatile LONG              m_deferredError = DI_OK;   // failed async command
+    volatile LONG              m_pauseReplayed = 0;       // auto-restart sent DISFFC_PAUSE
+    volatile LONG              m_stateRefreshQueued = 0;  // runStateRefresh pending
+    DeviceHealth               m_health;
+    std::unique_ptr<FFBPrewarmPool> m_prewarm;            // nullptr unless prewarming
 };
 
 using WrapperDevice8A = WrapperDevice8<false>;
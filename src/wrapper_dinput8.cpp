@@ -3,7 +3,9 @@
 #include "wrapper_dinput8.h"
 #include "wrapper_device8.h"
 #include "ffb_filter.h"
+#include "ffb_state_registry.h"
 #include "config.h"
+#include "device_identity.h"
 #include "logger.h"
 #include <memory>
 #include <string>
@@ -70,27 +72,33 @@ ULONG STDMETHODCALLTYPE WrapperDirectInput8<U>::Release() {
 // CreateDevice — the main interception point
 // ============================================================================
 
-// Helper: query device product name (wide string) from a real device.
-static std::wstring queryDeviceName(IDirectInputDevice8W* dev) {
+// Helpers: fill a device identity from GetDeviceInfo (product name as wide
+// string). Only called the first time a device GUID is seen.
+static bool queryDeviceIdentity(IDirectInputDevice8W* dev, DeviceIdentity& out) {
     DIDEVICEINSTANCEW di{};
     di.dwSize = sizeof(di);
-    if (SUCCEEDED(dev->GetDeviceInfo(&di)))
-        return di.tszProductName;
-    return L"<unknown>";
+    if (FAILED(dev->GetDeviceInfo(&di))) return false;
+    out.instanceGuid = di.guidInstance;
+    out.productGuid  = di.guidProduct;
+    out.productName  = di.tszProductName;
+    out.decodeVidPid();
+    return true;
 }
 
-static std::wstring queryDeviceName(IDirectInputDevice8A* dev) {
+static bool queryDeviceIdentity(IDirectInputDevice8A* dev, DeviceIdentity& out) {
     DIDEVICEINSTANCEA di{};
     di.dwSize = sizeof(di);
-    if (SUCCEEDED(dev->GetDeviceInfo(&di))) {
-        // Convert narrow product name to wide for consistent policy lookup
-        int len = MultiByteToWideChar(CP_ACP, 0, di.tszProductName, -1, nullptr, 0);
-        std::wstring ws(len, L'\0');
-        MultiByteToWideChar(CP_ACP, 0, di.tszProductName, -1, ws.data(), len);
-        if (!ws.empty() && ws.back() == L'\0') ws.pop_back();
-        return ws;
-    }
-    return L"<unknown>";
+    if (FAILED(dev->GetDeviceInfo(&di))) return false;
+    out.instanceGuid = di.guidInstance;
+    out.productGuid  = di.guidProduct;
+    // Convert narrow product name to wide for consistent policy lookup
+    int len = MultiByteToWideChar(CP_ACP, 0, di.tszProductName, -1, nullptr, 0);
+    std::wstring ws(len, L'\0');
+    MultiByteToWideChar(CP_ACP, 0, di.tszProductName, -1, ws.data(), len);
+    if (!ws.empty() && ws.back() == L'\0') ws.pop_back();
+    out.productName = std::move(ws);
+    out.decodeVidPid();
+    return true;
 }
 
 template<bool U>
@@ -113,26 +121,50 @@ HRESULT STDMETHODCALLTYPE WrapperDirectInput8<U>::CreateDevice(
         return hr;
     }
 
-    // Query name and resolve FFB policy
-    std::wstring name = queryDeviceName(realDevice);
-
-    bool ffbEnabled = true;
-    int  ffbScale   = 100;
-    Config::instance().getDevicePolicy(name.c_str(), ffbEnabled, ffbScale);
-
-    LOG_INFO("CreateDevice: [%ls]  FFB=%s  scale=%d%%",
-             name.c_str(),
-             ffbEnabled ? "allowed" : "BLOCKED",
-             ffbScale);
-
-    FFBPolicy policy;
-    policy.enabled = ffbEnabled;
-    policy.scale   = ffbScale;
+    // Resolve the device's identity once per GUID; a re-created device
+    // reuses it without querying the device again.
+    auto& identities = DeviceIdentityTable::instance();
+    DeviceIdentityPtr identity = identities.find(rguid);
+    if (!identity) {
+        DeviceIdentity fresh;
+        fresh.instanceGuid = rguid;
+        if (queryDeviceIdentity(realDevice, fresh)) {
+            identity = identities.insert(rguid, std::move(fresh));
+        } else {
+            fresh.productName = L"<unknown>";
+            identity = std::make_shared<const DeviceIdentity>(std::move(fresh));
+        }
+    }
 
-    auto filter = std::make_shared<FFBFilter>(policy, name);
+    // Resolve FFB policy from the newest (possibly reloaded) ini
+    FFBPolicy policy = FFBFilter::resolvePolicy(Config::current(), *identity);
+
+    const GUID& g = identity->instanceGuid;
+    LOG_INFO("CreateDevice: [%ls]  VID_%04X&PID_%04X  FFB=%s  scale=%d%%",
+             identity->productName.c_str(), identity->vendorId, identity->productId,
+             policy.enabled ? "allowed" : "BLOCKED", policy.scale);
+    if (policy.enabled && policy.curve)
+        LOG_INFO("CreateDevice: [%ls]  response curve: %s (%s)",
+                 identity->productName.c_str(), policy.curve->name().c_str(),
+                 policy.curve->describe().c_str());
+    std::string types = FFBFilter::describeEffectPolicy(policy);
+    if (policy.enabled && !types.empty())
+        LOG_INFO("CreateDevice: [%ls]  effect types: %s",
+                 identity->productName.c_str(), types.c_str());
+    LOG_DEBUG("CreateDevice: [%ls]  instance {%08lX-%04X-%04X-%02X%02X-%02X%02X%02X%02X%02X%02X}",
+              identity->productName.c_str(), g.Data1, g.Data2, g.Data3,
+              g.Data4[0], g.Data4[1], g.Data4[2], g.Data4[3],
+              g.Data4[4], g.Data4[5], g.Data4[6], g.Data4[7]);
+
+    // Intern the identity once; the registry hot path then works on the handle.
+    FFBDeviceHandle registryDevice = FFBStateRegistry::instance().internDevice(*identity);
+
+    auto filter = std::make_shared<FFBFilter>(policy, identity, registryDevice);
 
     // Wrap the device
-    *lplpDevice = new WrapperDevice8<U>(realDevice, filter);
+    auto* device = new WrapperDevice8<U>(realDevice, filter);
+    device->prewarmEffects();   // [FFB] Prewarm: a known device is back
+    *lplpDevice = device;
     return hr;
 }
 
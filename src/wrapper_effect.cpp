@@ -8,27 +8,77 @@
 // ---------------------------------------------------------------------------
 // Construction / destruction
 // ---------------------------------------------------------------------------
+static volatile LONG s_nextSerial = 0;
+
+// Condition effects carry one DICONDITION per axis; reserve room for this many
+// up front. Larger arrays grow the scratch once and then stay allocated.
+static constexpr DWORD kScratchConditionAxes = 4;
+
+static size_t scratchBytesFor(EffectKind kind) {
+    const auto& info = effectKindInfo(kind);
+    if (info.category == EffectCategory::Condition)
+        return info.typeSpecificSize * kScratchConditionAxes;
+    return info.typeSpecificSize;
+}
+
 WrapperEffect::WrapperEffect(IDirectInputEffect* real, std::shared_ptr<FFBFilter> filter)
     : m_real(real)
     , m_filter(std::move(filter))
     , m_guid{}
+    , m_kind(EffectKind::Unknown)
+    , m_serial(static_cast<uint32_t>(InterlockedIncrement(&s_nextSerial)))
+    , m_lastSent(EffectKind::Unknown)
+    , m_pending(EffectKind::Unknown)
+    , m_flushing(EffectKind::Unknown)
 {
     if (m_real) m_real->GetEffectGuid(&m_guid);
-    LOG_DEBUG("WrapperEffect created (real=%p) for [%ls]",
-              m_real, m_filter->deviceName().c_str());
+    m_kind = effectKindFromGuid(m_guid);
+    m_ordinal = m_filter->acquireOrdinal(m_kind, m_guid);
+    m_scratch.typeSpecific.resize(scratchBytesFor(m_kind));
+    m_lastSent = EffectParamCache(m_kind);
+
+    if (m_real && (m_worker = m_filter->worker()) != nullptr) {
+        m_pending  = EffectParamCache(m_kind);
+        m_flushing = EffectParamCache(m_kind);
+        m_worker->add(this);
+    }
+    FFBRestoreScheduler* restore = m_filter->restoreScheduler();
+    if (m_real && restore)
+        restore->add(this);          // restarted if the device drops out
+    FFBSlotManager* slots = m_filter->slots();
+    if (m_real && slots)
+        slots->add(this);            // eviction candidate when the device is full
+    LOG_DEBUG("WrapperEffect created (real=%p) for [%ls] %s#%u",
+              m_real, m_filter->deviceName().c_str(), effectKindName(m_kind), m_ordinal);
 }
 
 WrapperEffect::WrapperEffect(REFGUID effectGuid, std::shared_ptr<FFBFilter> filter)
     : m_real(nullptr)
     , m_filter(std::move(filter))
     , m_guid(effectGuid)
+    , m_kind(effectKindFromGuid(effectGuid))
+    , m_serial(static_cast<uint32_t>(InterlockedIncrement(&s_nextSerial)))
+    , m_lastSent(m_kind)
+    , m_pending(m_kind)
+    , m_flushing(m_kind)
 {
-    LOG_DEBUG("WrapperEffect created (NULL-effect) for [%ls]",
-              m_filter->deviceName().c_str());
+    m_ordinal = m_filter->acquireOrdinal(m_kind, m_guid);
+    LOG_DEBUG("WrapperEffect created (NULL-effect) for [%ls] %s#%u",
+              m_filter->deviceName().c_str(), effectKindName(m_kind), m_ordinal);
 }
 
 WrapperEffect::~WrapperEffect() {
     LOG_DEBUG("WrapperEffect destroyed for [%ls]", m_filter->deviceName().c_str());
+    if (auto* restore = m_filter->restoreScheduler())
+        restore->remove(this);       // a queued restart still points at us
+    if (m_worker) {
+        m_worker->waitIdle();        // queued commands still point at us
+        m_worker->remove(this);      // waits out a flush pass in progress
+        flushPending();              // the game's last update still goes out
+    }
+    if (FFBSlotManager* slots = m_filter->slots())
+        slots->remove(this);         // after the last flush, which may download
+    m_filter->releaseOrdinal(m_kind, m_guid, m_ordinal);
     if (m_real) m_real->Release();
 }
 
@@ -81,71 +131,511 @@ HRESULT STDMETHODCALLTYPE WrapperEffect::GetParameters(LPDIEFFECT peff, DWORD dw
         if (peff) std::memset(peff, 0, sizeof(DIEFFECT));
         return DI_OK;
     }
+    waitForCommands();
+    flushPending();   // report what the game last set
     return m_real->GetParameters(peff, dwFlags);
 }
 
+const DIEFFECT* WrapperEffect::buildScaledParams(LPCDIEFFECT peff, DWORD dwFlags) {
+    DIEFFECT& eff = m_scratch.effect;
+    eff = *peff;
+
+    // Axes and directions are only read, so they keep pointing at the caller.
+    // The envelope and type-specific block are copied (and scaled) only when
+    // dwFlags names them; otherwise the device ignores them and the game may
+    // have left the pointers dangling.
+    eff.lpEnvelope = nullptr;
+    if ((dwFlags & DIEP_ENVELOPE) && peff->lpEnvelope) {
+        m_scratch.envelope = *peff->lpEnvelope;
+        eff.lpEnvelope = &m_scratch.envelope;
+    }
+
+    if (!(dwFlags & DIEP_TYPESPECIFICPARAMS)) {
+        eff.lpvTypeSpecificParams = nullptr;
+        eff.cbTypeSpecificParams  = 0;
+    }
+
+    // Unknown effect types are not scaled, so their block is passed as-is.
+    EffectCategory category = effectKindCategory(m_kind);
+    if (category != EffectCategory::None &&
+        eff.lpvTypeSpecificParams && eff.cbTypeSpecificParams > 0)
+    {
+        auto& block = m_scratch.typeSpecific;
+        if (block.size() < peff->cbTypeSpecificParams)
+            block.resize(peff->cbTypeSpecificParams);   // one-time growth
+        std::memcpy(block.data(), peff->lpvTypeSpecificParams,
+                    peff->cbTypeSpecificParams);
+        eff.lpvTypeSpecificParams = block.data();
+
+        // DICUSTOMFORCE points at the sample data; copy that too.
+        if (category == EffectCategory::Custom &&
+            peff->cbTypeSpecificParams >= sizeof(DICUSTOMFORCE))
+        {
+            auto* cf = reinterpret_cast<DICUSTOMFORCE*>(block.data());
+            if (cf->rglForceData) {
+                size_t n = static_cast<size_t>(cf->cSamples) * cf->cChannels;
+                auto& samples = m_scratch.customSamples;
+                if (samples.size() < n)
+                    samples.resize(n);                  // one-time growth
+                std::memcpy(samples.data(), cf->rglForceData, n * sizeof(LONG));
+                cf->rglForceData = samples.data();
+            }
+        }
+    }
+
+    m_filter->scaleEffect(&eff, m_kind);
+    if (m_rampPermille < kRampFull)
+        eff.dwGain = static_cast<DWORD>(static_cast<uint64_t>(eff.dwGain) *
+                                        m_rampPermille / kRampFull);
+    return &eff;
+}
+
+template<typename Call>
+HRESULT WrapperEffect::withSlot(Call&& call) {
+    HRESULT hr = call();
+    FFBSlotManager* slots = m_filter->slots();
+    for (unsigned i = 0; hr == DIERR_DEVICEFULL && slots &&
+                         i < FFBSlotManager::kMaxEvictionsPerCall; ++i)
+    {
+        if (!slots->evictFor(this)) break;
+        hr = call();
+    }
+    return hr;
+}
+
+// Only DI_OK means the effect is on the device; DI_DOWNLOADSKIPPED and
+// friends are successes that leave it off.
+HRESULT WrapperEffect::forwardDownload() {
+    AcquireSRWLockExclusive(&m_forwardLock);
+    takeEvictionLocked();
+    HRESULT hr = withSlot([&] { return m_real->Download(); });
+    if (SUCCEEDED(hr))
+        m_lastSent.setDownloaded(true);   // DIEP_NODOWNLOAD values are on the device now
+    ReleaseSRWLockExclusive(&m_forwardLock);
+    FFBSlotManager* slots = m_filter->slots();
+    if (slots && (hr == DI_OK || hr == S_FALSE))   // S_FALSE: already downloaded
+        slots->noteDownloaded(this, false);
+    return hr;
+}
+
+HRESULT WrapperEffect::forwardStart(DWORD iterations, DWORD flags) {
+    HRESULT hr = withSlot([&] { return m_real->Start(iterations, flags); });
+    FFBSlotManager* slots = m_filter->slots();
+    if (slots && hr == DI_OK)
+        slots->noteDownloaded(this, true);
+    if (SUCCEEDED(hr)) {
+        m_status.onStart(iterations, m_filter->stateShadow().stopEpoch(), GetTickCount64());
+        m_filter->stateShadow().onEffectStarted();
+    }
+    return hr;
+}
+
+HRESULT WrapperEffect::forwardStop() {
+    HRESULT hr = m_real->Stop();
+    FFBSlotManager* slots = m_filter->slots();
+    if (slots && SUCCEEDED(hr))
+        slots->noteStopped(this);
+    if (SUCCEEDED(hr)) {
+        m_status.onStop(GetTickCount64());
+        m_filter->stateShadow().onEffectStopped();
+    }
+    return hr;
+}
+
+void WrapperEffect::onEvicted() {
+    // Unload stops the effect; its parameters stay with the driver but are
+    // off the device, so the game's next identical SetParameters must not be
+    // suppressed: it is what downloads the effect again.
+    m_status.onStop(GetTickCount64());
+    m_filter->stateShadow().onEffectStopped();
+    InterlockedExchange(&m_evicted, 1);
+}
+
+HRESULT WrapperEffect::forwardParamsLocked(LPCDIEFFECT peff, DWORD dwFlags,
+                                           bool& suppressed)
+{
+    // A reloaded policy (new scale) invalidates what the device was sent.
+    uint32_t policyGen = m_filter->policyGeneration();
+    if (policyGen != m_policySeen) {
+        m_lastSent.invalidate();
+        m_policySeen = policyGen;
+    }
+    takeEvictionLocked();
+
+    // Same parameters as last forwarded: the device already has them.
+    suppressed = m_filter->suppressRedundant() &&
+                 m_lastSent.matches(peff, dwFlags, m_filter->paramDeadband());
+    m_filter->countParams(suppressed);
+    if (suppressed) return DI_OK;
+
+    // If scaling or a curve is active, shape a private copy (never the caller's buffers)
+    const DIEFFECT* params = peff;
+    if ((m_filter->shapesForces(m_kind) || m_rampPermille < kRampFull) && peff)
+        params = buildScaledParams(peff, dwFlags);
+    HRESULT hr = withSlot([&] { return m_real->SetParameters(params, dwFlags); });
+    FFBSlotManager* slots = m_filter->slots();
+    if (slots && hr == DI_OK && !(dwFlags & DIEP_NODOWNLOAD))
+        slots->noteDownloaded(this, (dwFlags & DIEP_START) != 0);
+
+    // Timing for the status shadow's end-of-run estimate.
+    if (SUCCEEDED(hr) && peff) {
+        if (dwFlags & DIEP_DURATION)   m_status.setDuration(peff->dwDuration);
+        if (dwFlags & DIEP_STARTDELAY) m_status.setStartDelay(peff->dwStartDelay);
+        if (dwFlags & DIEP_START) {
+            m_status.onStart(1, m_filter->stateShadow().stopEpoch(), GetTickCount64());
+            m_filter->stateShadow().onEffectStarted();
+        }
+    }
+
+    // Cache the unscaled values; a failed call leaves the device state
+    // unknown, so the next call must go through.
+    if (SUCCEEDED(hr))
+        m_lastSent.update(peff, dwFlags);
+    else
+        m_lastSent.invalidate();
+    return hr;
+}
+
+HRESULT WrapperEffect::restoreParams(const DIEFFECT* peff, DWORD dwFlags) {
+    bool suppressed = false;
+    AcquireSRWLockExclusive(&m_forwardLock);
+    HRESULT hr = forwardParamsLocked(peff, dwFlags, suppressed);
+    ReleaseSRWLockExclusive(&m_forwardLock);
+    return hr;
+}
+
+DWORD WrapperEffect::paramFlagsFor(const DIEFFECT& p) {
+    DWORD flags = 0;
+    if (p.dwDuration)     flags |= DIEP_DURATION;
+    if (p.dwGain)         flags |= DIEP_GAIN;
+    if (p.dwSamplePeriod) flags |= DIEP_SAMPLEPERIOD;
+    if (p.dwStartDelay)   flags |= DIEP_STARTDELAY;
+    if (p.cAxes > 0 && p.rgdwAxes)
+        flags |= DIEP_AXES | DIEP_DIRECTION;
+    if (p.cbTypeSpecificParams > 0 && p.lpvTypeSpecificParams)
+        flags |= DIEP_TYPESPECIFICPARAMS;
+    if (p.lpEnvelope)
+        flags |= DIEP_ENVELOPE;
+    return flags;
+}
+
+HRESULT WrapperEffect::stepRamp(LONG permille, DWORD extraFlags) {
+    AcquireSRWLockExclusive(&m_forwardLock);
+    m_rampPermille = permille;
+
+    // Only the gain changes; base it on what the game last had forwarded.
+    DIEFFECT current;
+    m_lastSent.view(current);
+    DIEFFECT gainOnly = {};
+    gainOnly.dwSize = sizeof(DIEFFECT);
+    gainOnly.dwGain = (m_lastSent.fields() & DIEP_GAIN) ? current.dwGain : DI_FFNOMINALMAX;
+
+    // A step may download an evicted effect again, like any SetParameters.
+    takeEvictionLocked();
+    const DIEFFECT* params = buildScaledParams(&gainOnly, DIEP_GAIN);
+    const DWORD flags = DIEP_GAIN | extraFlags;
+    HRESULT hr = withSlot([&] { return m_real->SetParameters(params, flags); });
+    FFBSlotManager* slots = m_filter->slots();
+    if (hr == DI_OK && !(flags & DIEP_NODOWNLOAD)) {
+        m_lastSent.setDownloaded(true);
+        if (slots) slots->noteDownloaded(this, (flags & DIEP_START) != 0);
+    }
+    if (FAILED(hr))
+        m_lastSent.invalidate();   // let the game's next update through in full
+    ReleaseSRWLockExclusive(&m_forwardLock);
+    return hr;
+}
+
+void WrapperEffect::postParams(LPCDIEFFECT peff, DWORD dwFlags) {
+    AcquireSRWLockExclusive(&m_mailboxLock);
+    bool wasPending = m_pending.fields() != 0;
+    m_pending.update(peff, dwFlags);
+    // A merged update may skip the download or restart only if every call
+    // in it asked to; one plain SetParameters must still reach the device.
+    if (wasPending)
+        m_pendingBehavior &= dwFlags;
+    else
+        m_pendingBehavior = dwFlags & (DIEP_NODOWNLOAD | DIEP_NORESTART);
+    ReleaseSRWLockExclusive(&m_mailboxLock);
+
+    if (wasPending)
+        m_filter->countParamsCoalesced();   // rides along with the queued update
+    else
+        m_worker->notify();
+}
+
+HRESULT WrapperEffect::flushPending(DWORD extraFlags) {
+    if (!m_worker) return DI_OK;
+
+    AcquireSRWLockExclusive(&m_forwardLock);
+
+    AcquireSRWLockExclusive(&m_mailboxLock);
+    DWORD fields = m_pending.fields();
+    DWORD behavior = m_pendingBehavior;
+    if (fields) {
+        m_pending.swap(m_flushing);   // buffers trade places, nothing is copied
+        m_pending.invalidate();
+    } else {
+        m_flushing.invalidate();      // DIEP_START alone: forward no fields
+    }
+    ReleaseSRWLockExclusive(&m_mailboxLock);
+
+    HRESULT hr = DI_OK;
+    if (fields || extraFlags) {
+        DIEFFECT eff;
+        m_flushing.view(eff);
+        bool suppressed = false;
+        hr = forwardParamsLocked(&eff, fields | behavior | extraFlags, suppressed);
+        if (FAILED(hr)) {
+            // The game already got DI_OK for this update; tell it next time.
+            deferError(hr);
+            m_filter->countParamsFailed();
+            LOG_DEBUG("[%ls] Coalesced SetParameters failed: 0x%08X",
+                      m_filter->deviceName().c_str(), static_cast<unsigned>(hr));
+        }
+    }
+
+    ReleaseSRWLockExclusive(&m_forwardLock);
+    return hr;
+}
+
+// ---------------------------------------------------------------------------
+// Async commands — run on the device worker thread
+// ---------------------------------------------------------------------------
+void WrapperEffect::deferError(HRESULT hr) {
+    InterlockedExchange(&m_deferredError, hr);
+}
+
+HRESULT WrapperEffect::takeDeferredError() {
+    return static_cast<HRESULT>(InterlockedExchange(&m_deferredError, DI_OK));
+}
+
+void WrapperEffect::enqueue(FFBCommand::Fn fn, DWORD arg0, DWORD arg1,
+                            FFBTraceMethod method)
+{
+    InterlockedIncrement(&m_queuedCommands);
+    m_worker->enqueue(fn, this, arg0, arg1, method);
+}
+
+HRESULT WrapperEffect::finishCommand(HRESULT hr) {
+    if (FAILED(hr)) {
+        deferError(hr);
+        m_status.invalidate();   // the shadow assumed the call would work
+    }
+    InterlockedDecrement(&m_queuedCommands);
+    return hr;
+}
+
+void WrapperEffect::waitForCommands() {
+    if (m_worker && m_queuedCommands > 0)
+        m_worker->waitIdle();
+}
+
+HRESULT WrapperEffect::runSetParamsStart(void* self, DWORD, DWORD) {
+    auto* e = static_cast<WrapperEffect*>(self);
+    HRESULT hr = e->flushPending(DIEP_START);
+    InterlockedDecrement(&e->m_queuedCommands);   // flushPending deferred any error
+    return hr;
+}
+
+HRESULT WrapperEffect::runStart(void* self, DWORD iterations, DWORD flags) {
+    auto* e = static_cast<WrapperEffect*>(self);
+    e->flushPending();   // parameters set before Start must be on the device
+    return e->finishCommand(e->forwardStart(iterations, flags));
+}
+
+HRESULT WrapperEffect::runStop(void* self, DWORD, DWORD) {
+    auto* e = static_cast<WrapperEffect*>(self);
+    e->flushPending();
+    return e->finishCommand(e->forwardStop());
+}
+
+HRESULT WrapperEffect::runDownload(void* self, DWORD, DWORD) {
+    auto* e = static_cast<WrapperEffect*>(self);
+    e->flushPending();
+    return e->finishCommand(e->forwardDownload());
+}
+
+// Background resync of a stale status shadow; a failure is not the game's.
+HRESULT WrapperEffect::runStatusRefresh(void* self, DWORD, DWORD) {
+    auto* e = static_cast<WrapperEffect*>(self);
+    DWORD status = 0;
+    HRESULT hr = e->queryDeviceStatus(&status);
+    InterlockedExchange(&e->m_statusRefreshQueued, 0);
+    InterlockedDecrement(&e->m_queuedCommands);
+    return hr;
+}
+
 HRESULT STDMETHODCALLTYPE WrapperEffect::SetParameters(LPCDIEFFECT peff, DWORD dwFlags) {
+    m_filter->syncConfig();
     m_filter->logEffectParams(peff);
+    noteGameCall(dwFlags & DIEP_START ? kRestoreCancelled | kRestoreParamsStale
+                                      : kRestoreParamsStale);
 
     // Record params for auto-restart on reconnect
     FFBStateRegistry::instance().recordParams(
-        m_filter->deviceName(), m_guid, peff);
-
-    if (!m_filter->isFFBAllowed()) return DI_OK;  // silently swallow
+        m_filter->registryDevice(), instanceId(), peff);
 
-    if (!m_real) return DI_OK;
-
-    // If scaling is active, work on a copy
-    if (m_filter->getScale() < 100 && peff) {
-        DIEFFECT copy = *peff;
-        m_filter->scaleEffect(&copy, m_guid);
-        return m_real->SetParameters(&copy, dwFlags);
+    HRESULT hr = DI_OK;  // blocked or null-effect: silently swallow
+    DWORD outcome = kFFBTraceParamsForwarded;
+    if (m_filter->isFFBAllowed() && m_real) {
+        if (m_worker && peff && !(dwFlags & DIEP_START)) {
+            // Latest wins: the worker forwards it (optimistic DI_OK, or the
+            // error a previous queued call ran into).
+            postParams(peff, dwFlags);
+            hr = takeDeferredError();
+            outcome = kFFBTraceParamsQueued;
+        } else if (m_worker && peff && m_worker->asyncCommands()) {
+            // Start after the update, in order with other queued commands.
+            postParams(peff, dwFlags & ~DIEP_START);
+            hr = takeDeferredError();
+            enqueue(&WrapperEffect::runSetParamsStart, 0, 0, FFBTraceMethod::SetParameters);
+            outcome = kFFBTraceParamsQueued;
+        } else {
+            // DIEP_START must not overtake updates still in the mailbox.
+            flushPending();
+            bool suppressed = false;
+            AcquireSRWLockExclusive(&m_forwardLock);
+            hr = forwardParamsLocked(peff, dwFlags, suppressed);
+            ReleaseSRWLockExclusive(&m_forwardLock);
+            if (suppressed) outcome = kFFBTraceParamsSuppressed;
+        }
     }
 
-    return m_real->SetParameters(peff, dwFlags);
+    m_filter->trace(FFBTraceMethod::SetParameters, m_kind, m_serial, hr, peff,
+                    dwFlags, outcome);
+    return hr;
 }
 
 HRESULT STDMETHODCALLTYPE WrapperEffect::Start(DWORD dwIterations, DWORD dwFlags) {
+    m_filter->syncConfig();
     m_filter->logEffectStart(dwIterations, dwFlags);
+    noteGameCall(kRestoreCancelled);
 
     // Record start for auto-restart on reconnect
     FFBStateRegistry::instance().recordStart(
-        m_filter->deviceName(), m_guid, dwIterations, dwFlags);
+        m_filter->registryDevice(), instanceId(), dwIterations, dwFlags);
 
-    if (!m_filter->isFFBAllowed()) return DI_OK;
-    if (!m_real) return DI_OK;
-    return m_real->Start(dwIterations, dwFlags);
+    HRESULT hr = DI_OK;
+    if (m_filter->isFFBAllowed() && m_real) {
+        if (m_filter->asyncCommands()) {
+            hr = takeDeferredError();
+            enqueue(&WrapperEffect::runStart, dwIterations, dwFlags, FFBTraceMethod::Start);
+        } else {
+            flushPending();   // parameters set before Start must be on the device
+            hr = forwardStart(dwIterations, dwFlags);
+        }
+    }
+
+    m_filter->trace(FFBTraceMethod::Start, m_kind, m_serial, hr, nullptr,
+                    dwIterations, dwFlags);
+    return hr;
 }
 
 HRESULT STDMETHODCALLTYPE WrapperEffect::Stop() {
     m_filter->logEffectStop();
+    noteGameCall(kRestoreCancelled);
 
     // Record stop so auto-restart knows not to restart stopped effects
     FFBStateRegistry::instance().recordStop(
-        m_filter->deviceName(), m_guid);
+        m_filter->registryDevice(), instanceId());
 
-    if (!m_filter->isFFBAllowed()) return DI_OK;
-    if (!m_real) return DI_OK;
-    return m_real->Stop();
+    HRESULT hr = DI_OK;
+    if (m_filter->isFFBAllowed() && m_real) {
+        if (m_filter->asyncCommands()) {
+            hr = takeDeferredError();
+            enqueue(&WrapperEffect::runStop, 0, 0, FFBTraceMethod::Stop);
+        } else {
+            flushPending();
+            hr = forwardStop();
+        }
+    }
+
+    m_filter->trace(FFBTraceMethod::Stop, m_kind, m_serial, hr);
+    return hr;
 }
 
 HRESULT STDMETHODCALLTYPE WrapperEffect::GetEffectStatus(LPDWORD pdwFlags) {
+    HRESULT hr = DI_OK;
+    uint32_t source = kFFBTraceStatusDevice;
     if (!m_filter->isFFBAllowed() || !m_real) {
         if (pdwFlags) *pdwFlags = 0;
-        return DI_OK;
+    } else if (!pdwFlags) {
+        hr = m_real->GetEffectStatus(pdwFlags);   // let DirectInput reject it
+    } else if (DWORD maxAge = m_filter->statusMaxAgeMs()) {
+        // Shadow updates happen when Start/Stop are issued, queued or not,
+        // so there is no need to wait for the worker here.
+        DWORD status = 0;
+        ShadowFreshness f = m_status.query(status, m_filter->stateShadow().stopEpoch(),
+                                           GetTickCount64(), maxAge);
+        if (f == ShadowFreshness::Stale && m_filter->asyncCommands()) {
+            if (!InterlockedExchange(&m_statusRefreshQueued, 1))
+                enqueue(&WrapperEffect::runStatusRefresh, 0, 0,
+                        FFBTraceMethod::GetEffectStatus);
+            f = ShadowFreshness::Fresh;   // until the refresh lands, or Expired
+        }
+        if (f == ShadowFreshness::Fresh) {
+            if (m_filter->stateShadow().paused())
+                status &= ~DIEGES_PLAYING;   // resumes where it was on CONTINUE
+            *pdwFlags = status;
+            source = kFFBTraceStatusShadow;
+        } else {
+            waitForCommands();
+            hr = queryDeviceStatus(pdwFlags);
+        }
+    } else {
+        waitForCommands();   // report the state after our queued Start/Stop
+        hr = m_real->GetEffectStatus(pdwFlags);
     }
-    return m_real->GetEffectStatus(pdwFlags);
+
+    m_filter->trace(FFBTraceMethod::GetEffectStatus, m_kind, m_serial, hr, nullptr,
+                    source, (SUCCEEDED(hr) && pdwFlags) ? *pdwFlags : 0);
+    return hr;
+}
+
+HRESULT WrapperEffect::queryDeviceStatus(LPDWORD pdwFlags) {
+    // Sample the epoch first: a STOPALL racing the read must win.
+    uint32_t epoch = m_filter->stateShadow().stopEpoch();
+    HRESULT hr = m_real->GetEffectStatus(pdwFlags);
+    if (SUCCEEDED(hr))
+        m_status.onDeviceStatus(*pdwFlags, epoch, GetTickCount64());
+    return hr;
 }
 
 HRESULT STDMETHODCALLTYPE WrapperEffect::Download() {
-    if (!m_filter->isFFBAllowed()) return DI_OK;
-    if (!m_real) return DI_OK;
-    return m_real->Download();
+    HRESULT hr = DI_OK;
+    if (m_filter->isFFBAllowed() && m_real) {
+        if (m_filter->asyncCommands()) {
+            hr = takeDeferredError();
+            enqueue(&WrapperEffect::runDownload, 0, 0, FFBTraceMethod::Download);
+        } else {
+            flushPending();
+            hr = forwardDownload();
+        }
+    }
+
+    m_filter->trace(FFBTraceMethod::Download, m_kind, m_serial, hr);
+    return hr;
 }
 
 HRESULT STDMETHODCALLTYPE WrapperEffect::Unload() {
-    if (!m_real) return DI_OK;
-    return m_real->Unload();
+    noteGameCall(kRestoreCancelled);
+    HRESULT hr = DI_OK;
+    if (m_real) {
+        waitForCommands();
+        flushPending();   // otherwise a late flush would download it again
+        hr = m_real->Unload();
+        if (SUCCEEDED(hr)) {
+            m_status.onStop(GetTickCount64());
+            m_filter->stateShadow().onEffectStopped();
+        }
+        FFBSlotManager* slots = m_filter->slots();
+        if (slots && SUCCEEDED(hr))
+            slots->noteUnloaded(this);
+    }
+
+    m_filter->trace(FFBTraceMethod::Unload, m_kind, m_serial, hr);
+    return hr;
 }
 
 HRESULT STDMETHODCALLTYPE WrapperEffect::Escape(LPDIEFFESCAPE pesc) {
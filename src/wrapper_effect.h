@@ -4,7 +4,10 @@
 
 #include <windows.h>
 #include <dinput.h>
+#include <cstdint>
 #include <memory>
+#include <vector>
+#include "effect_param_cache.h"
 #include "ffb_filter.h"
 
 // Wraps IDirectInputEffect, intercepting Start/Stop/SetParameters/Download
@@ -22,6 +25,59 @@ public:
 
     virtual ~WrapperEffect();
 
+    // Per-process instance number (identifies the effect in the FFB trace).
+    uint32_t serial() const { return m_serial; }
+
+    // Registry identity: type plus creation ordinal on this device object.
+    EffectInstanceId instanceId() const {
+        EffectInstanceId id;
+        id.kind    = m_kind;
+        id.guid    = m_guid;
+        id.ordinal = m_ordinal;
+        return id;
+    }
+
+    // Forward the coalesced mailbox, if anything is pending (or extraFlags,
+    // i.e. DIEP_START, asks for a call regardless). Called by the device's
+    // FFBDeviceWorker, and on the caller's thread before any call that must
+    // observe earlier SetParameters (Start, Stop, ...).
+    HRESULT flushPending(DWORD extraFlags = 0);
+
+    // ---- Auto-restart (FFBRestoreScheduler thread) ----
+
+    // restoreState bits: a restart job is queued; the game has since called
+    // Start, Stop or Unload itself (job dropped); the game has set its own
+    // parameters (the recorded ones are not replayed).
+    enum : LONG { kRestorePending = 1, kRestoreCancelled = 2, kRestoreParamsStale = 4 };
+    LONG restoreState() const { return m_restoreState; }
+    void markRestorePending()  { InterlockedExchange(&m_restoreState, kRestorePending); }
+    void clearRestorePending() { InterlockedExchange(&m_restoreState, 0); }
+
+    IDirectInputEffect* realEffect() const { return m_real; }
+
+    // FFBSlotManager::evictFor unloaded the real effect to make room. Called
+    // under the slot manager's mutex, possibly while another effect holds its
+    // m_forwardLock, so it takes no lock of ours: the status shadow is told
+    // at once, the parameter cache on this effect's next forwarded call.
+    void onEvicted();
+
+    // Download / Start on the real effect, through the device's slot
+    // manager (DIERR_DEVICEFULL evicts an idle effect and retries).
+    HRESULT forwardDownload();
+    HRESULT forwardStart(DWORD iterations, DWORD flags);
+
+    // Replay recorded (unscaled) parameters through scaling and the cache.
+    HRESULT restoreParams(const DIEFFECT* peff, DWORD dwFlags);
+
+    // DIEP_* flags for the fields p actually holds (a flag for an empty field
+    // makes DirectInput return E_INVALIDARG).
+    static DWORD paramFlagsFor(const DIEFFECT& p);
+
+    // Soft-start position, 0..kRampFull, applied to dwGain on top of the
+    // device scale. Sets it and re-sends the gain the game last set.
+    static constexpr LONG kRampFull = 1000;
+    HRESULT stepRamp(LONG permille, DWORD extraFlags = 0);
+
     // ---- IUnknown ----
     HRESULT STDMETHODCALLTYPE QueryInterface(REFIID riid, void** ppvObj) override;
     ULONG   STDMETHODCALLTYPE AddRef() override;
@@ -40,8 +96,86 @@ public:
     HRESULT STDMETHODCALLTYPE Escape(LPDIEFFESCAPE pesc) override;
 
 private:
+    // Scratch storage for the scaled SetParameters path. Sized from m_kind at
+    // construction, so scaling neither allocates per call nor writes through
+    // the caller's pointers (games reuse those buffers every frame).
+    struct ScaleScratch {
+        DIEFFECT          effect   = {};
+        DIENVELOPE        envelope = {};
+        std::vector<BYTE> typeSpecific;    // kind's type-specific block
+        std::vector<LONG> customSamples;   // grows to the largest CustomForce seen
+    };
+
+    // Copy the members of peff that dwFlags names into m_scratch and scale
+    // the copy. Returns &m_scratch.effect.
+    const DIEFFECT* buildScaledParams(LPCDIEFFECT peff, DWORD dwFlags);
+
+    // Apply an eviction noted by onEvicted to m_lastSent. Caller holds
+    // m_forwardLock.
+    void takeEvictionLocked() {
+        if (InterlockedExchange(&m_evicted, 0)) m_lastSent.setDownloaded(false);
+    }
+
+    // Suppression check, scaling and the real SetParameters call.
+    // Caller holds m_forwardLock.
+    HRESULT forwardParamsLocked(LPCDIEFFECT peff, DWORD dwFlags, bool& suppressed);
+
+    // Run a real call that may download the effect; see FFBSlotManager.
+    template<typename Call>
+    HRESULT withSlot(Call&& call);
+    HRESULT forwardStop();
+
+    // Merge a SetParameters call into m_pending (coalescing mode).
+    void postParams(LPCDIEFFECT peff, DWORD dwFlags);
+
+    // The game acted on the effect itself while a restart is queued.
+    void noteGameCall(LONG bit) {
+        if (m_restoreState & kRestorePending) InterlockedOr(&m_restoreState, bit);
+    }
+
+    // ---- Async commands (FFBDeviceWorker thread) ----
+    // The game got DI_OK when the call was queued; a failure is remembered
+    // and returned by its next call on this effect, so e.g. a lost device
+    // still makes the game reacquire.
+    void    deferError(HRESULT hr);
+    HRESULT takeDeferredError();
+    void    enqueue(FFBCommand::Fn fn, DWORD arg0, DWORD arg1, FFBTraceMethod method);
+    HRESULT finishCommand(HRESULT hr);
+    void    waitForCommands();   // block until this effect's queued calls ran
+
+    static HRESULT runSetParamsStart(void* self, DWORD, DWORD);
+    static HRESULT runStart(void* self, DWORD iterations, DWORD flags);
+    static HRESULT runStop(void* self, DWORD, DWORD);
+    static HRESULT runDownload(void* self, DWORD, DWORD);
+    static HRESULT runStatusRefresh(void* self, DWORD, DWORD);
+
+    // Real GetEffectStatus, recorded in m_status.
+    HRESULT queryDeviceStatus(LPDWORD pdwFlags);
+
     IDirectInputEffect*        m_real;      // may be nullptr (null-effect mode)
     GUID                       m_guid;      // cached effect GUID
+    EffectKind                 m_kind;      // resolved once from m_guid
     std::shared_ptr<FFBFilter> m_filter;
+    uint32_t                   m_serial;
+    uint32_t                   m_ordinal = 0;   // see FFBFilter::acquireOrdinal
+    ScaleScratch               m_scratch;
+    EffectParamCache           m_lastSent;  // redundant SetParameters check
+    uint32_t                   m_policySeen = 0;   // policyGeneration of m_lastSent, same lock
+    SRWLOCK                    m_forwardLock = SRWLOCK_INIT;  // m_scratch, m_lastSent, m_flushing
+
+    // Coalescing mailbox (only used when m_worker is set). Game threads
+    // merge into m_pending; flushPending() swaps it with m_flushing.
+    FFBDeviceWorker*           m_worker = nullptr;
+    SRWLOCK                    m_mailboxLock = SRWLOCK_INIT;   // m_pending, m_pendingBehavior
+    EffectParamCache           m_pending;
+    DWORD                      m_pendingBehavior = 0;   // DIEP_NODOWNLOAD/NORESTART all merged calls had
+    EffectParamCache           m_flushing;
+    volatile LONG              m_queuedCommands = 0;
+    volatile LONG              m_deferredError  = DI_OK;
+    volatile LONG              m_restoreState   = 0;   // kRestore* bits
+    volatile LONG              m_rampPermille   = kRampFull;   // under m_forwardLock
+    EffectStatusShadow         m_status;                       // see StatusMaxAgeMs
+    volatile LONG              m_statusRefreshQueued = 0;
+    volatile LONG              m_evicted = 0;         // see onEvicted
     volatile LONG              m_refCount = 1;
 };
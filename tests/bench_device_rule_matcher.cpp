@@ -0,0 +1,93 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026 Valmantas Paliksa
+//
+// [FFBDevices] name lookup with 50 rules over 100 product names: the
+// compiled matcher vs lower-casing and wcsstr for every rule in turn (what
+// Config did before the matcher). Most names match a late rule or none, the
+// worst case for both.
+//
+//     bench_device_rule_matcher [passes]
+
+#include "device_rule_matcher.h"
+#include "test_util.h"
+
+#include <cstdlib>
+#include <cwchar>
+#include <cwctype>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr size_t kRules   = 50;
+constexpr size_t kDevices = 100;
+
+const wchar_t* const kVendors[] = {
+    L"Fanatec", L"Logitech", L"Thrustmaster", L"Moza", L"Simucube", L"VKB",
+    L"Virpil", L"Winwing", L"Saitek", L"Microsoft",
+};
+const wchar_t* const kModels[] = {
+    L"Wheel", L"Stick", L"Throttle", L"Pedals", L"Base", L"Rudder",
+    L"Gladiator", L"Sidewinder Force Feedback 2", L"Collective", L"Shifter",
+};
+
+std::wstring lower(std::wstring s) {
+    for (wchar_t& c : s) c = static_cast<wchar_t>(towlower(c));
+    return s;
+}
+
+size_t naiveFirstMatch(const std::vector<DeviceRuleMatcher::Pattern>& rules,
+                       const std::wstring& name) {
+    std::wstring n = lower(name);
+    for (const auto& r : rules)
+        if (std::wcsstr(n.c_str(), lower(r.text).c_str())) return r.rule;
+    return DeviceRuleMatcher::kNoMatch;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int passes = argc > 1 ? std::atoi(argv[1]) : 2000;
+    if (passes <= 0) return 2;
+
+    // "Vendor Model Mk N" rules; the devices are mostly other marks.
+    std::vector<DeviceRuleMatcher::Pattern> rules;
+    for (size_t i = 0; i < kRules; ++i)
+        rules.push_back({ i, std::wstring(kVendors[i % 10]) + L" " + kModels[i / 10 % 10] +
+                             L" Mk " + std::to_wstring(i) });
+    std::vector<std::wstring> devices;
+    for (size_t i = 0; i < kDevices; ++i)
+        devices.push_back(std::wstring(kVendors[i * 7 % 10]) + L" " + kModels[i % 10] +
+                          L" MK " + std::to_wstring(i * 3 % 80) + L" USB");
+
+    DeviceRuleMatcher matcher;
+    matcher.build(rules);
+
+    size_t matched = 0, sink = 0;
+    for (const std::wstring& d : devices) {
+        size_t r = matcher.firstMatch(d.c_str());
+        if (r != naiveFirstMatch(rules, d)) {
+            std::fprintf(stderr, "mismatch for %ls\n", d.c_str());
+            return 1;
+        }
+        matched += r != DeviceRuleMatcher::kNoMatch;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    for (int p = 0; p < passes; ++p)
+        for (const std::wstring& d : devices) sink += naiveFirstMatch(rules, d);
+    double naive = secondsSince(start);
+
+    start = std::chrono::steady_clock::now();
+    for (int p = 0; p < passes; ++p)
+        for (const std::wstring& d : devices) sink += matcher.firstMatch(d.c_str());
+    double compiled = secondsSince(start);
+
+    double lookups = static_cast<double>(passes) * kDevices;
+    std::printf("%zu rules x %zu devices (%zu match) x %d passes\n",
+                kRules, kDevices, matched, passes);
+    std::printf("  wcsstr  : %8.1f ns/lookup\n", naive * 1e9 / lookups);
+    std::printf("  matcher : %8.1f ns/lookup  (%.1fx)\n", compiled * 1e9 / lookups,
+                compiled > 0 ? naive / compiled : 0.0);
+    return sink == 42 ? 1 : 0;   // keep the work observable
+}
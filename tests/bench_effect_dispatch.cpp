@@ -0,0 +1,210 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026 Valmantas Paliksa
+//
+// Picking the type-specific scaler for an update: the GUID if-chain
+// scaleEffect ran on every call before EffectKind, against the kind resolved
+// once per effect (effectKindFromGuid) and a table indexed by its category,
+// as kScalers does. Both sides call the same scalers, so the difference is
+// the dispatch; the last line is FFBFilter::scaleEffect itself, policy
+// lookup and gain/envelope included. Effects cycle through every standard
+// type except CustomForce, so condition effects sit late in the chain as
+// they did.
+//
+//     bench_effect_dispatch [updates]
+
+#include "effect_kind.h"
+#include "ffb_filter.h"
+#include "ffb_scale.h"
+#include "mock_dinput.h"
+#include "test_util.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+// ---------------------------------------------------------------------------
+// Scalers (the arithmetic of ffb_filter.cpp, without curves)
+// ---------------------------------------------------------------------------
+using Scaler = void (*)(void* params, DWORD cb, FFBScaleFactor f);
+
+void scaleConstant(void* params, DWORD cb, FFBScaleFactor f) {
+    if (cb < sizeof(DICONSTANTFORCE)) return;
+    auto* p = static_cast<DICONSTANTFORCE*>(params);
+    p->lMagnitude = ffbScaleSigned(p->lMagnitude, f);
+}
+
+void scaleRamp(void* params, DWORD cb, FFBScaleFactor f) {
+    if (cb < sizeof(DIRAMPFORCE)) return;
+    auto* p = static_cast<DIRAMPFORCE*>(params);
+    p->lStart = ffbScaleSigned(p->lStart, f);
+    p->lEnd   = ffbScaleSigned(p->lEnd,   f);
+}
+
+void scalePeriodic(void* params, DWORD cb, FFBScaleFactor f) {
+    if (cb < sizeof(DIPERIODIC)) return;
+    auto* p = static_cast<DIPERIODIC*>(params);
+    p->dwMagnitude = ffbScaleUnsigned(p->dwMagnitude, f);
+}
+
+void scaleCondition(void* params, DWORD cb, FFBScaleFactor f) {
+    if (cb < sizeof(DICONDITION)) return;
+    ffbScaleConditions(static_cast<int32_t*>(params), cb / sizeof(DICONDITION), f);
+}
+
+void scaleCustom(void* params, DWORD cb, FFBScaleFactor f) {
+    if (cb < sizeof(DICUSTOMFORCE)) return;
+    auto* p = static_cast<DICUSTOMFORCE*>(params);
+    if (p->rglForceData)
+        ffbScaleSamples(reinterpret_cast<int32_t*>(p->rglForceData),
+                        static_cast<size_t>(p->cSamples) * p->cChannels, f);
+}
+
+// ---------------------------------------------------------------------------
+// Old dispatch: compare the GUID on every update
+// ---------------------------------------------------------------------------
+bool isConditionEffect(REFGUID guid) {
+    return guid == GUID_Spring || guid == GUID_Damper ||
+           guid == GUID_Inertia || guid == GUID_Friction;
+}
+
+bool isPeriodicEffect(REFGUID guid) {
+    return guid == GUID_Square || guid == GUID_Sine ||
+           guid == GUID_Triangle || guid == GUID_SawtoothUp ||
+           guid == GUID_SawtoothDown;
+}
+
+void scaleByGuid(DIEFFECT* eff, REFGUID guid, FFBScaleFactor f) {
+    void* ts = eff->lpvTypeSpecificParams;
+    DWORD cb = eff->cbTypeSpecificParams;
+    if (guid == GUID_ConstantForce)     scaleConstant(ts, cb, f);
+    else if (guid == GUID_RampForce)    scaleRamp(ts, cb, f);
+    else if (isPeriodicEffect(guid))    scalePeriodic(ts, cb, f);
+    else if (isConditionEffect(guid))   scaleCondition(ts, cb, f);
+    else if (guid == GUID_CustomForce)  scaleCustom(ts, cb, f);
+}
+
+// ---------------------------------------------------------------------------
+// New dispatch: kind resolved at creation, table indexed by category
+// ---------------------------------------------------------------------------
+constexpr Scaler kTable[] = {
+    nullptr, scaleConstant, scaleRamp, scalePeriodic, scaleCondition, scaleCustom,
+};
+static_assert(sizeof(kTable) / sizeof(kTable[0]) ==
+              static_cast<size_t>(EffectCategory::Count), "one scaler per category");
+
+void scaleByKind(DIEFFECT* eff, EffectKind kind, FFBScaleFactor f) {
+    if (Scaler s = kTable[static_cast<size_t>(effectKindCategory(kind))])
+        s(eff->lpvTypeSpecificParams, eff->cbTypeSpecificParams, f);
+}
+
+// ---------------------------------------------------------------------------
+// Workload
+// ---------------------------------------------------------------------------
+const GUID* const kGuids[] = {
+    &GUID_ConstantForce, &GUID_Spring, &GUID_Sine, &GUID_Damper, &GUID_RampForce,
+    &GUID_Friction, &GUID_Square, &GUID_Inertia, &GUID_Triangle,
+    &GUID_SawtoothUp, &GUID_SawtoothDown,
+};
+constexpr size_t kEffects = sizeof(kGuids) / sizeof(kGuids[0]);
+
+struct Effect {
+    const GUID* guid = nullptr;
+    EffectKind  kind = EffectKind::Unknown;
+    DIEFFECT    eff  = {};
+    union {
+        DICONSTANTFORCE constant;
+        DIRAMPFORCE     ramp;
+        DIPERIODIC      periodic;
+        DICONDITION     conditions[2];
+    } ts, original;
+};
+
+void initEffect(Effect& e, const GUID* guid) {
+    e.guid = guid;
+    e.kind = effectKindFromGuid(*guid);
+    std::memset(&e.original, 0, sizeof(e.original));
+    DWORD cb = 0;
+    switch (effectKindCategory(e.kind)) {
+        case EffectCategory::Constant:
+            e.original.constant.lMagnitude = -7000;
+            cb = sizeof(DICONSTANTFORCE);
+            break;
+        case EffectCategory::Ramp:
+            e.original.ramp = { -4000, 9000 };
+            cb = sizeof(DIRAMPFORCE);
+            break;
+        case EffectCategory::Periodic:
+            e.original.periodic = { 6000, 0, 0, 20000 };
+            cb = sizeof(DIPERIODIC);
+            break;
+        case EffectCategory::Condition:
+            for (DICONDITION& c : e.original.conditions)
+                c = { 0, 8000, -8000, 10000, 10000, 0 };
+            cb = sizeof(e.original.conditions);
+            break;
+        default:
+            break;
+    }
+    e.eff.dwSize = sizeof(DIEFFECT);
+    e.eff.dwGain = DI_FFNOMINALMAX;
+    e.eff.cbTypeSpecificParams = cb;
+    e.eff.lpvTypeSpecificParams = &e.ts;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int updates = argc > 1 ? std::atoi(argv[1]) : 20000000;
+    if (updates <= 0) return 2;
+
+    Config::instance().ffbDefaultScale = 80;
+    std::shared_ptr<FFBFilter> filter = makeMockFilter(mockPolicy(), L"Dispatch Wheel");
+    const FFBScaleFactor f = ffbMakeScaleFactor(80);
+
+    std::vector<Effect> effects(kEffects);
+    for (size_t i = 0; i < kEffects; ++i) initEffect(effects[i], kGuids[i]);
+
+    // Each update restores the game's values first, so every variant scales
+    // the same numbers; that copy is timed alone and subtracted.
+    int64_t sink = 0;
+    auto time = [&](auto&& scale) {
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < updates; ++i) {
+            Effect& e = effects[static_cast<size_t>(i) % kEffects];
+            e.ts = e.original;
+            scale(e);
+            sink += e.ts.conditions[0].lPositiveCoefficient;
+        }
+        return secondsSince(start);
+    };
+
+    double base   = time([](Effect&) {});
+    double byGuid = time([&](Effect& e) { scaleByGuid(&e.eff, *e.guid, f); }) - base;
+    double byKind = time([&](Effect& e) { scaleByKind(&e.eff, e.kind, f); }) - base;
+    double filterPath = time([&](Effect& e) {
+        e.eff.dwGain = DI_FFNOMINALMAX;
+        filter->scaleEffect(&e.eff, e.kind);
+    }) - base;
+
+    // Both dispatches must scale alike.
+    for (Effect& e : effects) {
+        e.ts = e.original;
+        scaleByGuid(&e.eff, *e.guid, f);
+        auto viaGuid = e.ts;
+        e.ts = e.original;
+        scaleByKind(&e.eff, e.kind, f);
+        if (std::memcmp(&viaGuid, &e.ts, sizeof(e.ts)) != 0) {
+            std::fprintf(stderr, "dispatch mismatch for %s\n", effectKindName(e.kind));
+            return 1;
+        }
+    }
+
+    std::printf("%d updates over %zu effect types (copy cost subtracted)\n", updates, kEffects);
+    std::printf("  GUID if-chain       : %6.2f ns/update\n", byGuid * 1e9 / updates);
+    std::printf("  kind + scaler table : %6.2f ns/update  (%.1fx)\n", byKind * 1e9 / updates,
+                byKind > 0 ? byGuid / byKind : 0.0);
+    std::printf("  scaleEffect         : %6.2f ns/update\n", filterPath * 1e9 / updates);
+    return sink == 42 ? 1 : 0;   // keep the work observable
+}
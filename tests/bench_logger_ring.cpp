@@ -0,0 +1,161 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026 Valmantas Paliksa
+//
+// Producer-side cost of a log call: the MpscRing + writer thread design the
+// Logger uses, against the previous mutex + fprintf + fflush per message.
+//
+//     bench_logger_ring [producers] [messages-per-producer]
+
+#include "mpsc_ring.h"
+#include "test_util.h"
+
+#include <atomic>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+
+constexpr size_t kTextChars = 480;
+
+struct Entry {
+    char text[kTextChars] = {};
+};
+
+// ---------------------------------------------------------------------------
+// Old design: every caller formats, writes and flushes under one mutex.
+// ---------------------------------------------------------------------------
+class MutexLogger {
+public:
+    explicit MutexLogger(FILE* file) : m_file(file) {}
+
+    void log(const char* fmt, ...) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        va_list args;
+        va_start(args, fmt);
+        vfprintf(m_file, fmt, args);
+        va_end(args);
+        fputc('\n', m_file);
+        fflush(m_file);
+    }
+
+private:
+    FILE*      m_file;
+    std::mutex m_mutex;
+};
+
+// ---------------------------------------------------------------------------
+// New design: callers format into a ring slot, one thread writes batches.
+// Like the Logger, a full ring drops the message; the drop count is printed
+// so a run where the writer could not keep up is easy to spot.
+// ---------------------------------------------------------------------------
+class RingLogger {
+public:
+    explicit RingLogger(FILE* file) : m_file(file), m_writer([this] { run(); }) {}
+
+    ~RingLogger() {
+        m_stop.store(true);
+        m_writer.join();
+        drain();
+    }
+
+    void log(const char* fmt, ...) {
+        size_t pos;
+        Entry* entry = m_ring.tryAcquire(pos);
+        if (!entry) {
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        va_list args;
+        va_start(args, fmt);
+        vsnprintf(entry->text, sizeof(entry->text), fmt, args);
+        va_end(args);
+        m_ring.publish(pos);
+    }
+
+    unsigned long long dropped() const { return m_dropped.load(); }
+
+private:
+    void drain() {
+        size_t n = m_ring.consume([this](const Entry& entry) {
+            fputs(entry.text, m_file);
+            fputc('\n', m_file);
+        });
+        if (n) fflush(m_file);
+    }
+
+    void run() {
+        while (!m_stop.load()) {
+            drain();
+            std::this_thread::yield();
+        }
+    }
+
+    FILE*                           m_file;
+    MpscRing<Entry, 2048>           m_ring;
+    std::atomic<bool>               m_stop{false};
+    std::atomic<unsigned long long> m_dropped{0};
+    std::thread                     m_writer;
+};
+
+template<typename LoggerT>
+double run(LoggerT& logger, unsigned producers, unsigned messages) {
+    std::atomic<bool> go{false};
+    std::vector<std::thread> threads;
+    std::vector<double> seconds(producers);
+    for (unsigned p = 0; p < producers; ++p) {
+        threads.emplace_back([&, p] {
+            while (!go.load()) std::this_thread::yield();
+            auto start = std::chrono::steady_clock::now();
+            for (unsigned i = 0; i < messages; ++i)
+                logger.log("SetParameters: effect=%p flags=0x%08X gain=%u", &logger, i, p);
+            seconds[p] = secondsSince(start);
+        });
+    }
+    go.store(true);
+    for (auto& t : threads) t.join();
+
+    double worst = 0;
+    for (double s : seconds) worst = s > worst ? s : worst;
+    return worst;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    unsigned producers = argc > 1 ? static_cast<unsigned>(std::atoi(argv[1])) : 4;
+    unsigned messages  = argc > 2 ? static_cast<unsigned>(std::atoi(argv[2])) : 100000;
+    if (!producers || !messages) return 2;
+
+    FILE* mutexFile = std::tmpfile();
+    FILE* ringFile  = std::tmpfile();
+    if (!mutexFile || !ringFile) return 2;
+
+    double mutexSeconds;
+    {
+        MutexLogger logger(mutexFile);
+        mutexSeconds = run(logger, producers, messages);
+    }
+
+    double ringSeconds;
+    unsigned long long dropped;
+    {
+        RingLogger logger(ringFile);
+        ringSeconds = run(logger, producers, messages);
+        dropped = logger.dropped();
+    }
+
+    const double calls = double(producers) * messages;
+    std::printf("%u producer(s) x %u messages\n", producers, messages);
+    std::printf("  mutex+fflush : %8.1f ns/call  %10.0f calls/s\n",
+                mutexSeconds * 1e9 / messages, calls / mutexSeconds);
+    std::printf("  mpsc ring    : %8.1f ns/call  %10.0f calls/s  (%llu dropped)\n",
+                ringSeconds * 1e9 / messages, calls / ringSeconds, dropped);
+
+    std::fclose(mutexFile);
+    std::fclose(ringFile);
+    return 0;
+}
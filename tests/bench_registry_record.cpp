@@ -0,0 +1,170 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026 Valmantas Paliksa
+//
+// Cost of FFBStateRegistry::recordParams with concurrent writers: the fixed
+// seqlock-published records against the previous design (one registry-wide
+// mutex, records keyed by lower-cased name and GUID, vectors deep-copied per
+// call). Each writer streams its own effect; a reader takes a snapshot every
+// millisecond, as a CreateEffect replay would.
+//
+//     bench_registry_record [max-writers] [updates-per-writer]
+
+#include "ffb_state_registry.h"
+#include "test_util.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <cwctype>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// ---------------------------------------------------------------------------
+// Old design
+// ---------------------------------------------------------------------------
+struct LegacyRecord {
+    DIEFFECT           params = {};
+    std::vector<DWORD> axes;
+    std::vector<LONG>  directions;
+    std::vector<BYTE>  typeSpecific;
+    DIENVELOPE         envelope = {};
+    bool               hasEnvelope = false;
+};
+
+class LegacyRegistry {
+public:
+    void recordParams(const std::wstring& deviceName, REFGUID guid, const DIEFFECT* peff) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        LegacyRecord& rec = m_records[toLower(deviceName)][guid];
+        rec.params = *peff;
+        rec.axes.assign(peff->rgdwAxes, peff->rgdwAxes + peff->cAxes);
+        rec.directions.assign(peff->rglDirection, peff->rglDirection + peff->cAxes);
+        const BYTE* ts = static_cast<const BYTE*>(peff->lpvTypeSpecificParams);
+        rec.typeSpecific.assign(ts, ts + peff->cbTypeSpecificParams);
+        rec.hasEnvelope = peff->lpEnvelope != nullptr;
+        if (rec.hasEnvelope) rec.envelope = *peff->lpEnvelope;
+    }
+
+    // What CreateEffect did: copy the device's records out under the lock.
+    size_t snapshot(const std::wstring& deviceName) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::map<GUID, LegacyRecord, GUIDLess> copy = m_records[toLower(deviceName)];
+        return copy.size();
+    }
+
+private:
+    static std::wstring toLower(const std::wstring& s) {
+        std::wstring r = s;
+        std::transform(r.begin(), r.end(), r.begin(), ::towlower);
+        return r;
+    }
+
+    std::mutex m_mutex;
+    std::map<std::wstring, std::map<GUID, LegacyRecord, GUIDLess>> m_records;
+};
+
+// ---------------------------------------------------------------------------
+// Workload
+// ---------------------------------------------------------------------------
+const GUID* const kGuids[] = { &GUID_ConstantForce, &GUID_Sine, &GUID_Spring,
+                               &GUID_Damper, &GUID_Square, &GUID_Friction,
+                               &GUID_Inertia, &GUID_Triangle };
+
+struct Params {
+    DWORD           axes[2] = { DIJOFS_X, DIJOFS_Y };
+    LONG            dirs[2] = { 0, 0 };
+    DICONDITION     cond[2] = {};
+    DIENVELOPE      env = { sizeof(DIENVELOPE), 0, 0, 0, 0 };
+    DIEFFECT        eff = {};
+
+    Params() {
+        eff.dwSize = sizeof(DIEFFECT);
+        eff.dwFlags = DIEFF_CARTESIAN | DIEFF_OBJECTOFFSETS;
+        eff.dwGain = DI_FFNOMINALMAX;
+        eff.cAxes = 2;
+        eff.rgdwAxes = axes;
+        eff.rglDirection = dirs;
+        eff.lpEnvelope = &env;
+        eff.cbTypeSpecificParams = sizeof(cond);
+        eff.lpvTypeSpecificParams = cond;
+    }
+};
+
+template<typename Write, typename Read>
+double run(unsigned writers, unsigned updates, Write&& write, Read&& read) {
+    std::atomic<bool> go{false}, done{false};
+    std::vector<std::thread> threads;
+    std::vector<double> seconds(writers);
+    for (unsigned w = 0; w < writers; ++w) {
+        threads.emplace_back([&, w] {
+            Params p;
+            while (!go.load()) std::this_thread::yield();
+            auto start = std::chrono::steady_clock::now();
+            for (unsigned i = 0; i < updates; ++i) {
+                p.cond[0].lPositiveCoefficient = static_cast<LONG>(i);
+                p.dirs[0] = static_cast<LONG>(i);
+                write(w, &p.eff);
+            }
+            seconds[w] = secondsSince(start);
+        });
+    }
+    std::thread reader([&] {
+        while (!go.load()) std::this_thread::yield();
+        while (!done.load()) {
+            read();
+            Sleep(1);
+        }
+    });
+    go.store(true);
+    for (auto& t : threads) t.join();
+    done.store(true);
+    reader.join();
+    return *std::max_element(seconds.begin(), seconds.end());
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    unsigned maxWriters = argc > 1 ? static_cast<unsigned>(std::atoi(argv[1])) : 4;
+    unsigned updates    = argc > 2 ? static_cast<unsigned>(std::atoi(argv[2])) : 200000;
+    maxWriters = std::min<unsigned>(maxWriters, sizeof(kGuids) / sizeof(kGuids[0]));
+    if (!maxWriters || !updates) return 2;
+
+    DeviceIdentity identity;
+    identity.instanceGuid.Data1 = 0xBE1C4;
+    identity.productName = L"Bench Wheel";
+    FFBStateRegistry& registry = FFBStateRegistry::instance();
+    FFBDeviceHandle handle = registry.internDevice(identity);
+
+    std::printf("recordParams, %u updates per writer, reader snapshots every 1 ms\n", updates);
+    for (unsigned writers = 1; writers <= maxWriters; writers *= 2) {
+        LegacyRegistry legacy;
+        double legacySeconds = run(writers, updates,
+            [&](unsigned w, const DIEFFECT* eff) {
+                legacy.recordParams(identity.productName, *kGuids[w], eff);
+            },
+            [&] { legacy.snapshot(identity.productName); });
+
+        double seqlockSeconds = run(writers, updates,
+            [&](unsigned w, const DIEFFECT* eff) {
+                EffectInstanceId id;
+                id.kind = effectKindFromGuid(*kGuids[w]);
+                id.guid = *kGuids[w];
+                registry.recordParams(handle, id, eff);
+            },
+            [&] { registry.snapshot(handle); });
+
+        std::printf("  %u writer(s): mutex+vectors %7.1f ns/update   seqlock %7.1f ns/update"
+                    "   (%.1fx)\n", writers,
+                    legacySeconds * 1e9 / updates, seqlockSeconds * 1e9 / updates,
+                    legacySeconds / seqlockSeconds);
+    }
+
+    registry.releaseDevice(handle);
+    return 0;
+}
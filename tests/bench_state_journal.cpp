@@ -0,0 +1,90 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026 Valmantas Paliksa
+//
+// What [FFB] StateJournal adds to the recording path: recordParams and
+// recordStart with the journal closed and open, and FFBStateJournal::write
+// on its own (copy plus checksum into the mapped file).
+//
+//     bench_state_journal [updates]
+
+#include "ffb_state_journal.h"
+#include "ffb_state_registry.h"
+#include "test_util.h"
+
+#include <cstdlib>
+
+namespace {
+
+struct Workload {
+    DWORD           axes[2] = { DIJOFS_X, DIJOFS_Y };
+    LONG            dirs[2] = { 0, 0 };
+    DICONDITION     cond[2] = {};
+    DIENVELOPE      env = { sizeof(DIENVELOPE), 0, 0, 0, 0 };
+    DIEFFECT        eff = {};
+    EffectInstanceId id;
+
+    Workload() {
+        eff.dwSize = sizeof(DIEFFECT);
+        eff.dwGain = DI_FFNOMINALMAX;
+        eff.cAxes = 2;
+        eff.rgdwAxes = axes;
+        eff.rglDirection = dirs;
+        eff.lpEnvelope = &env;
+        eff.cbTypeSpecificParams = sizeof(cond);
+        eff.lpvTypeSpecificParams = cond;
+        id.kind = EffectKind::Spring;
+        id.guid = GUID_Spring;
+    }
+};
+
+double recordLoop(FFBDeviceHandle h, unsigned updates) {
+    FFBStateRegistry& reg = FFBStateRegistry::instance();
+    Workload w;
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned i = 0; i < updates; ++i) {
+        w.cond[0].lOffset = static_cast<LONG>(i);
+        reg.recordParams(h, w.id, &w.eff);
+        if ((i & 63) == 0)
+            reg.recordStart(h, w.id, 1, 0);
+    }
+    return secondsSince(start);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    unsigned updates = argc > 1 ? static_cast<unsigned>(std::atoi(argv[1])) : 1000000;
+    if (!updates) return 2;
+
+    DeviceIdentity identity;
+    identity.instanceGuid.Data1 = 0xBE1C5;
+    identity.productName = L"Bench Wheel";
+    FFBStateRegistry& reg = FFBStateRegistry::instance();
+    FFBDeviceHandle h = reg.internDevice(identity);
+
+    double off = recordLoop(h, updates);
+
+    FFBStateJournal& journal = FFBStateJournal::instance();
+    if (!journal.open(L".", 0)) return 2;
+    double on = recordLoop(h, updates);
+
+    EffectStateRecord rec;
+    rec.kind = EffectKind::Spring;
+    rec.hasParams = true;
+    size_t index = denseRecordIndex(Workload().id);
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned i = 0; i < updates; ++i) {
+        rec.params.dwGain = i;
+        journal.write(h, index, rec);
+    }
+    double raw = secondsSince(start);
+    journal.close();
+    reg.releaseDevice(h);
+
+    std::printf("%u updates, EffectStateRecord %zu bytes\n", updates, sizeof(EffectStateRecord));
+    std::printf("  recordParams, journal off : %7.1f ns/update\n", off * 1e9 / updates);
+    std::printf("  recordParams, journal on  : %7.1f ns/update  (+%.1f ns)\n",
+                on * 1e9 / updates, (on - off) * 1e9 / updates);
+    std::printf("  FFBStateJournal::write    : %7.1f ns/write\n", raw * 1e9 / updates);
+    return 0;
+}
@@ -0,0 +1,577 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026 Valmantas Paliksa
+#pragma once
+//
+// Scriptable stand-ins for the real DirectInput objects, for the tests that
+// drive the wrappers (Windows only).
+//
+// MockDevice implements IDirectInputDevice8W and hands out MockEffects. The
+// pair behaves like a small FFB device: effects have download slots (a
+// limit makes Download fail with DIERR_DEVICEFULL), play for their duration
+// and react to SendForceFeedbackCommand. A test can unplug the device
+// (every call fails with DIERR_INPUTLOST), make Acquire fail, or add a fixed
+// latency to each FFB call. All state is readable from the test thread while
+// wrapper threads call in.
+//
+// The effect's SetParameters path only copies into fixed buffers, so a test
+// can count heap allocations around it.
+//
+#include <windows.h>
+#include <dinput.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "config.h"
+#include "device_identity.h"
+#include "ffb_filter.h"
+#include "ffb_state_registry.h"
+#include "wrapper_device8.h"
+
+class MockDevice;
+
+// ============================================================================
+// MockEffect
+// ============================================================================
+class MockEffect : public IDirectInputEffect {
+public:
+    static constexpr size_t kMaxTypeSpecific = 64;
+
+    MockEffect(MockDevice* device, REFGUID guid) : m_device(device), m_guid(guid) {}
+    virtual ~MockEffect() = default;
+
+    // ---- Scripting ----
+    std::atomic<HRESULT> setParametersHr{DI_OK};   // returned instead of DI_OK when failed
+    std::atomic<HRESULT> startHr{DI_OK};
+    std::atomic<int>     startFailures{0};      // the next N Starts: DIERR_INPUTLOST
+
+    // ---- Observations ----
+    std::atomic<int> setParametersCalls{0};
+    std::atomic<int> startCalls{0};
+    std::atomic<int> stopCalls{0};
+    std::atomic<int> downloadCalls{0};
+    std::atomic<int> unloadCalls{0};
+    std::atomic<int> statusCalls{0};
+
+    bool downloaded() const { return m_downloaded.load(); }
+    bool playing() const;
+
+    // Last SetParameters as the device saw it.
+    struct Params {
+        DWORD      flags    = 0;
+        DWORD      gain     = 0;
+        DWORD      duration = 0;
+        bool       hasEnvelope = false;
+        DIENVELOPE envelope = {};
+        DWORD      typeSpecificBytes = 0;
+        BYTE       typeSpecific[kMaxTypeSpecific] = {};
+        LONG       firstSample = 0;   // DICUSTOMFORCE rglForceData[0]
+    };
+    Params lastParams() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_last;
+    }
+    // steady tick (GetTickCount64) of the last SetParameters that reached the device.
+    ULONGLONG lastSetParametersTick() const { return m_lastSetTick.load(); }
+
+    // ---- IUnknown ----
+    HRESULT STDMETHODCALLTYPE QueryInterface(REFIID riid, void** ppv) override {
+        if (!ppv) return E_POINTER;
+        if (riid == IID_IUnknown || riid == IID_IDirectInputEffect) {
+            *ppv = static_cast<IDirectInputEffect*>(this);
+            AddRef();
+            return S_OK;
+        }
+        *ppv = nullptr;
+        return E_NOINTERFACE;
+    }
+    ULONG STDMETHODCALLTYPE AddRef() override { return InterlockedIncrement(&m_refCount); }
+    ULONG STDMETHODCALLTYPE Release() override {
+        ULONG c = InterlockedDecrement(&m_refCount);
+        if (c == 0) delete this;
+        return c;
+    }
+
+    // ---- IDirectInputEffect ----
+    HRESULT STDMETHODCALLTYPE Initialize(HINSTANCE, DWORD, REFGUID) override { return DI_OK; }
+    HRESULT STDMETHODCALLTYPE GetEffectGuid(LPGUID pguid) override {
+        if (!pguid) return E_POINTER;
+        *pguid = m_guid;
+        return DI_OK;
+    }
+    HRESULT STDMETHODCALLTYPE GetParameters(LPDIEFFECT peff, DWORD dwFlags) override;
+    HRESULT STDMETHODCALLTYPE SetParameters(LPCDIEFFECT peff, DWORD dwFlags) override;
+    HRESULT STDMETHODCALLTYPE Start(DWORD dwIterations, DWORD dwFlags) override;
+    HRESULT STDMETHODCALLTYPE Stop() override;
+    HRESULT STDMETHODCALLTYPE GetEffectStatus(LPDWORD pdwFlags) override;
+    HRESULT STDMETHODCALLTYPE Download() override;
+    HRESULT STDMETHODCALLTYPE Unload() override;
+    HRESULT STDMETHODCALLTYPE Escape(LPDIEFFESCAPE) override { return DIERR_UNSUPPORTED; }
+
+    // Device-side transitions (SendForceFeedbackCommand, unplug).
+    void deviceStop()   { m_playUntil.store(0); }
+    void deviceUnload() { m_playUntil.store(0); releaseSlot(); }
+
+private:
+    HRESULT enter();          // latency + lost check
+    HRESULT ensureSlot();     // claim a download slot if not yet downloaded
+    void    releaseSlot();
+
+    MockDevice*            m_device;
+    GUID                   m_guid;
+    volatile LONG          m_refCount = 1;
+    mutable std::mutex     m_mutex;   // m_last
+    Params                 m_last;
+    std::atomic<bool>      m_downloaded{false};
+    std::atomic<DWORD>     m_duration{INFINITE};
+    // GetTickCount64 at which playback ends; 0 = stopped, ~0 = forever.
+    std::atomic<ULONGLONG> m_playUntil{0};
+    std::atomic<ULONGLONG> m_lastSetTick{0};
+};
+
+// ============================================================================
+// MockDevice
+// ============================================================================
+class MockDevice : public IDirectInputDevice8W {
+public:
+    MockDevice() = default;
+    virtual ~MockDevice() {
+        for (MockEffect* e : m_effects) e->Release();
+    }
+
+    // ---- Scripting ----
+    std::atomic<bool>    unplugged{false};      // every call: DIERR_INPUTLOST
+    std::atomic<HRESULT> acquireHr{DI_OK};      // when plugged in
+    std::atomic<DWORD>   latencyMs{0};          // added to every FFB call
+    std::atomic<int>     slotLimit{0};          // download slots, 0 = unlimited
+    std::atomic<HRESULT> commandHr{DI_OK};      // SendForceFeedbackCommand result
+    std::atomic<int>     effectStartFailures{0};   // new effects' startFailures
+
+    // ---- Observations ----
+    std::atomic<int> acquireCalls{0};
+    std::atomic<int> unacquireCalls{0};
+    std::atomic<int> inputCalls{0};
+    std::atomic<int> stateCalls{0};   // GetForceFeedbackState
+    std::atomic<int> slotsUsed{0};
+
+    std::vector<DWORD> commands() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_commands;
+    }
+    std::vector<MockEffect*> effects() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_effects;
+    }
+    bool paused() const { return m_paused.load(); }
+    bool actuatorsOn() const { return m_actuatorsOn.load(); }
+
+    // The device as the game sees it: acquired and readable.
+    bool acquired() const { return m_acquired.load(); }
+
+    // What the real device answers to GetForceFeedbackState right now.
+    DWORD ffState() const {
+        DWORD s = DIGFFS_POWERON;
+        s |= m_actuatorsOn.load() ? DIGFFS_ACTUATORSON : DIGFFS_ACTUATORSOFF;
+        if (m_paused.load()) s |= DIGFFS_PAUSED;
+        bool any = false, playing = false;
+        for (MockEffect* e : effects()) {
+            any     |= e->downloaded();
+            playing |= e->playing();
+        }
+        if (!any) s |= DIGFFS_EMPTY;
+        if (!playing) s |= DIGFFS_STOPPED;
+        return s;
+    }
+
+    // ---- IUnknown ----
+    HRESULT STDMETHODCALLTYPE QueryInterface(REFIID riid, void** ppv) override {
+        if (!ppv) return E_POINTER;
+        if (riid == IID_IUnknown || riid == IID_IDirectInputDevice8W) {
+            *ppv = static_cast<IDirectInputDevice8W*>(this);
+            AddRef();
+            return S_OK;
+        }
+        *ppv = nullptr;
+        return E_NOINTERFACE;
+    }
+    ULONG STDMETHODCALLTYPE AddRef() override { return InterlockedIncrement(&m_refCount); }
+    ULONG STDMETHODCALLTYPE Release() override {
+        ULONG c = InterlockedDecrement(&m_refCount);
+        if (c == 0) delete this;
+        return c;
+    }
+
+    // ---- IDirectInputDevice8W ----
+    HRESULT STDMETHODCALLTYPE GetCapabilities(LPDIDEVCAPS) override { return DI_OK; }
+    HRESULT STDMETHODCALLTYPE EnumObjects(LPDIENUMDEVICEOBJECTSCALLBACKW, LPVOID, DWORD) override { return DI_OK; }
+    HRESULT STDMETHODCALLTYPE GetProperty(REFGUID, LPDIPROPHEADER) override { return DIERR_UNSUPPORTED; }
+    HRESULT STDMETHODCALLTYPE SetProperty(REFGUID, LPCDIPROPHEADER) override { return DI_OK; }
+    HRESULT STDMETHODCALLTYPE Acquire() override {
+        ++acquireCalls;
+        if (unplugged.load()) return DIERR_INPUTLOST;
+        HRESULT hr = acquireHr.load();
+        if (SUCCEEDED(hr)) m_acquired.store(true);
+        return hr;
+    }
+    HRESULT STDMETHODCALLTYPE Unacquire() override {
+        ++unacquireCalls;
+        m_acquired.store(false);
+        return DI_OK;
+    }
+    HRESULT STDMETHODCALLTYPE GetDeviceState(DWORD cbData, LPVOID lpvData) override {
+        ++inputCalls;
+        if (unplugged.load()) {
+            m_acquired.store(false);
+            return DIERR_INPUTLOST;
+        }
+        if (!m_acquired.load()) return DIERR_NOTACQUIRED;
+        if (lpvData) std::memset(lpvData, 0, cbData);
+        return DI_OK;
+    }
+    HRESULT STDMETHODCALLTYPE GetDeviceData(DWORD, LPDIDEVICEOBJECTDATA, LPDWORD pdwInOut,
+                                            DWORD) override {
+        ++inputCalls;
+        if (unplugged.load()) {
+            m_acquired.store(false);
+            return DIERR_INPUTLOST;
+        }
+        if (!m_acquired.load()) return DIERR_NOTACQUIRED;
+        if (pdwInOut) *pdwInOut = 0;
+        return DI_OK;
+    }
+    HRESULT STDMETHODCALLTYPE SetDataFormat(LPCDIDATAFORMAT) override { return DI_OK; }
+    HRESULT STDMETHODCALLTYPE SetEventNotification(HANDLE) override { return DI_OK; }
+    HRESULT STDMETHODCALLTYPE SetCooperativeLevel(HWND, DWORD) override { return DI_OK; }
+    HRESULT STDMETHODCALLTYPE GetObjectInfo(DIDEVICEOBJECTINSTANCEW*, DWORD, DWORD) override {
+        return DIERR_UNSUPPORTED;
+    }
+    HRESULT STDMETHODCALLTYPE GetDeviceInfo(DIDEVICEINSTANCEW*) override { return DIERR_UNSUPPORTED; }
+    HRESULT STDMETHODCALLTYPE RunControlPanel(HWND, DWORD) override { return DI_OK; }
+    HRESULT STDMETHODCALLTYPE Initialize(HINSTANCE, DWORD, REFGUID) override { return DI_OK; }
+
+    HRESULT STDMETHODCALLTYPE CreateEffect(REFGUID rguid, LPCDIEFFECT lpeff,
+                                           LPDIRECTINPUTEFFECT* ppdeff, LPUNKNOWN) override {
+        if (!ppdeff) return E_POINTER;
+        *ppdeff = nullptr;
+        if (HRESULT hr = enterFFB(); FAILED(hr)) return hr;
+        auto* effect = new MockEffect(this, rguid);
+        effect->startFailures.store(effectStartFailures.load());
+        if (lpeff) {
+            HRESULT hr = effect->SetParameters(lpeff, DIEP_ALLPARAMS);
+            if (FAILED(hr)) {
+                effect->Release();
+                return hr;
+            }
+        }
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            effect->AddRef();   // kept for EnumCreatedEffectObjects and the test
+            m_effects.push_back(effect);
+        }
+        *ppdeff = effect;
+        return DI_OK;
+    }
+    HRESULT STDMETHODCALLTYPE EnumEffects(LPDIENUMEFFECTSCALLBACKW, LPVOID, DWORD) override { return DI_OK; }
+    HRESULT STDMETHODCALLTYPE GetEffectInfo(DIEFFECTINFOW*, REFGUID) override { return DIERR_UNSUPPORTED; }
+
+    HRESULT STDMETHODCALLTYPE GetForceFeedbackState(LPDWORD pdwOut) override {
+        ++stateCalls;
+        if (!pdwOut) return E_POINTER;
+        if (HRESULT hr = enterFFB(); FAILED(hr)) return hr;
+        *pdwOut = ffState();
+        return DI_OK;
+    }
+
+    HRESULT STDMETHODCALLTYPE SendForceFeedbackCommand(DWORD dwFlags) override {
+        if (HRESULT hr = enterFFB(); FAILED(hr)) return hr;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_commands.push_back(dwFlags);
+        }
+        HRESULT hr = commandHr.load();
+        if (FAILED(hr)) return hr;
+        switch (dwFlags) {
+        case DISFFC_RESET:
+            for (MockEffect* e : effects()) e->deviceUnload();
+            m_paused.store(false);
+            m_actuatorsOn.store(true);
+            break;
+        case DISFFC_STOPALL:
+            for (MockEffect* e : effects()) e->deviceStop();
+            m_paused.store(false);
+            break;
+        case DISFFC_PAUSE:           m_paused.store(true);       break;
+        case DISFFC_CONTINUE:        m_paused.store(false);      break;
+        case DISFFC_SETACTUATORSON:  m_actuatorsOn.store(true);  break;
+        case DISFFC_SETACTUATORSOFF: m_actuatorsOn.store(false); break;
+        default: return DIERR_INVALIDPARAM;
+        }
+        return DI_OK;
+    }
+
+    HRESULT STDMETHODCALLTYPE EnumCreatedEffectObjects(LPDIENUMCREATEDEFFECTOBJECTSCALLBACK cb,
+                                                        LPVOID pvRef, DWORD) override {
+        if (!cb) return E_POINTER;
+        for (MockEffect* e : effects())
+            if (!cb(e, pvRef)) break;
+        return DI_OK;
+    }
+    HRESULT STDMETHODCALLTYPE Escape(LPDIEFFESCAPE) override { return DIERR_UNSUPPORTED; }
+    HRESULT STDMETHODCALLTYPE Poll() override {
+        ++inputCalls;
+        if (unplugged.load()) {
+            m_acquired.store(false);
+            return DIERR_INPUTLOST;
+        }
+        return m_acquired.load() ? DI_NOEFFECT : DIERR_NOTACQUIRED;
+    }
+    HRESULT STDMETHODCALLTYPE SendDeviceData(DWORD, LPCDIDEVICEOBJECTDATA, LPDWORD, DWORD) override {
+        return DI_OK;
+    }
+    HRESULT STDMETHODCALLTYPE EnumEffectsInFile(const wchar_t*, LPDIENUMEFFECTSINFILECALLBACK,
+                                                LPVOID, DWORD) override { return DI_OK; }
+    HRESULT STDMETHODCALLTYPE WriteEffectToFile(const wchar_t*, DWORD, LPDIFILEEFFECT,
+                                                DWORD) override { return DI_OK; }
+    HRESULT STDMETHODCALLTYPE BuildActionMap(DIACTIONFORMATW*, const wchar_t*, DWORD) override {
+        return DIERR_UNSUPPORTED;
+    }
+    HRESULT STDMETHODCALLTYPE SetActionMap(DIACTIONFORMATW*, const wchar_t*, DWORD) override {
+        return DIERR_UNSUPPORTED;
+    }
+    HRESULT STDMETHODCALLTYPE GetImageInfo(DIDEVICEIMAGEINFOHEADERW*) override {
+        return DIERR_UNSUPPORTED;
+    }
+
+    // Common prologue of every FFB call: injected latency, then unplug.
+    HRESULT enterFFB() {
+        if (DWORD ms = latencyMs.load()) Sleep(ms);
+        return unplugged.load() ? DIERR_INPUTLOST : DI_OK;
+    }
+
+private:
+    volatile LONG            m_refCount = 1;
+    mutable std::mutex       m_mutex;   // m_commands, m_effects
+    std::vector<DWORD>       m_commands;
+    std::vector<MockEffect*> m_effects;
+    std::atomic<bool>        m_acquired{false};
+    std::atomic<bool>        m_paused{false};
+    std::atomic<bool>        m_actuatorsOn{true};
+};
+
+// ============================================================================
+// MockEffect methods (need MockDevice)
+// ============================================================================
+inline HRESULT MockEffect::enter() {
+    return m_device ? m_device->enterFFB() : DI_OK;
+}
+
+inline HRESULT MockEffect::ensureSlot() {
+    if (m_downloaded.load()) return DI_OK;
+    if (m_device) {
+        int limit = m_device->slotLimit.load();
+        int used  = m_device->slotsUsed.load();
+        do {
+            if (limit > 0 && used >= limit) return DIERR_DEVICEFULL;
+        } while (!m_device->slotsUsed.compare_exchange_weak(used, used + 1));
+    }
+    m_downloaded.store(true);
+    return DI_OK;
+}
+
+inline void MockEffect::releaseSlot() {
+    if (m_downloaded.exchange(false) && m_device) --m_device->slotsUsed;
+}
+
+inline bool MockEffect::playing() const {
+    ULONGLONG until = m_playUntil.load();
+    return until != 0 && GetTickCount64() < until;
+}
+
+inline HRESULT MockEffect::GetParameters(LPDIEFFECT peff, DWORD dwFlags) {
+    if (!peff) return E_POINTER;
+    if (HRESULT hr = enter(); FAILED(hr)) return hr;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (dwFlags & DIEP_GAIN)     peff->dwGain     = m_last.gain;
+    if (dwFlags & DIEP_DURATION) peff->dwDuration = m_last.duration;
+    return DI_OK;
+}
+
+inline HRESULT MockEffect::SetParameters(LPCDIEFFECT peff, DWORD dwFlags) {
+    ++setParametersCalls;
+    if (!peff) return E_POINTER;
+    if (HRESULT hr = enter(); FAILED(hr)) return hr;
+    if (HRESULT hr = setParametersHr.load(); FAILED(hr)) return hr;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_last.flags = dwFlags;
+        if (dwFlags & DIEP_GAIN) m_last.gain = peff->dwGain;
+        if (dwFlags & DIEP_DURATION) {
+            m_last.duration = peff->dwDuration;
+            m_duration.store(peff->dwDuration);
+        }
+        if (dwFlags & DIEP_ENVELOPE) {
+            m_last.hasEnvelope = peff->lpEnvelope != nullptr;
+            if (peff->lpEnvelope) m_last.envelope = *peff->lpEnvelope;
+        }
+        if ((dwFlags & DIEP_TYPESPECIFICPARAMS) && peff->lpvTypeSpecificParams) {
+            m_last.typeSpecificBytes = peff->cbTypeSpecificParams;
+            std::memcpy(m_last.typeSpecific, peff->lpvTypeSpecificParams,
+                        std::min<size_t>(peff->cbTypeSpecificParams, kMaxTypeSpecific));
+            if (m_guid == GUID_CustomForce &&
+                peff->cbTypeSpecificParams >= sizeof(DICUSTOMFORCE))
+            {
+                auto* cf = static_cast<const DICUSTOMFORCE*>(peff->lpvTypeSpecificParams);
+                m_last.firstSample = (cf->rglForceData && cf->cSamples) ? cf->rglForceData[0] : 0;
+            }
+        }
+    }
+    m_lastSetTick.store(GetTickCount64());
+    if (!(dwFlags & DIEP_NODOWNLOAD)) {
+        if (HRESULT hr = ensureSlot(); FAILED(hr)) return hr;
+    }
+    if (dwFlags & DIEP_START) return Start(1, 0);
+    return DI_OK;
+}
+
+inline HRESULT MockEffect::Start(DWORD dwIterations, DWORD) {
+    ++startCalls;
+    if (HRESULT hr = enter(); FAILED(hr)) return hr;
+    if (HRESULT hr = startHr.load(); FAILED(hr)) return hr;
+    if (startFailures.load() > 0) {
+        --startFailures;
+        return DIERR_INPUTLOST;
+    }
+    if (HRESULT hr = ensureSlot(); FAILED(hr)) return hr;
+    DWORD duration = m_duration.load();
+    if (duration == INFINITE || dwIterations == INFINITE)
+        m_playUntil.store(~0ull);
+    else
+        m_playUntil.store(GetTickCount64() + 1 +
+                          static_cast<ULONGLONG>(duration / 1000) * dwIterations);
+    return DI_OK;
+}
+
+inline HRESULT MockEffect::Stop() {
+    ++stopCalls;
+    if (HRESULT hr = enter(); FAILED(hr)) return hr;
+    m_playUntil.store(0);
+    return DI_OK;
+}
+
+inline HRESULT MockEffect::GetEffectStatus(LPDWORD pdwFlags) {
+    ++statusCalls;
+    if (!pdwFlags) return E_POINTER;
+    if (HRESULT hr = enter(); FAILED(hr)) return hr;
+    *pdwFlags = (playing() && !(m_device && m_device->paused())) ? DIEGES_PLAYING : 0;
+    return DI_OK;
+}
+
+inline HRESULT MockEffect::Download() {
+    ++downloadCalls;
+    if (HRESULT hr = enter(); FAILED(hr)) return hr;
+    return ensureSlot();
+}
+
+inline HRESULT MockEffect::Unload() {
+    ++unloadCalls;
+    if (HRESULT hr = enter(); FAILED(hr)) return hr;
+    m_playUntil.store(0);
+    releaseSlot();
+    return DI_OK;
+}
+
+// ============================================================================
+// Filter setup
+// ============================================================================
+
+// The policy Config::current() gives an unmatched device, with the optional
+// helpers (auto-restart, slot manager, worker, prewarm) switched off; tests
+// enable what they cover. The hot-reloadable fields (scale, suppression,
+// ramp, re-acquire, status age) are re-resolved from Config::current() on
+// the first FFB call, so tests set those through Config::instance(), which
+// is current() until a reload is published.
+inline FFBPolicy mockPolicy() {
+    FFBPolicy p = FFBFilter::resolvePolicy(Config::current(), DeviceIdentity{});
+    p.autoRestart   = false;
+    p.evictOnFull   = false;
+    p.prewarm       = false;
+    p.coalesceHz    = 0;
+    p.asyncCommands = false;
+    return p;
+}
+
+// An FFBFilter for the device identity. Two filters made from one identity
+// are the same device before and after a reconnect: they share its registry
+// records.
+inline std::shared_ptr<FFBFilter> makeMockFilter(const FFBPolicy& policy,
+                                                 const DeviceIdentity& device) {
+    auto identity = std::make_shared<const DeviceIdentity>(device);
+    FFBDeviceHandle handle = FFBStateRegistry::instance().internDevice(*identity);
+    return std::make_shared<FFBFilter>(policy, identity, handle);
+}
+
+// A made-up device identity. Each call gets a distinct instance GUID, so
+// registry state never leaks between tests.
+inline DeviceIdentity mockIdentity(const wchar_t* name = L"Mock Wheel") {
+    static std::atomic<unsigned long> next{1};
+    DeviceIdentity id;
+    id.instanceGuid.Data1 = next.fetch_add(1);
+    id.productGuid.Data1  = 0x12345678;
+    id.productName        = name;
+    return id;
+}
+
+// An FFBFilter for a fresh made-up device.
+inline std::shared_ptr<FFBFilter> makeMockFilter(const FFBPolicy& policy,
+                                                 const wchar_t* name = L"Mock Wheel") {
+    return makeMockFilter(policy, mockIdentity(name));
+}
+
+// ============================================================================
+// Device session
+// ============================================================================
+
+// One device object's lifetime as the game sees it: a WrapperDevice8 over a
+// fresh MockDevice. Effects made with create() are released, then the
+// device, when the session ends; two sessions on one identity are the
+// device before and after a reconnect.
+struct MockDeviceSession {
+    MockDevice*                      device = new MockDevice;   // the session's reference
+    std::shared_ptr<FFBFilter>       filter;
+    WrapperDevice8<true>*            wrapper = nullptr;
+    std::vector<IDirectInputEffect*> effects;
+
+    MockDeviceSession(const FFBPolicy& policy, const DeviceIdentity& identity)
+        : filter(makeMockFilter(policy, identity))
+    {
+        device->AddRef();   // the wrapper's reference
+        wrapper = new WrapperDevice8<true>(device, filter);
+    }
+
+    ~MockDeviceSession() {
+        for (IDirectInputEffect* e : effects) e->Release();
+        wrapper->Release();
+        filter.reset();     // releases the registry device
+        device->Release();
+    }
+
+    MockDeviceSession(const MockDeviceSession&) = delete;
+    MockDeviceSession& operator=(const MockDeviceSession&) = delete;
+
+    // CreateEffect through the wrapper; nullptr if it failed.
+    IDirectInputEffect* create(REFGUID guid, LPCDIEFFECT params = nullptr) {
+        IDirectInputEffect* effect = nullptr;
+        if (FAILED(wrapper->CreateEffect(guid, params, &effect, nullptr)) || !effect)
+            return nullptr;
+        effects.push_back(effect);
+        return effect;
+    }
+
+    // The device-side effect behind the i-th successful create().
+    MockEffect* mock(size_t i) const { return device->effects().at(i); }
+};
@@ -0,0 +1,169 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026 Valmantas Paliksa
+//
+// Coalescing ([FFB] CoalesceHz) against a slow mock device: the game thread
+// must not pay the device's write latency, a burst must collapse into about
+// one device write per period, and the newest value must still reach the
+// device within a couple of periods. DIEP_NODOWNLOAD / DIEP_NORESTART
+// survive a merge only if every merged call carried them.
+//
+// Windows only (dinput8_win_test): the worker and mailbox are built on
+// SRWLOCK and Win32 events, so the portable CTest run does not include it.
+
+#include "mock_dinput.h"
+#include "test_util.h"
+#include "wrapper_effect.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+constexpr int   kHz          = 100;          // 10 ms flush period
+constexpr DWORD kDeviceMs    = 4;            // per HID write
+constexpr int   kBurst       = 400;
+constexpr int   kProbes      = 20;
+constexpr double kPeriodSec  = 1.0 / kHz;
+
+using Clock = std::chrono::steady_clock;
+
+LONG sentMagnitude(MockEffect* mock) {
+    DICONSTANTFORCE cf;
+    std::memcpy(&cf, mock->lastParams().typeSpecific, sizeof(cf));
+    return cf.lMagnitude;
+}
+
+double median(std::vector<double> v) {
+    std::sort(v.begin(), v.end());
+    return v[v.size() / 2];
+}
+
+// Posts A then B right after an unthrottled write has landed, so both wait
+// out the same period and merge; returns the flags B reached the device with.
+DWORD mergedFlags(WrapperEffect* effect, MockEffect* mock, DWORD flagsA, DWORD flagsB) {
+    DICONSTANTFORCE cf = { 0 };
+    DIEFFECT p = {};
+    p.dwSize = sizeof(DIEFFECT);
+    p.cbTypeSpecificParams = sizeof(cf);
+    p.lpvTypeSpecificParams = &cf;
+    static LONG magnitude = 200000;
+
+    Sleep(15);
+    cf.lMagnitude = ++magnitude;
+    effect->SetParameters(&p, DIEP_TYPESPECIFICPARAMS);
+    Clock::time_point t = Clock::now();
+    while (sentMagnitude(mock) != magnitude && secondsSince(t) < 0.25)
+        Sleep(0);
+
+    cf.lMagnitude = ++magnitude;
+    effect->SetParameters(&p, DIEP_TYPESPECIFICPARAMS | flagsA);
+    cf.lMagnitude = ++magnitude;
+    effect->SetParameters(&p, DIEP_TYPESPECIFICPARAMS | flagsB);
+
+    t = Clock::now();
+    while (sentMagnitude(mock) != magnitude && secondsSince(t) < 0.25)
+        Sleep(1);
+    CHECK_EQ(sentMagnitude(mock), magnitude);
+    return mock->lastParams().flags;
+}
+
+void testMergedBehavior(MockDevice* device, const FFBPolicy& policy) {
+    std::shared_ptr<FFBFilter> filter = makeMockFilter(policy);
+    IDirectInputEffect* real = nullptr;
+    device->CreateEffect(GUID_ConstantForce, nullptr, &real, nullptr);
+    MockEffect* mock = static_cast<MockEffect*>(real);
+    WrapperEffect* effect = new WrapperEffect(real, filter);
+
+    // A plain update followed by a NODOWNLOAD one must still download.
+    CHECK_EQ(mergedFlags(effect, mock, 0, DIEP_NODOWNLOAD) & DIEP_NODOWNLOAD, 0u);
+    CHECK(mock->downloaded());
+    CHECK_EQ(mergedFlags(effect, mock, DIEP_NORESTART, 0) & DIEP_NORESTART, 0u);
+    // Both asked: the flag goes through.
+    DWORD both = mergedFlags(effect, mock, DIEP_NORESTART, DIEP_NORESTART);
+    CHECK_EQ(both & DIEP_NORESTART, static_cast<DWORD>(DIEP_NORESTART));
+
+    effect->Release();
+}
+
+} // namespace
+
+int main() {
+    Config::instance().ffbDefaultScale = 100;
+
+    FFBPolicy policy = mockPolicy();
+    policy.coalesceHz = kHz;
+
+    MockDevice* device = new MockDevice;
+    device->latencyMs = kDeviceMs;
+    {
+        std::shared_ptr<FFBFilter> filter = makeMockFilter(policy);
+        CHECK(filter->worker() != nullptr);
+
+        IDirectInputEffect* real = nullptr;
+        device->CreateEffect(GUID_ConstantForce, nullptr, &real, nullptr);
+        MockEffect* mock = static_cast<MockEffect*>(real);
+        WrapperEffect* effect = new WrapperEffect(real, filter);
+
+        DICONSTANTFORCE cf = { 0 };
+        DIEFFECT p = {};
+        p.dwSize = sizeof(DIEFFECT);
+        p.cbTypeSpecificParams = sizeof(cf);
+        p.lpvTypeSpecificParams = &cf;
+
+        // Burst: one update per millisecond, timing the game's side.
+        std::vector<double> callSec;
+        callSec.reserve(kBurst);
+        int before = mock->setParametersCalls.load();
+        Clock::time_point burstStart = Clock::now();
+        for (int i = 1; i <= kBurst; ++i) {
+            cf.lMagnitude = i;
+            Clock::time_point t = Clock::now();
+            CHECK_EQ(effect->SetParameters(&p, DIEP_TYPESPECIFICPARAMS), DI_OK);
+            callSec.push_back(secondsSince(t));
+            Sleep(1);
+        }
+        double burstSec = secondsSince(burstStart);
+
+        // The game never waits for the device.
+        CHECK(median(callSec) < kDeviceMs / 1000.0 / 4);
+
+        // Wait for the tail to land, then compare write counts: at most one
+        // per period (plus the first, unthrottled write and some slack).
+        Clock::time_point wait = Clock::now();
+        while (sentMagnitude(mock) != kBurst && secondsSince(wait) < 1.0)
+            Sleep(1);
+        CHECK_EQ(sentMagnitude(mock), kBurst);
+        int writes = mock->setParametersCalls.load() - before;
+        int bound  = static_cast<int>((burstSec + secondsSince(wait)) / kPeriodSec) + 3;
+        CHECK(writes <= bound);
+        CHECK(writes < kBurst / 4);
+
+        // Latency of an isolated update: post, then watch the device.
+        std::vector<double> latency;
+        for (int i = 0; i < kProbes; ++i) {
+            Sleep(15);   // let the previous period expire
+            cf.lMagnitude = 100000 + i;
+            Clock::time_point t = Clock::now();
+            effect->SetParameters(&p, DIEP_TYPESPECIFICPARAMS);
+            while (sentMagnitude(mock) != cf.lMagnitude && secondsSince(t) < 0.25)
+                Sleep(0);
+            latency.push_back(secondsSince(t));
+            CHECK_EQ(sentMagnitude(mock), cf.lMagnitude);
+        }
+        double worst = *std::max_element(latency.begin(), latency.end());
+        CHECK(median(latency) < 2 * kPeriodSec + kDeviceMs / 1000.0);
+        CHECK(worst < 0.25);
+
+        std::printf("coalescing %d Hz, device %lu ms: %d game calls -> %d writes, "
+                    "game call median %.1f us, update latency median %.2f ms, max %.2f ms\n",
+                    kHz, static_cast<unsigned long>(kDeviceMs), kBurst, writes,
+                    median(callSec) * 1e6, median(latency) * 1e3, worst * 1e3);
+
+        effect->Release();
+    }
+    testMergedBehavior(device, policy);
+    device->Release();
+    return TEST_RESULT();
+}
@@ -0,0 +1,130 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026 Valmantas Paliksa
+//
+// [General] HotReload under load: game threads stream SetParameters to
+// their own effects while dinput8.ini is rewritten with a new DefaultScale
+// a few times. Every call that reaches the device is scaled by one of the
+// published scales as a whole, every edit is picked up, and once traffic
+// stops the next call uses the last scale. stopWatching then returns
+// promptly and later edits are ignored. Meant to be run under
+// ThreadSanitizer as well.
+
+#include "mock_dinput.h"
+#include "test_util.h"
+
+#include <cstring>
+#include <thread>
+#include <vector>
+
+namespace {
+
+const wchar_t* const kIni = L".\\test_config_reload.ini";
+
+constexpr unsigned kThreads = 4;
+constexpr int      kScales[] = { 100, 50, 25, 75 };   // first one is on disk at start
+constexpr LONG     kHigh = 8000, kLow = 4000;
+
+void writeIni(int scale) {
+    FILE* f = _wfopen(kIni, L"w");
+    CHECK(f != nullptr);
+    if (!f) return;
+    std::fprintf(f, "[FFB]\nDefaultScale=%d\n", scale);
+    std::fclose(f);
+}
+
+bool waitGeneration(uint32_t gen) {
+    for (int i = 0; i < 500 && Config::generation() < gen; ++i) Sleep(10);
+    return Config::generation() >= gen;
+}
+
+HRESULT setMagnitude(IDirectInputEffect* e, LONG magnitude) {
+    DICONSTANTFORCE cf = { magnitude };
+    DIEFFECT p = {};
+    p.dwSize = sizeof(DIEFFECT);
+    p.cbTypeSpecificParams = sizeof(cf);
+    p.lpvTypeSpecificParams = &cf;
+    return e->SetParameters(&p, DIEP_TYPESPECIFICPARAMS);
+}
+
+LONG deviceMagnitude(MockEffect* m) {
+    DICONSTANTFORCE cf;
+    std::memcpy(&cf, m->lastParams().typeSpecific, sizeof(cf));
+    return cf.lMagnitude;
+}
+
+// A magnitude the device may see: one of the sent values under one scale.
+bool published(LONG seen) {
+    for (int scale : kScales)
+        if (seen == kHigh * scale / 100 || seen == kLow * scale / 100) return true;
+    return false;
+}
+
+} // namespace
+
+int main() {
+    Config::instance().ffbDefaultScale = kScales[0];
+    writeIni(kScales[0]);
+    Config::startWatching(kIni);
+
+    MockDeviceSession s(mockPolicy(), mockIdentity(L"Reload Wheel"));
+    std::vector<IDirectInputEffect*> effects;
+    for (unsigned i = 0; i < kThreads; ++i) {
+        IDirectInputEffect* e = s.create(GUID_ConstantForce);
+        CHECK(e != nullptr);
+        if (!e) return TEST_RESULT();
+        effects.push_back(e);
+    }
+
+    std::atomic<bool> stop{false};
+    std::atomic<int>  calls{0}, failures{0}, torn{0};
+    std::vector<std::thread> game;
+    for (unsigned t = 0; t < kThreads; ++t) {
+        game.emplace_back([&, t] {
+            MockEffect* m = s.mock(t);
+            for (unsigned i = 0; !stop.load(std::memory_order_relaxed); ++i) {
+                if (setMagnitude(effects[t], (i & 1) ? kLow : kHigh) != DI_OK)
+                    failures.fetch_add(1);
+                if (!published(deviceMagnitude(m)))
+                    torn.fetch_add(1);
+                calls.fetch_add(1, std::memory_order_relaxed);
+            }
+        });
+    }
+
+    // Each edit is published while the calls keep coming.
+    const uint32_t firstGen = Config::generation();
+    uint32_t gen = firstGen;
+    for (size_t i = 1; i < sizeof(kScales) / sizeof(kScales[0]); ++i) {
+        Sleep(50);
+        writeIni(kScales[i]);
+        CHECK(waitGeneration(++gen));
+        CHECK_EQ(Config::current().ffbDefaultScale, kScales[i]);
+    }
+    Sleep(50);
+    stop.store(true);
+    for (std::thread& t : game) t.join();
+
+    std::printf("%d SetParameters across %u reloads\n", calls.load(), gen - firstGen);
+    CHECK(calls.load() > 0);
+    CHECK_EQ(failures.load(), 0);
+    CHECK_EQ(torn.load(), 0);
+
+    // The last scale applies from here on, whatever the device had before.
+    const int last = kScales[sizeof(kScales) / sizeof(kScales[0]) - 1];
+    for (unsigned t = 0; t < kThreads; ++t) {
+        CHECK_EQ(setMagnitude(effects[t], 2000), DI_OK);
+        CHECK_EQ(deviceMagnitude(s.mock(t)), 2000 * last / 100);
+    }
+
+    // Stopping is prompt, and the watcher is gone: edits no longer apply.
+    auto t = std::chrono::steady_clock::now();
+    Config::stopWatching();
+    CHECK(secondsSince(t) < 0.5);
+    writeIni(10);
+    Sleep(600);
+    CHECK_EQ(Config::generation(), gen);
+    CHECK_EQ(Config::current().ffbDefaultScale, last);
+
+    DeleteFileW(kIni);
+    return TEST_RESULT();
+}
@@ -0,0 +1,153 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026 Valmantas Paliksa
+//
+// DeviceHealth driven by scripted results and times (Idle -> Healthy ->
+// Lost -> Recovered, the re-acquire interval, the game's Unacquire while
+// Lost), then the same transitions through WrapperDevice8 over a mock
+// device that is unplugged and plugged back in.
+
+#include "device_health.h"
+#include "mock_dinput.h"
+#include "test_util.h"
+
+namespace {
+
+using State = DeviceHealth::State;
+using Event = DeviceHealth::Event;
+
+constexpr DWORD kRetryMs = 100;
+
+void testLostAndRecovered() {
+    DeviceHealth h(kRetryMs);
+    CHECK(h.state() == State::Idle);
+
+    // The game reading before it acquired is its own doing.
+    CHECK(h.onInput(DIERR_NOTACQUIRED, 1000) == Event::None);
+    CHECK(h.state() == State::Idle);
+    CHECK(!h.shouldReacquire(1000));
+
+    CHECK(h.onAcquire(DI_OK, 1000) == Event::None);
+    CHECK(h.state() == State::Healthy);
+    CHECK(h.onInput(DI_OK, 1010) == Event::None);
+
+    // Unplugged: one Lost event, later failures are quiet.
+    CHECK(h.onInput(DIERR_INPUTLOST, 2000) == Event::Lost);
+    CHECK(h.state() == State::Lost);
+    CHECK(h.onInput(DIERR_INPUTLOST, 2001) == Event::None);
+    CHECK(h.onInput(DIERR_NOTACQUIRED, 2002) == Event::None);
+
+    // First attempt at once, then at most one per interval.
+    CHECK(h.shouldReacquire(2000));
+    CHECK(h.onAcquire(DIERR_INPUTLOST, 2000) == Event::None);
+    CHECK(!h.shouldReacquire(2000));
+    CHECK(!h.shouldReacquire(2000 + kRetryMs - 1));
+    CHECK(h.shouldReacquire(2000 + kRetryMs));
+    CHECK(h.onAcquire(DIERR_INPUTLOST, 2000 + kRetryMs) == Event::None);
+    CHECK(!h.shouldReacquire(2000 + 2 * kRetryMs - 1));
+    CHECK(h.state() == State::Lost);
+
+    // Back: the third attempt succeeds.
+    CHECK(h.shouldReacquire(2000 + 2 * kRetryMs));
+    CHECK(h.onAcquire(DI_OK, 2000 + 2 * kRetryMs + 5) == Event::Recovered);
+    CHECK(h.state() == State::Healthy);
+    CHECK_EQ(h.lastOutageMs(), 2 * kRetryMs + 5);
+    CHECK_EQ(h.lastAttempts(), 3u);
+    CHECK(!h.shouldReacquire(5000));
+    CHECK(h.onInput(DI_OK, 5000) == Event::None);
+}
+
+void testRecoveredByGame() {
+    DeviceHealth h(kRetryMs);
+    CHECK(h.onAcquire(DI_OK, 0) == Event::None);
+    CHECK(h.onInput(DIERR_NOTACQUIRED, 100) == Event::Lost);   // acquisition taken away
+
+    // The game re-acquires on its own: that ends the outage too.
+    CHECK(h.onAcquire(DI_OK, 150) == Event::Recovered);
+    CHECK_EQ(h.lastOutageMs(), 50u);
+    CHECK_EQ(h.lastAttempts(), 1u);
+
+    // Or reads simply start working again (someone else acquired it).
+    CHECK(h.onInput(DIERR_INPUTLOST, 200) == Event::Lost);
+    CHECK(h.onInput(DI_OK, 320) == Event::Recovered);
+    CHECK_EQ(h.lastOutageMs(), 120u);
+    CHECK_EQ(h.lastAttempts(), 0u);
+
+    // Errors other than lost input are not an outage.
+    CHECK(h.onInput(DIERR_INVALIDPARAM, 400) == Event::None);
+    CHECK(h.state() == State::Healthy);
+}
+
+void testUnacquireWhileLost() {
+    DeviceHealth h(kRetryMs);
+    CHECK(h.onAcquire(DI_OK, 0) == Event::None);
+    CHECK(h.onInput(DIERR_INPUTLOST, 10) == Event::Lost);
+    CHECK(h.shouldReacquire(10));
+
+    // The game lets go: no more re-acquiring, and no Recovered later.
+    h.onUnacquire();
+    CHECK(h.state() == State::Idle);
+    CHECK(!h.shouldReacquire(10 + 10 * kRetryMs));
+    CHECK(h.onInput(DIERR_NOTACQUIRED, 500) == Event::None);
+    CHECK(h.onAcquire(DI_OK, 600) == Event::None);
+    CHECK(h.state() == State::Healthy);
+}
+
+// ----------------------------------------------------------------------------
+// Through the wrapper
+// ----------------------------------------------------------------------------
+
+HRESULT read(MockDeviceSession& s) {
+    DIJOYSTATE state;
+    return s.wrapper->GetDeviceState(sizeof(state), &state);
+}
+
+void testWrapper() {
+    Config::instance().ffbAutoReacquire = true;
+    const DWORD retryMs = DeviceHealth::kDefaultRetryMs;
+
+    MockDeviceSession s(mockPolicy(), mockIdentity(L"Health Wheel"));
+    CHECK_EQ(read(s), DIERR_NOTACQUIRED);   // Idle: not re-acquired behind the game
+    CHECK_EQ(s.device->acquireCalls.load(), 0);
+
+    CHECK_EQ(s.wrapper->Acquire(), DI_OK);
+    CHECK_EQ(read(s), DI_OK);
+
+    // Unplugged: re-acquired once straight away, then once per interval.
+    s.device->unplugged = true;
+    ULONGLONG lostAt = GetTickCount64();
+    CHECK_EQ(read(s), DIERR_INPUTLOST);
+    CHECK_EQ(s.device->acquireCalls.load(), 2);
+    for (int i = 0; i < 10; ++i)
+        CHECK_EQ(read(s), DIERR_INPUTLOST);
+    if (GetTickCount64() - lostAt < retryMs)
+        CHECK_EQ(s.device->acquireCalls.load(), 2);
+
+    // Plugged back in: the first read after the interval re-acquires and
+    // returns data.
+    s.device->unplugged = false;
+    Sleep(retryMs + 20);
+    CHECK_EQ(read(s), DI_OK);
+    CHECK_EQ(s.device->acquireCalls.load(), 3);
+    CHECK(s.device->acquired());
+
+    // Lost again, and this time the game unacquires during the outage.
+    s.device->unplugged = true;
+    CHECK_EQ(read(s), DIERR_INPUTLOST);
+    int attempts = s.device->acquireCalls.load();
+    CHECK_EQ(s.wrapper->Unacquire(), DI_OK);
+    s.device->unplugged = false;
+    Sleep(retryMs + 20);
+    CHECK_EQ(read(s), DIERR_NOTACQUIRED);
+    CHECK_EQ(s.device->acquireCalls.load(), attempts);
+    CHECK(!s.device->acquired());
+}
+
+} // namespace
+
+int main() {
+    testLostAndRecovered();
+    testRecoveredByGame();
+    testUnacquireWhileLost();
+    testWrapper();
+    return TEST_RESULT();
+}
@@ -0,0 +1,114 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026 Valmantas Paliksa
+//
+// DeviceRuleMatcher against the straightforward answer: for every rule in
+// order, lower-case both strings and wcsstr. Hand-picked cases first, then
+// random rule sets over a small mixed-case alphabet, so patterns overlap,
+// nest and share suffixes far more often than real product names do.
+
+#include "device_rule_matcher.h"
+#include "test_util.h"
+
+#include <cwchar>
+#include <cwctype>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+using Pattern = DeviceRuleMatcher::Pattern;
+
+std::wstring lower(std::wstring s) {
+    for (wchar_t& c : s) c = static_cast<wchar_t>(towlower(c));
+    return s;
+}
+
+size_t naiveFirstMatch(const std::vector<Pattern>& patterns, const std::wstring& text) {
+    std::wstring t = lower(text);
+    size_t best = DeviceRuleMatcher::kNoMatch;
+    for (const Pattern& p : patterns)
+        if (p.rule < best && std::wcsstr(t.c_str(), lower(p.text).c_str()))
+            best = p.rule;
+    return best;
+}
+
+void testExamples() {
+    std::vector<Pattern> patterns = {
+        { 0, L"Fanatec" }, { 2, L"CSL" }, { 3, L"fanatec csl" },
+        { 5, L"sher" },    { 6, L"she" }, { 7, L"hers" },
+    };
+    DeviceRuleMatcher m;
+    m.build(patterns);
+    CHECK_EQ(m.patternCount(), patterns.size());
+
+    CHECK_EQ(m.firstMatch(L"FANATEC CSL DD"), 0u);   // earlier rule beats longer match
+    CHECK_EQ(m.firstMatch(L"Podium CSL"), 2u);
+    CHECK_EQ(m.firstMatch(L"ushers"), 5u);           // found through failure links
+    CHECK_EQ(m.firstMatch(L"ushe"), 6u);
+    CHECK_EQ(m.firstMatch(L"hers"), 7u);
+    CHECK_EQ(m.firstMatch(L"Logitech G29"), DeviceRuleMatcher::kNoMatch);
+    CHECK_EQ(m.firstMatch(L""), DeviceRuleMatcher::kNoMatch);
+    CHECK_EQ(m.firstMatch(nullptr), DeviceRuleMatcher::kNoMatch);
+
+    // An empty pattern matches everything, but only wins in its turn.
+    patterns.push_back({ 4, L"" });
+    m.build(patterns);
+    CHECK_EQ(m.firstMatch(L"Logitech G29"), 4u);
+    CHECK_EQ(m.firstMatch(L""), 4u);
+    CHECK_EQ(m.firstMatch(L"Podium CSL"), 2u);
+
+    DeviceRuleMatcher empty;
+    CHECK_EQ(empty.firstMatch(L"anything"), DeviceRuleMatcher::kNoMatch);
+    empty.build({});
+    CHECK_EQ(empty.firstMatch(L"anything"), DeviceRuleMatcher::kNoMatch);
+}
+
+std::wstring randomString(std::mt19937& rng, size_t minLen, size_t maxLen) {
+    static const wchar_t kAlphabet[] = L"abcABC 1";
+    std::uniform_int_distribution<size_t> len(minLen, maxLen);
+    std::uniform_int_distribution<size_t> pick(0, sizeof(kAlphabet) / sizeof(wchar_t) - 2);
+    std::wstring s(len(rng), L' ');
+    for (wchar_t& c : s) c = kAlphabet[pick(rng)];
+    return s;
+}
+
+void testRandom() {
+    std::mt19937 rng(22);
+    int mismatches = 0;
+    for (int round = 0; round < 2000; ++round) {
+        // Rule indices ascend with gaps (VID/PID and GUID rules sit between
+        // name rules), a few patterns repeat, and now and then one is empty.
+        std::vector<Pattern> patterns;
+        size_t rule = 0, count = 1 + rng() % 12;
+        for (size_t i = 0; i < count; ++i) {
+            rule += 1 + rng() % 3;
+            std::wstring text;
+            if (!patterns.empty() && rng() % 8 == 0)
+                text = patterns[rng() % patterns.size()].text;
+            else if (rng() % 40 != 0)
+                text = randomString(rng, 1, 5);
+            patterns.push_back({ rule, text });
+        }
+        DeviceRuleMatcher m;
+        m.build(patterns);
+
+        for (int q = 0; q < 50; ++q) {
+            std::wstring text = randomString(rng, 0, 24);
+            size_t expected = naiveFirstMatch(patterns, text);
+            size_t got = m.firstMatch(text.c_str());
+            if (got != expected && ++mismatches <= 5)
+                std::fprintf(stderr, "round %d: \"%ls\" -> %zu, expected %zu\n",
+                             round, text.c_str(), got, expected);
+        }
+    }
+    CHECK_EQ(mismatches, 0);
+}
+
+} // namespace
+
+int main() {
+    testExamples();
+    testRandom();
+    return TEST_RESULT();
+}
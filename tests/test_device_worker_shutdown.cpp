@@ -0,0 +1,57 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026 Valmantas Paliksa
+//
+// FFBDeviceWorker teardown: every command accepted before shutdown() runs,
+// in order, however slow the device, and the thread is gone afterwards.
+
+#include "ffb_device_worker.h"
+#include "test_util.h"
+
+#include <vector>
+
+namespace {
+
+struct Recorder {
+    std::vector<DWORD> seen;   // worker thread only until the join
+};
+
+HRESULT slowCommand(void* target, DWORD arg0, DWORD /*arg1*/) {
+    Sleep(2);   // a HID write
+    static_cast<Recorder*>(target)->seen.push_back(arg0);
+    return S_OK;
+}
+
+void testDrainOnShutdown() {
+    constexpr DWORD kCommands = 100;   // ~200 ms of device time
+    Recorder rec;
+    {
+        FFBDeviceWorker worker(0, true, L"Mock Wheel");
+        CHECK(worker.running());
+        for (DWORD i = 0; i < kCommands; ++i)
+            worker.enqueue(&slowCommand, &rec, i, 0, FFBTraceMethod::Start);
+        worker.shutdown();
+        CHECK(!worker.running());
+        CHECK_EQ(rec.seen.size(), kCommands);
+        worker.shutdown();   // idempotent; the destructor calls it again
+    }
+    for (DWORD i = 0; i < rec.seen.size(); ++i)
+        CHECK_EQ(rec.seen[i], i);
+}
+
+void testDestructorDrains() {
+    Recorder rec;
+    {
+        FFBDeviceWorker worker(0, true, L"Mock Wheel");
+        for (DWORD i = 0; i < 10; ++i)
+            worker.enqueue(&slowCommand, &rec, i, 0, FFBTraceMethod::Stop);
+    }
+    CHECK_EQ(rec.seen.size(), 10u);
+}
+
+} // namespace
+
+int main() {
+    testDrainOnShutdown();
+    testDestructorDrains();
+    return TEST_RESULT();
+}
@@ -0,0 +1,81 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026 Valmantas Paliksa
+//
+// Per-effect-type actions in [FFBDevices]: "Type:block" keeps the type off
+// the device (the game gets a silent stand-in), while "Type:0" is a scale
+// like any other and still creates the effect, at zero force. A device-wide
+// "0" keeps meaning FFB off for the device.
+
+#include "mock_dinput.h"
+#include "test_util.h"
+
+#include <cstring>
+
+namespace {
+
+const wchar_t* const kIni = L".\\test_effect_type_rules.ini";
+
+size_t idx(EffectKind k) { return effectKindIndex(k); }
+
+void testPolicy() {
+    FFBPolicy p = FFBFilter::resolvePolicy(Config::current(), mockIdentity(L"Rule Wheel"));
+    CHECK(p.enabled);
+    CHECK_EQ(p.scale, 80);
+    CHECK(p.effectBlocked[idx(EffectKind::Sine)]);
+    CHECK(!p.effectBlocked[idx(EffectKind::Spring)]);
+    CHECK_EQ(p.effectScale[idx(EffectKind::Spring)], 0);
+    CHECK(!p.effectBlocked[idx(EffectKind::Damper)]);
+    CHECK_EQ(p.effectScale[idx(EffectKind::Damper)], 100);
+    CHECK(!p.effectBlocked[idx(EffectKind::ConstantForce)]);
+    CHECK_EQ(p.effectScale[idx(EffectKind::ConstantForce)], 80);
+
+    FFBPolicy off = FFBFilter::resolvePolicy(Config::current(), mockIdentity(L"Zero Pedals"));
+    CHECK(!off.enabled);
+    FFBPolicy blocked = FFBFilter::resolvePolicy(Config::current(), mockIdentity(L"vJoy"));
+    CHECK(!blocked.enabled);
+}
+
+void testWrapper() {
+    MockDeviceSession s(FFBFilter::resolvePolicy(Config::current(), mockIdentity(L"Rule Wheel")),
+                        mockIdentity(L"Rule Wheel"));
+
+    CHECK(s.create(GUID_Sine) != nullptr);          // stand-in only
+    CHECK_EQ(s.device->effects().size(), 0u);
+
+    DICONDITION cond = {};
+    cond.lPositiveCoefficient = 6000;
+    cond.lNegativeCoefficient = 6000;
+    DIEFFECT eff = {};
+    eff.dwSize = sizeof(DIEFFECT);
+    eff.dwGain = DI_FFNOMINALMAX;
+    eff.cbTypeSpecificParams = sizeof(cond);
+    eff.lpvTypeSpecificParams = &cond;
+    IDirectInputEffect* spring = s.create(GUID_Spring);
+    CHECK(spring != nullptr);
+    CHECK_EQ(s.device->effects().size(), 1u);        // on the device, silenced
+    if (!spring || s.device->effects().empty()) return;
+    CHECK_EQ(spring->SetParameters(&eff, DIEP_TYPESPECIFICPARAMS), DI_OK);
+    DICONDITION sent;
+    std::memcpy(&sent, s.mock(0)->lastParams().typeSpecific, sizeof(sent));
+    CHECK_EQ(sent.lPositiveCoefficient, 0);
+    CHECK_EQ(sent.lNegativeCoefficient, 0);
+}
+
+} // namespace
+
+int main() {
+    FILE* f = _wfopen(kIni, L"w");
+    CHECK(f != nullptr);
+    if (!f) return TEST_RESULT();
+    std::fprintf(f, "[FFBDevices]\n"
+                    "vJoy=block\n"
+                    "Zero Pedals=0\n"
+                    "Rule Wheel=80, Sine:block, Spring:0, Damper:allow\n");
+    std::fclose(f);
+    CHECK(Config::instance().load(kIni));
+    DeleteFileW(kIni);
+
+    testPolicy();
+    testWrapper();
+    return TEST_RESULT();
+}
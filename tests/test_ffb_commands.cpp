@@ -0,0 +1,135 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026 Valmantas Paliksa
+//
+// SendForceFeedbackCommand and the effect-state registry, table driven.
+// Each row starts from two running ConstantForces and a stopped Sine, sends
+// its commands through the wrapper, and checks the registry (running state,
+// pause, cleared records) and the mock device. Then the device reconnects:
+// exactly the effects still marked running must restart, and a device that
+// went away paused must be paused again first.
+
+#include "mock_dinput.h"
+#include "test_util.h"
+#include "wrapper_effect.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr size_t kEffects = 3;   // ConstantForce#0, ConstantForce#1, Sine#0
+
+struct Row {
+    const char*        name;
+    std::vector<DWORD> commands;
+    bool               running[kEffects];   // registry wasRunning afterwards
+    bool               paused;               // registry and device
+    bool               cleared;              // records wiped (RESET)
+};
+
+const Row kRows[] = {
+    { "nothing",            {},                                           { true,  true,  false }, false, false },
+    { "STOPALL",            { DISFFC_STOPALL },                           { false, false, false }, false, false },
+    { "PAUSE",              { DISFFC_PAUSE },                             { true,  true,  false }, true,  false },
+    { "PAUSE CONTINUE",     { DISFFC_PAUSE, DISFFC_CONTINUE },            { true,  true,  false }, false, false },
+    { "CONTINUE unpaused",  { DISFFC_CONTINUE },                          { true,  true,  false }, false, false },
+    { "RESET",              { DISFFC_RESET },                             { false, false, false }, false, true  },
+    { "PAUSE RESET",        { DISFFC_PAUSE, DISFFC_RESET },               { false, false, false }, false, true  },
+    { "PAUSE PAUSE",        { DISFFC_PAUSE, DISFFC_PAUSE },               { true,  true,  false }, true,  false },
+    { "ACTUATORS OFF ON",   { DISFFC_SETACTUATORSOFF, DISFFC_SETACTUATORSON },
+                                                                          { true,  true,  false }, false, false },
+};
+
+const GUID* const kGuids[kEffects] = { &GUID_ConstantForce, &GUID_ConstantForce, &GUID_Sine };
+
+HRESULT setParams(IDirectInputEffect* effect, LONG magnitude) {
+    DICONSTANTFORCE cf = { magnitude };
+    DIPERIODIC pe = { static_cast<DWORD>(magnitude), 0, 0, 20000 };
+    bool constant = static_cast<WrapperEffect*>(effect)->instanceId().kind ==
+                    EffectKind::ConstantForce;
+    DIEFFECT p = {};
+    p.dwSize = sizeof(DIEFFECT);
+    p.dwDuration = INFINITE;
+    p.cbTypeSpecificParams = constant ? sizeof(cf) : sizeof(pe);
+    p.lpvTypeSpecificParams = constant ? static_cast<void*>(&cf) : static_cast<void*>(&pe);
+    return effect->SetParameters(&p, DIEP_DURATION | DIEP_TYPESPECIFICPARAMS);
+}
+
+bool contains(const std::vector<DWORD>& v, DWORD x) {
+    return std::find(v.begin(), v.end(), x) != v.end();
+}
+
+void runRow(const Row& row, const FFBPolicy& policy) {
+    // A product of its own, so the row never adopts another row's idle slot.
+    const std::string name(row.name);
+    const DeviceIdentity identity =
+        mockIdentity(std::wstring(name.begin(), name.end()).c_str());
+    EffectInstanceId ids[kEffects];
+
+    {
+        MockDeviceSession s(policy, identity);
+        for (size_t i = 0; i < kEffects; ++i) {
+            IDirectInputEffect* e = s.create(*kGuids[i]);
+            CHECK(e != nullptr);
+            if (!e) return;
+            ids[i] = static_cast<WrapperEffect*>(e)->instanceId();
+            CHECK_EQ(setParams(e, 1000 * static_cast<LONG>(i + 1)), DI_OK);
+            CHECK_EQ(e->Start(1, 0), DI_OK);
+        }
+        CHECK_EQ(s.effects[2]->Stop(), DI_OK);
+
+        for (DWORD cmd : row.commands)
+            CHECK_EQ(s.wrapper->SendForceFeedbackCommand(cmd), DI_OK);
+
+        FFBDeviceSnapshotPtr snap =
+            FFBStateRegistry::instance().snapshot(s.filter->registryDevice());
+        CHECK_EQ(snap->paused, row.paused);
+        CHECK_EQ(s.device->paused(), row.paused);
+        for (size_t i = 0; i < kEffects; ++i) {
+            const EffectStateRecord* rec = snap->find(ids[i]);
+            CHECK(rec != nullptr);
+            if (!rec) continue;
+            CHECK_EQ(rec->wasRunning, row.running[i]);
+            CHECK_EQ(rec->hasParams, !row.cleared);
+            // The device agrees about what is playing.
+            CHECK_EQ(s.mock(i)->playing(), row.running[i]);
+        }
+    }
+
+    // Reconnect: the game re-creates the same effects without parameters.
+    MockDeviceSession s(policy, identity);
+    for (size_t i = 0; i < kEffects; ++i)
+        CHECK(s.create(*kGuids[i]) != nullptr);
+    if (s.effects.size() != kEffects) return;
+
+    bool anyRunning = false;
+    for (size_t i = 0; i < kEffects; ++i) anyRunning |= row.running[i];
+    for (int wait = 0; wait < 200; ++wait) {
+        bool done = true;
+        for (size_t i = 0; i < kEffects; ++i)
+            done &= !row.running[i] || s.mock(i)->startCalls.load() > 0;
+        if (done) break;
+        Sleep(10);
+    }
+    Sleep(50);   // and nothing else follows
+
+    for (size_t i = 0; i < kEffects; ++i)
+        CHECK_EQ(s.mock(i)->startCalls.load() > 0, row.running[i]);
+    // Re-paused before the restart, only if something restarts into it.
+    CHECK_EQ(contains(s.device->commands(), DISFFC_PAUSE), row.paused && anyRunning);
+    CHECK_EQ(s.device->paused(), row.paused && anyRunning);
+}
+
+} // namespace
+
+int main() {
+    Config::instance().ffbRestoreRampMs = 0;
+
+    FFBPolicy policy = mockPolicy();
+    policy.autoRestart = true;
+
+    for (const Row& row : kRows)
+        runRow(row, policy);
+    return TEST_RESULT();
+}
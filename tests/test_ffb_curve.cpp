@@ -0,0 +1,173 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026 Valmantas Paliksa
+//
+// Response curves: every baked table entry is the analytic gamma / expo /
+// softlimit curve (and chains of them) rounded to the nearest magnitude,
+// signs and out-of-range values are handled as documented, and the
+// dispatched sample kernel (the AVX2 gather where available) matches the
+// scalar one bit for bit, in particular at the table edge, where the 32-bit
+// gather at maxInput also reads the padding entry maxInput + 1.
+
+#include "ffb_curve.h"
+#include "ffb_scale.h"
+#include "test_util.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <vector>
+
+namespace {
+
+using Stage = FFBCurve::Stage;
+using Step  = FFBCurve::Step;
+
+constexpr uint32_t kMax = FFBCurve::kMaxInput;
+
+// The curves as ffb_curve.h documents them, written out independently.
+double analytic(const std::vector<Step>& steps, double x) {
+    for (const Step& s : steps) {
+        double y = x;
+        if (s.stage == Stage::Gamma)     y = std::pow(x, s.param);
+        if (s.stage == Stage::Expo)      y = (1.0 - s.param) * x + s.param * x * x * x;
+        if (s.stage == Stage::SoftLimit) y = s.param * std::tanh(x / s.param);
+        x = std::min(std::max(y, 0.0), 1.0);
+    }
+    return x;
+}
+
+FFBCurvePtr bake(const char* spec) {
+    std::vector<Step> steps;
+    CHECK(FFBCurve::parse(spec, steps));
+    return FFBCurve::bake(spec, steps);
+}
+
+void testExactness() {
+    const char* const specs[] = {
+        "gamma 1.6", "gamma 0.5", "gamma 2.5", "expo 0.3", "expo 1",
+        "softlimit 0.8", "soft 0.3", "gamma 1.6 softlimit 0.8", "expo 0.5 gamma 0.7",
+    };
+    for (const char* spec : specs) {
+        std::vector<Step> steps;
+        CHECK(FFBCurve::parse(spec, steps));
+        FFBCurvePtr c = FFBCurve::bake(spec, steps);
+        const FFBCurve::Table& t = c->table();
+
+        int wrong = 0;
+        for (uint32_t i = 0; i <= kMax; ++i) {
+            double y = analytic(steps, static_cast<double>(i) / kMax) * kMax;
+            // Nearest magnitude; an exact .5 may go either way.
+            if (std::fabs(t[i] - y) > 0.5 + 1e-9 && ++wrong <= 3)
+                std::fprintf(stderr, "%s: table[%u] = %u, curve %.4f\n",
+                             spec, i, static_cast<unsigned>(t[i]), y);
+        }
+        CHECK_EQ(wrong, 0);
+        CHECK_EQ(t[kMax + 1], t[kMax]);   // padding repeats the last entry
+    }
+
+    // The end points need no rounding at all.
+    FFBCurvePtr g = bake("gamma 1.6");
+    CHECK_EQ(g->table()[0], 0u);
+    CHECK_EQ(g->table()[kMax], kMax);
+    FFBCurvePtr soft = bake("softlimit 0.5");
+    CHECK_EQ(soft->table()[kMax],
+             static_cast<uint16_t>(std::lround(0.5 * std::tanh(2.0) * kMax)));
+}
+
+void testApply() {
+    FFBCurvePtr c = bake("gamma 1.6 softlimit 0.8");
+    const FFBCurve::Table& t = c->table();
+    for (uint32_t m : { 0u, 1u, 137u, 5000u, 9999u, 10000u }) {
+        const int32_t v = static_cast<int32_t>(m);
+        CHECK_EQ(c->applySigned(v), static_cast<int32_t>(t[m]));
+        CHECK_EQ(c->applySigned(-v), -static_cast<int32_t>(t[m]));
+        CHECK_EQ(c->applyUnsigned(m), t[m]);
+    }
+    // Past DirectInput's range: the last entry, with the sign kept.
+    for (int32_t v : { 10001, 20000, std::numeric_limits<int32_t>::max() }) {
+        CHECK_EQ(c->applySigned(v), static_cast<int32_t>(t[kMax]));
+        CHECK_EQ(c->applySigned(-v), -static_cast<int32_t>(t[kMax]));
+    }
+    CHECK_EQ(c->applySigned(std::numeric_limits<int32_t>::min()),
+             -static_cast<int32_t>(t[kMax]));
+    CHECK_EQ(c->applyUnsigned(0xFFFFFFFFu), t[kMax]);
+
+    // Conditions: coefficients shaped, everything else left alone.
+    int32_t rec[6] = { 1234, 6000, -3000, 9000, 8000, 50 };
+    c->applyConditions(rec, 1);
+    CHECK_EQ(rec[0], 1234);
+    CHECK_EQ(rec[1], static_cast<int32_t>(t[6000]));
+    CHECK_EQ(rec[2], -static_cast<int32_t>(t[3000]));
+    CHECK_EQ(rec[3], 9000);
+    CHECK_EQ(rec[4], 8000);
+    CHECK_EQ(rec[5], 50);
+}
+
+// Values at and around the edge of a table of maxInput + 2 entries.
+std::vector<int32_t> edgeValues(uint32_t maxInput, std::mt19937& rng, size_t n) {
+    const int32_t m = static_cast<int32_t>(maxInput);
+    const int32_t edges[] = {
+        m, -m, m + 1, -(m + 1), m - 1, -(m - 1), m + 2, 0, 1, -1,
+        std::numeric_limits<int32_t>::max(), std::numeric_limits<int32_t>::min(),
+        std::numeric_limits<int32_t>::min() + 1,
+    };
+    std::uniform_int_distribution<int32_t> near(-(m + 3), m + 3);
+    std::vector<int32_t> v;
+    for (size_t i = 0; i < n; ++i)
+        v.push_back(i < sizeof(edges) / sizeof(edges[0]) ? edges[i] : near(rng));
+    std::shuffle(v.begin(), v.end(), rng);
+    return v;
+}
+
+void testKernelEdge(std::mt19937& rng) {
+    // The real table, and small ones whose last entries land at every
+    // position within a gather's reach. The padding entry holds a value no
+    // lookup may return; the vector is exactly maxInput + 2 entries, so a
+    // read past the padding is out of bounds for a sanitizer to see.
+    for (uint32_t maxInput : { kMax, 1u, 2u, 7u, 8u, 9u, 15u, 16u }) {
+        std::vector<uint16_t> table(maxInput + 2);
+        for (uint32_t i = 0; i <= maxInput; ++i)
+            table[i] = static_cast<uint16_t>((i * 7919u) % 10001u);
+        table[maxInput + 1] = 0xBEEF;
+
+        for (size_t len : { 1, 7, 8, 9, 16, 17, 31, 64 }) {
+            for (size_t offset : { 0, 1, 3 }) {
+                std::vector<int32_t> in = edgeValues(maxInput, rng, len);
+                std::vector<int32_t> simd(len + offset), scalar(in);
+                std::memcpy(simd.data() + offset, in.data(), len * sizeof(int32_t));
+
+                ffbCurveSamples(simd.data() + offset, len, table.data(), maxInput);
+                ffbCurveSamplesScalar(scalar.data(), len, table.data(), maxInput);
+
+                for (size_t i = 0; i < len; ++i) {
+                    CHECK_EQ(simd[i + offset], scalar[i]);
+                    int64_t mag = in[i] < 0 ? -static_cast<int64_t>(in[i]) : in[i];
+                    int32_t e = table[mag < maxInput ? static_cast<size_t>(mag) : maxInput];
+                    CHECK_EQ(scalar[i], in[i] < 0 ? -e : e);
+                }
+            }
+        }
+    }
+
+    // Through FFBCurve, the path the wrapper takes.
+    FFBCurvePtr c = bake("expo 0.4");
+    std::vector<int32_t> in = edgeValues(kMax, rng, 1000);
+    std::vector<int32_t> out(in);
+    c->applySamples(out.data(), out.size());
+    for (size_t i = 0; i < in.size(); ++i)
+        CHECK_EQ(out[i], c->applySigned(in[i]));
+}
+
+} // namespace
+
+int main() {
+    std::printf("kernel: %s\n", ffbScaleKernelName());
+    std::mt19937 rng(25);
+    testExactness();
+    testApply();
+    testKernelEdge(rng);
+    return TEST_RESULT();
+}
@@ -0,0 +1,124 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026 Valmantas Paliksa
+//
+// Force scaling: the dispatched kernel (AVX2/SSE2, or whatever
+// DINPUT8_FFB_KERNEL pins) must match the scalar reference bit for bit, and
+// both must equal trunc(v * percent / 100) inside DirectInput's range.
+
+#include "ffb_scale.h"
+#include "test_util.h"
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <vector>
+
+namespace {
+
+int32_t exact(int32_t v, int percent) {
+    return static_cast<int32_t>(static_cast<int64_t>(v) * percent / 100);
+}
+
+std::vector<int32_t> sampleValues(std::mt19937& rng, size_t n) {
+    static const int32_t edges[] = {
+        0, 1, -1, 99, -99, 100, -100, 10000, -10000, 10001, -10001,
+        42949671, -42949671,
+        std::numeric_limits<int32_t>::max(), std::numeric_limits<int32_t>::min(),
+    };
+    std::uniform_int_distribution<int32_t> nominal(-10000, 10000);
+    std::uniform_int_distribution<int32_t> wide(std::numeric_limits<int32_t>::min(),
+                                                std::numeric_limits<int32_t>::max());
+    std::vector<int32_t> v;
+    for (size_t i = 0; i < n; ++i) {
+        if (i < sizeof(edges) / sizeof(edges[0])) v.push_back(edges[i]);
+        else v.push_back(i % 4 ? nominal(rng) : wide(rng));
+    }
+    return v;
+}
+
+void testSamples(std::mt19937& rng) {
+    // Lengths around the vector widths exercise every tail; the offset
+    // misaligns the buffer for the unaligned loads.
+    for (int percent = 0; percent <= 100; ++percent) {
+        FFBScaleFactor f = ffbMakeScaleFactor(percent);
+        for (size_t len : { 0, 1, 3, 4, 5, 7, 8, 9, 15, 16, 17, 33, 1000 }) {
+            for (size_t offset : { 0, 1 }) {
+                std::vector<int32_t> in = sampleValues(rng, len);
+                std::vector<int32_t> simd(len + offset), scalar(in);
+                std::memcpy(simd.data() + offset, in.data(), len * sizeof(int32_t));
+
+                ffbScaleSamples(simd.data() + offset, len, f);
+                ffbScaleSamplesScalar(scalar.data(), len, f);
+
+                for (size_t i = 0; i < len; ++i) {
+                    CHECK_EQ(simd[i + offset], scalar[i]);
+                    int64_t mag = in[i] < 0 ? -static_cast<int64_t>(in[i]) : in[i];
+                    if (mag < 42949672)
+                        CHECK_EQ(scalar[i], exact(in[i], percent));
+                }
+            }
+        }
+    }
+}
+
+void testConditions(std::mt19937& rng) {
+    std::uniform_int_distribution<int32_t> coeff(-10000, 10000);
+    std::uniform_int_distribution<int32_t> sat(0, 10000);
+    for (int percent : { 0, 1, 33, 50, 75, 99, 100, 150 }) {
+        FFBScaleFactor f = ffbMakeScaleFactor(percent);
+        for (size_t count : { 1, 2, 3, 5 }) {
+            std::vector<int32_t> in(count * 6);
+            for (size_t i = 0; i < count; ++i) {
+                int32_t* c = in.data() + i * 6;
+                c[0] = coeff(rng); c[1] = coeff(rng); c[2] = coeff(rng);
+                c[3] = sat(rng);   c[4] = sat(rng);   c[5] = sat(rng);
+            }
+            std::vector<int32_t> simd(in), scalar(in);
+            ffbScaleConditions(simd.data(), count, f);
+            ffbScaleConditionsScalar(scalar.data(), count, f);
+            for (size_t i = 0; i < in.size(); ++i) CHECK_EQ(simd[i], scalar[i]);
+
+            int p = percent > 100 ? 100 : percent;
+            for (size_t i = 0; i < count; ++i) {
+                const int32_t* c = in.data() + i * 6;
+                const int32_t* r = scalar.data() + i * 6;
+                CHECK_EQ(r[0], c[0]);                 // offset untouched
+                CHECK_EQ(r[1], exact(c[1], p));
+                CHECK_EQ(r[2], exact(c[2], p));
+                CHECK_EQ(r[3], exact(c[3], p));
+                CHECK_EQ(r[4], exact(c[4], p));
+                CHECK_EQ(r[5], c[5]);                 // dead band untouched
+            }
+        }
+    }
+}
+
+void testFactor() {
+    CHECK(ffbMakeScaleFactor(100).identity);
+    CHECK(ffbMakeScaleFactor(250).identity);
+    CHECK(!ffbMakeScaleFactor(0).identity);
+    CHECK_EQ(ffbMakeScaleFactor(-5).mul, 0u);
+    CHECK_EQ(ffbScaleSigned(std::numeric_limits<int32_t>::min(), ffbMakeScaleFactor(50)),
+             -1073741824);
+    CHECK_EQ(ffbScaleUnsigned(10000u, ffbMakeScaleFactor(99)), 9900u);
+    CHECK(ffbScaleUnsigned(0xFFFFFFFFu, ffbMakeScaleFactor(99)) < 0xFFFFFFFFu);   // no wrap
+}
+
+} // namespace
+
+int main() {
+    std::printf("kernel: %s\n", ffbScaleKernelName());
+    if (const char* pinned = std::getenv("DINPUT8_FFB_KERNEL")) {
+        // sse2 cannot be pinned on a machine without it.
+        if (std::strcmp(pinned, "scalar") == 0)
+            CHECK(std::strcmp(ffbScaleKernelName(), "scalar") == 0);
+    }
+
+    std::mt19937 rng(12345);
+    testFactor();
+    testSamples(rng);
+    testConditions(rng);
+    return TEST_RESULT();
+}
@@ -0,0 +1,113 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026 Valmantas Paliksa
+//
+// FFBTrace::record reads only the DIEFFECT members the call declares valid.
+// Members outside the SetParameters flags carry pointers that would fault if
+// they were followed.
+
+#include "ffb_trace.h"
+#include "test_util.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+namespace {
+
+// Never dereferenced when the matching DIEP_* flag is absent.
+template<typename T>
+T* poison() { return reinterpret_cast<T*>(static_cast<uintptr_t>(0x10)); }
+
+std::vector<FFBTraceRecord> readRecords() {
+    std::vector<FFBTraceRecord> out;
+    FILE* f = std::fopen("dinput8_ffb_trace.bin", "rb");
+    if (!f) return out;
+    FFBTraceFileHeader header = {};
+    if (std::fread(&header, sizeof(header), 1, f) == 1 &&
+        std::fseek(f, static_cast<long>(header.headerSize), SEEK_SET) == 0)
+    {
+        FFBTraceRecord r;
+        while (std::fread(&r, sizeof(r), 1, f) == 1 && r.sequence)
+            out.push_back(r);
+    }
+    std::fclose(f);
+    return out;
+}
+
+} // namespace
+
+int main() {
+    auto& trace = FFBTrace::instance();
+    CHECK(trace.open(L".", 1));
+
+    DIENVELOPE envelope = { sizeof(DIENVELOPE), 1000, 2000, 3000, 4000 };
+    DWORD axes[2] = { DIJOFS_X, DIJOFS_Y };
+    LONG directions[2] = { 9000, 0 };
+    DICONSTANTFORCE cf = { 5000 };
+
+    // 1. Gain only: axes, direction, envelope and type-specific are poison.
+    DIEFFECT gainOnly = {};
+    gainOnly.dwSize = sizeof(DIEFFECT);
+    gainOnly.dwGain = 7500;
+    gainOnly.cAxes = 2;
+    gainOnly.rgdwAxes = poison<DWORD>();
+    gainOnly.rglDirection = poison<LONG>();
+    gainOnly.lpEnvelope = poison<DIENVELOPE>();
+    gainOnly.cbTypeSpecificParams = sizeof(DICONSTANTFORCE);
+    gainOnly.lpvTypeSpecificParams = poison<void>();
+    trace.record(FFBTraceMethod::SetParameters, 0, EffectKind::ConstantForce, 1, DI_OK,
+                 &gainOnly, DIEP_GAIN, kFFBTraceParamsForwarded);
+
+    // 2. Envelope and type-specific, DX5-sized: dwStartDelay is past the end.
+    DIEFFECT dx5 = {};
+    dx5.dwSize = sizeof(DIEFFECT_DX5);
+    dx5.lpEnvelope = &envelope;
+    dx5.cbTypeSpecificParams = sizeof(cf);
+    dx5.lpvTypeSpecificParams = &cf;
+    dx5.dwStartDelay = 1234;
+    trace.record(FFBTraceMethod::SetParameters, 0, EffectKind::ConstantForce, 1, DI_OK,
+                 &dx5, DIEP_ENVELOPE | DIEP_TYPESPECIFICPARAMS | DIEP_STARTDELAY,
+                 kFFBTraceParamsForwarded);
+
+    // 3. CreateEffect passes a complete structure.
+    DIEFFECT full = {};
+    full.dwSize = sizeof(DIEFFECT);
+    full.cAxes = 2;
+    full.rgdwAxes = axes;
+    full.rglDirection = directions;
+    full.lpEnvelope = &envelope;
+    full.cbTypeSpecificParams = sizeof(cf);
+    full.lpvTypeSpecificParams = &cf;
+    full.dwStartDelay = 250;
+    trace.record(FFBTraceMethod::CreateEffect, 0, EffectKind::ConstantForce, 1, DI_OK,
+                 &full, 0, 0);
+
+    trace.close();
+
+    std::vector<FFBTraceRecord> records = readRecords();
+    CHECK_EQ(records.size(), 3u);
+    if (records.size() == 3) {
+        const FFBTraceRecord& a = records[0];
+        CHECK_EQ(a.dwGain, 7500u);
+        CHECK_EQ(a.cAxes, 0u);
+        CHECK(!(a.payloadFlags & kFFBTraceHasEnvelope));
+        CHECK_EQ(a.typeSpecificBytes, 0u);
+
+        const FFBTraceRecord& b = records[1];
+        CHECK(b.payloadFlags & kFFBTraceHasEnvelope);
+        CHECK_EQ(b.attackLevel, 1000u);
+        CHECK_EQ(b.fadeTime, 4000u);
+        CHECK_EQ(b.typeSpecificBytes, sizeof(cf));
+        CHECK_EQ(b.dwStartDelay, 0u);
+
+        const FFBTraceRecord& c = records[2];
+        CHECK_EQ(c.cAxes, 2u);
+        CHECK_EQ(c.axes[1], static_cast<uint32_t>(DIJOFS_Y));
+        CHECK_EQ(c.directions[0], 9000);
+        CHECK(c.payloadFlags & kFFBTraceHasEnvelope);
+        CHECK_EQ(c.dwStartDelay, 250u);
+    }
+
+    std::remove("dinput8_ffb_trace.bin");
+    return TEST_RESULT();
+}
@@ -0,0 +1,97 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026 Valmantas Paliksa
+//
+// MpscRing: full/empty behaviour and, under several concurrent producers,
+// that every published item is consumed exactly once and in per-producer
+// order.
+
+#include "mpsc_ring.h"
+#include "test_util.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct Item {
+    unsigned producer = 0;
+    unsigned sequence = 0;
+};
+
+void testFullAndEmpty() {
+    MpscRing<Item, 8> ring;
+    size_t pos;
+    for (unsigned i = 0; i < 8; ++i) {
+        Item* item = ring.tryAcquire(pos);
+        CHECK(item != nullptr);
+        if (!item) return;
+        item->sequence = i;
+        ring.publish(pos);
+    }
+    CHECK(ring.tryAcquire(pos) == nullptr);
+
+    unsigned expected = 0;
+    size_t n = ring.consume([&](const Item& item) { CHECK_EQ(item.sequence, expected++); });
+    CHECK_EQ(n, 8u);
+    CHECK_EQ(ring.consume([](const Item&) {}), 0u);
+
+    // A claimed but unpublished slot blocks the consumer, not the producers.
+    size_t held;
+    CHECK(ring.tryAcquire(held) != nullptr);
+    Item* next = ring.tryAcquire(pos);
+    CHECK(next != nullptr);
+    ring.publish(pos);
+    CHECK_EQ(ring.consume([](const Item&) {}), 0u);
+    ring.publish(held);
+    CHECK_EQ(ring.consume([](const Item&) {}), 2u);
+}
+
+void testConcurrentProducers() {
+    constexpr unsigned kProducers = 4;
+    constexpr unsigned kPerProducer = 50000;
+
+    MpscRing<Item, 256> ring;
+    std::atomic<bool> go{false};
+    std::vector<std::thread> producers;
+    for (unsigned p = 0; p < kProducers; ++p) {
+        producers.emplace_back([&, p] {
+            while (!go.load()) std::this_thread::yield();
+            for (unsigned i = 0; i < kPerProducer; ++i) {
+                size_t pos;
+                Item* item;
+                while (!(item = ring.tryAcquire(pos))) std::this_thread::yield();
+                item->producer = p;
+                item->sequence = i;
+                ring.publish(pos);
+            }
+        });
+    }
+
+    std::vector<unsigned> next(kProducers, 0);
+    unsigned long long total = 0;
+    bool ordered = true;
+    go.store(true);
+    while (total < 1ull * kProducers * kPerProducer) {
+        total += ring.consume([&](const Item& item) {
+            if (item.producer >= kProducers || item.sequence != next[item.producer])
+                ordered = false;
+            else
+                ++next[item.producer];
+        });
+    }
+    for (auto& t : producers) t.join();
+
+    CHECK(ordered);
+    for (unsigned p = 0; p < kProducers; ++p) CHECK_EQ(next[p], kPerProducer);
+    CHECK_EQ(ring.consume([](const Item&) {}), 0u);
+    CHECK_EQ(ring.claimed(), ring.consumed());
+}
+
+} // namespace
+
+int main() {
+    testFullAndEmpty();
+    testConcurrentProducers();
+    return TEST_RESULT();
+}
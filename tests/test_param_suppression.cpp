@@ -0,0 +1,77 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026 Valmantas Paliksa
+//
+// Redundant SetParameters suppression against a mock effect: repeats are
+// skipped, changes and DIEP_START go through, and an update forwarded with
+// DIEP_NODOWNLOAD never makes a later identical download look redundant.
+
+#include "mock_dinput.h"
+#include "test_util.h"
+#include "wrapper_effect.h"
+
+namespace {
+
+struct Fixture {
+    MockDevice*                device = new MockDevice;
+    std::shared_ptr<FFBFilter> filter;
+    MockEffect*                mock   = nullptr;
+    WrapperEffect*             effect = nullptr;
+    DICONSTANTFORCE            cf     = { 0 };
+    DIEFFECT                   params = {};
+
+    Fixture() {
+        Config::instance().ffbSuppressRedundant = true;
+        filter = makeMockFilter(mockPolicy());
+        IDirectInputEffect* real = nullptr;
+        device->CreateEffect(GUID_ConstantForce, nullptr, &real, nullptr);
+        mock   = static_cast<MockEffect*>(real);
+        effect = new WrapperEffect(real, filter);
+        params.dwSize = sizeof(DIEFFECT);
+        params.cbTypeSpecificParams  = sizeof(cf);
+        params.lpvTypeSpecificParams = &cf;
+    }
+    ~Fixture() {
+        effect->Release();
+        device->Release();
+    }
+
+    // Number of calls that reached the device.
+    int send(LONG magnitude, DWORD extraFlags = 0) {
+        cf.lMagnitude = magnitude;
+        CHECK_EQ(effect->SetParameters(&params, DIEP_TYPESPECIFICPARAMS | extraFlags), DI_OK);
+        return mock->setParametersCalls.load();
+    }
+};
+
+void testRepeats() {
+    Fixture f;
+    CHECK_EQ(f.send(1000), 1);
+    CHECK_EQ(f.send(1000), 1);               // repeat: skipped
+    CHECK_EQ(f.send(2000), 2);
+    CHECK_EQ(f.send(2000, DIEP_START), 3);   // starts the effect: never skipped
+}
+
+void testNoDownload() {
+    Fixture f;
+    CHECK_EQ(f.send(1000), 1);
+    CHECK(f.mock->downloaded());
+
+    // The driver takes 3000 but the device keeps playing 1000.
+    CHECK_EQ(f.send(3000, DIEP_NODOWNLOAD), 2);
+    // The same values with a download are not a repeat: they must reach the device.
+    CHECK_EQ(f.send(3000), 3);
+    // Now they are on the device, so a repeat is skipped again.
+    CHECK_EQ(f.send(3000), 3);
+
+    // Two NODOWNLOAD updates in a row both go through.
+    CHECK_EQ(f.send(4000, DIEP_NODOWNLOAD), 4);
+    CHECK_EQ(f.send(4000, DIEP_NODOWNLOAD), 5);
+}
+
+} // namespace
+
+int main() {
+    testRepeats();
+    testNoDownload();
+    return TEST_RESULT();
+}
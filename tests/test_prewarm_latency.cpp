@@ -0,0 +1,139 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026 Valmantas Paliksa
+//
+// [FFB] Prewarm against a device with injected latency. A session creates
+// kEffects ConstantForces with parameters and plays them; after a reconnect
+// the game acquires the device and re-creates them with the same parameters,
+// once with the pool and once without. With prewarming the game's
+// CreateEffect calls cost no device round trip (the pool paid for them at
+// CreateDevice and Acquire) and its parameters are not sent a second time;
+// in both cases every effect ends up playing with its recorded magnitude.
+// Game-thread times and reconnect-to-force time are printed for both runs.
+
+#include "mock_dinput.h"
+#include "test_util.h"
+#include "wrapper_effect.h"
+
+#include <cstring>
+
+namespace {
+
+constexpr size_t kEffects   = 4;
+constexpr DWORD  kLatencyMs = 10;   // per device FFB call
+
+LONG magnitude(size_t i) { return 1000 * static_cast<LONG>(i + 1); }
+
+struct Params {
+    DICONSTANTFORCE cf = {};
+    DIEFFECT        eff = {};
+    explicit Params(LONG m) {
+        cf.lMagnitude = m;
+        eff.dwSize = sizeof(DIEFFECT);
+        eff.dwDuration = INFINITE;
+        eff.dwGain = DI_FFNOMINALMAX;
+        eff.cbTypeSpecificParams = sizeof(cf);
+        eff.lpvTypeSpecificParams = &cf;
+    }
+};
+
+void firstSession(const FFBPolicy& policy, const DeviceIdentity& identity) {
+    MockDeviceSession s(policy, identity);
+    for (size_t i = 0; i < kEffects; ++i) {
+        Params p(magnitude(i));
+        IDirectInputEffect* e = s.create(GUID_ConstantForce, &p.eff);
+        CHECK(e != nullptr);
+        if (e) CHECK_EQ(e->Start(1, 0), DI_OK);
+    }
+}
+
+struct Reconnect {
+    double createMs   = 0;   // game thread, all CreateEffect calls
+    double acquireMs  = 0;   // game thread, Acquire
+    double forceMs    = 0;   // session start to every effect playing
+    int    deviceCreates = 0;     // real effects on the new device
+    int    deviceSetParams = 0;   // SetParameters that reached it
+};
+
+Reconnect reconnect(const FFBPolicy& policy, const DeviceIdentity& identity, bool prewarm) {
+    Reconnect r;
+    auto start = std::chrono::steady_clock::now();
+    MockDeviceSession s(policy, identity);
+    s.device->latencyMs = kLatencyMs;
+    if (prewarm) s.wrapper->prewarmEffects();   // as WrapperDirectInput8::CreateDevice does
+
+    // The game: acquire, then its effects with their usual parameters.
+    auto t = std::chrono::steady_clock::now();
+    CHECK_EQ(s.wrapper->Acquire(), DI_OK);
+    r.acquireMs = secondsSince(t) * 1000.0;
+    t = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < kEffects; ++i) {
+        Params p(magnitude(i));
+        CHECK(s.create(GUID_ConstantForce, &p.eff) != nullptr);
+    }
+    r.createMs = secondsSince(t) * 1000.0;
+
+    auto playing = [&] {
+        std::vector<MockEffect*> mocks = s.device->effects();
+        if (mocks.size() < kEffects) return false;
+        for (MockEffect* m : mocks) if (!m->playing()) return false;
+        return true;
+    };
+    for (int i = 0; i < 400 && !playing(); ++i) Sleep(2);
+    r.forceMs = secondsSince(start) * 1000.0;
+    CHECK(playing());
+
+    std::vector<MockEffect*> mocks = s.device->effects();
+    CHECK_EQ(mocks.size(), kEffects);
+    for (size_t i = 0; i < mocks.size(); ++i) {
+        DICONSTANTFORCE cf;
+        std::memcpy(&cf, mocks[i]->lastParams().typeSpecific, sizeof(cf));
+        CHECK_EQ(cf.lMagnitude, magnitude(i));
+        r.deviceSetParams += mocks[i]->setParametersCalls.load();
+    }
+    r.deviceCreates = static_cast<int>(mocks.size());
+    return r;
+}
+
+void print(const char* name, const Reconnect& r) {
+    std::printf("  %-12s Acquire %6.1f ms  CreateEffect x%zu %6.1f ms  "
+                "force back %6.1f ms  device SetParameters %d\n",
+                name, r.acquireMs, kEffects, r.createMs, r.forceMs, r.deviceSetParams);
+}
+
+} // namespace
+
+int main() {
+    Config::instance().ffbDefaultScale  = 100;
+    Config::instance().ffbRestoreRampMs = 0;
+
+    FFBPolicy policy = mockPolicy();
+    policy.autoRestart = true;
+
+    FFBPolicy prewarm = policy;
+    prewarm.prewarm = true;
+
+    const DeviceIdentity cold = mockIdentity(L"Cold Wheel");
+    const DeviceIdentity warm = mockIdentity(L"Warm Wheel");
+    firstSession(policy, cold);
+    firstSession(prewarm, warm);
+
+    Reconnect without = reconnect(policy, cold, false);
+    Reconnect with    = reconnect(prewarm, warm, true);
+
+    std::printf("%zu effects, %lu ms per device call\n", kEffects,
+                static_cast<unsigned long>(kLatencyMs));
+    print("no prewarm", without);
+    print("prewarm", with);
+
+    // The game's CreateEffect calls were answered from the pool: no device
+    // round trip each, where without the pool each paid at least one.
+    CHECK(with.createMs < kEffects * kLatencyMs / 2.0);
+    CHECK(without.createMs >= kEffects * kLatencyMs);
+    CHECK_EQ(with.deviceCreates, static_cast<int>(kEffects));
+
+    // The game's parameters matched the recorded ones: sent once, by the pool.
+    CHECK(with.deviceSetParams <= without.deviceSetParams);
+    CHECK(with.deviceSetParams <= static_cast<int>(kEffects));
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,114 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026 Valmantas Paliksa
+//
+// Auto-restart replays each effect instance's own record. A session plays
+// two ConstantForces with different magnitudes, a Sine in between and a
+// third ConstantForce that it stops again; after a reconnect the game
+// re-creates them in the same order without parameters. Each re-created
+// effect must get its own predecessor's parameters (matched by type and
+// creation ordinal), and the stopped one must stay stopped.
+
+#include "mock_dinput.h"
+#include "test_util.h"
+
+#include <cstring>
+
+namespace {
+
+HRESULT setConstant(IDirectInputEffect* effect, LONG magnitude) {
+    DICONSTANTFORCE cf = { magnitude };
+    DIEFFECT p = {};
+    p.dwSize = sizeof(DIEFFECT);
+    p.dwDuration = INFINITE;
+    p.dwGain = DI_FFNOMINALMAX;
+    p.cbTypeSpecificParams = sizeof(cf);
+    p.lpvTypeSpecificParams = &cf;
+    return effect->SetParameters(&p, DIEP_DURATION | DIEP_GAIN | DIEP_TYPESPECIFICPARAMS);
+}
+
+HRESULT setPeriodic(IDirectInputEffect* effect, DWORD magnitude, DWORD period) {
+    DIPERIODIC pe = { magnitude, 0, 0, period };
+    DIEFFECT p = {};
+    p.dwSize = sizeof(DIEFFECT);
+    p.dwDuration = INFINITE;
+    p.dwGain = DI_FFNOMINALMAX;
+    p.cbTypeSpecificParams = sizeof(pe);
+    p.lpvTypeSpecificParams = &pe;
+    return effect->SetParameters(&p, DIEP_DURATION | DIEP_GAIN | DIEP_TYPESPECIFICPARAMS);
+}
+
+LONG sentConstant(MockEffect* mock) {
+    DICONSTANTFORCE cf;
+    std::memcpy(&cf, mock->lastParams().typeSpecific, sizeof(cf));
+    return cf.lMagnitude;
+}
+
+DIPERIODIC sentPeriodic(MockEffect* mock) {
+    DIPERIODIC pe;
+    std::memcpy(&pe, mock->lastParams().typeSpecific, sizeof(pe));
+    return pe;
+}
+
+// Give the restore thread time to replay, verify and finish.
+bool waitPlaying(const std::vector<MockEffect*>& mocks) {
+    for (int i = 0; i < 200; ++i) {
+        bool all = true;
+        for (MockEffect* m : mocks) all &= m->playing();
+        if (all) return true;
+        Sleep(10);
+    }
+    return false;
+}
+
+} // namespace
+
+int main() {
+    Config::instance().ffbDefaultScale  = 100;
+    Config::instance().ffbRestoreRampMs = 0;   // full gain at once
+
+    FFBPolicy policy = mockPolicy();
+    policy.autoRestart = true;
+    const DeviceIdentity identity = mockIdentity();
+
+    {
+        MockDeviceSession first(policy, identity);
+        IDirectInputEffect* c0 = first.create(GUID_ConstantForce);   // ConstantForce#0
+        IDirectInputEffect* s0 = first.create(GUID_Sine);            // Sine#0
+        IDirectInputEffect* c1 = first.create(GUID_ConstantForce);   // ConstantForce#1
+        IDirectInputEffect* c2 = first.create(GUID_ConstantForce);   // ConstantForce#2
+        CHECK(c0 && s0 && c1 && c2);
+        if (!c0 || !s0 || !c1 || !c2) return TEST_RESULT();
+
+        CHECK_EQ(setConstant(c0, 3000), DI_OK);
+        CHECK_EQ(setPeriodic(s0, 2000, 50000), DI_OK);
+        CHECK_EQ(setConstant(c1, -5000), DI_OK);
+        CHECK_EQ(setConstant(c2, 1000), DI_OK);
+        for (IDirectInputEffect* e : { c0, s0, c1, c2 })
+            CHECK_EQ(e->Start(1, 0), DI_OK);
+        CHECK_EQ(c2->Stop(), DI_OK);
+
+        // Later parameters of a running effect land in its own record only.
+        CHECK_EQ(setConstant(c1, -6000), DI_OK);
+    }   // device gone: the game releases everything
+
+    {
+        MockDeviceSession second(policy, identity);
+        for (REFGUID guid : { GUID_ConstantForce, GUID_Sine,
+                              GUID_ConstantForce, GUID_ConstantForce })
+            CHECK(second.create(guid) != nullptr);
+        if (second.effects.size() != 4) return TEST_RESULT();
+
+        CHECK(waitPlaying({ second.mock(0), second.mock(1), second.mock(2) }));
+        CHECK_EQ(sentConstant(second.mock(0)), 3000);
+        CHECK_EQ(sentPeriodic(second.mock(1)).dwMagnitude, 2000u);
+        CHECK_EQ(sentPeriodic(second.mock(1)).dwPeriod, 50000u);
+        CHECK_EQ(sentConstant(second.mock(2)), -6000);
+
+        // The effect the game stopped is not restarted.
+        Sleep(50);
+        CHECK_EQ(second.mock(3)->startCalls.load(), 0);
+        CHECK(!second.mock(3)->playing());
+    }
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,157 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026 Valmantas Paliksa
+//
+// FFBStateRegistry under concurrent record and replay: writer threads stream
+// SetParameters/Start/Stop for their own effect instances while readers take
+// snapshots and query wasRunning. Every record a writer stores is
+// self-consistent (all fields carry the same stamp), so a torn read shows up
+// as a mismatch.
+//
+// Windows only: the registry needs <windows.h> and the DirectInput headers,
+// and the tree has no stand-in for them, so neither a Linux build nor a
+// ThreadSanitizer run of this test goes through CTest. MSVC and clang-cl
+// have no ThreadSanitizer either; a TSan run needs a Win32 shim outside
+// this tree.
+
+#include "ffb_state_registry.h"
+#include "test_util.h"
+
+#include <atomic>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+namespace {
+
+constexpr unsigned kWriters = 4;
+constexpr unsigned kReaders = 2;
+constexpr unsigned kUpdates = 20000;
+
+// Writer w's effect; the last one has no dense slot and exercises the map.
+EffectInstanceId instance(unsigned w) {
+    EffectInstanceId id;
+    id.kind    = EffectKind::ConstantForce;
+    id.guid    = GUID_ConstantForce;
+    id.ordinal = w + 1 < kWriters ? w : kEffectRecordInstances + 1;
+    return id;
+}
+
+DWORD stamp(unsigned w, unsigned i) { return (static_cast<DWORD>(w) << 24) | i; }
+
+void record(FFBDeviceHandle h, unsigned w, unsigned i) {
+    DWORD v = stamp(w, i);
+    DWORD axes[2] = { DIJOFS_X, DIJOFS_Y };
+    LONG  dirs[2] = { static_cast<LONG>(v), -static_cast<LONG>(v) };
+    DICONSTANTFORCE cf = { static_cast<LONG>(v) };
+    DIENVELOPE env = { sizeof(DIENVELOPE), v, v, v, v };
+    DIEFFECT eff = {};
+    eff.dwSize = sizeof(DIEFFECT);
+    eff.dwDuration = v;
+    eff.dwGain = v;
+    eff.cAxes = 2;
+    eff.rgdwAxes = axes;
+    eff.rglDirection = dirs;
+    eff.lpEnvelope = &env;
+    eff.cbTypeSpecificParams = sizeof(cf);
+    eff.lpvTypeSpecificParams = &cf;
+
+    FFBStateRegistry& reg = FFBStateRegistry::instance();
+    reg.recordParams(h, instance(w), &eff);
+    if (i % 8 == 0)
+        reg.recordStart(h, instance(w), v, 0);
+    else if (i % 8 == 4)
+        reg.recordStop(h, instance(w));
+}
+
+// A record as one writer left it: every field carries the same stamp.
+bool consistent(EffectStateRecord rec, unsigned w) {
+    if (!rec.hasParams) return true;
+    DWORD v = rec.params.dwGain;
+    if ((v >> 24) != w) return false;
+
+    DIEFFECT p = rec.replayParams();   // pointers into this copy
+    DICONSTANTFORCE cf;
+    std::memcpy(&cf, p.lpvTypeSpecificParams, sizeof(cf));
+    return p.dwDuration == v && p.cAxes == 2 &&
+           p.rglDirection[0] == static_cast<LONG>(v) &&
+           p.rglDirection[1] == -static_cast<LONG>(v) &&
+           cf.lMagnitude == static_cast<LONG>(v) &&
+           p.lpEnvelope && p.lpEnvelope->dwAttackLevel == v &&
+           p.lpEnvelope->dwFadeTime == v;
+}
+
+} // namespace
+
+int main() {
+    DeviceIdentity identity;
+    identity.instanceGuid.Data1 = 0x57BE55;
+    identity.productName = L"Stress Wheel";
+    FFBStateRegistry& reg = FFBStateRegistry::instance();
+    FFBDeviceHandle h = reg.internDevice(identity);
+    CHECK(h != kInvalidDeviceHandle);
+
+    std::atomic<bool> go{false};
+    std::atomic<unsigned> writing{kWriters};
+    std::atomic<int> torn{0}, backwards{0}, badStart{0};
+    std::vector<std::thread> threads;
+
+    for (unsigned w = 0; w < kWriters; ++w) {
+        threads.emplace_back([&, w] {
+            while (!go.load()) std::this_thread::yield();
+            for (unsigned i = 0; i < kUpdates; ++i)
+                record(h, w, i);
+            writing.fetch_sub(1);
+        });
+    }
+
+    for (unsigned r = 0; r < kReaders; ++r) {
+        threads.emplace_back([&] {
+            while (!go.load()) std::this_thread::yield();
+            uint64_t lastVersion = 0;
+            while (writing.load() > 0) {
+                FFBDeviceSnapshotPtr snap = reg.snapshot(h);
+                if (snap->version < lastVersion) backwards.fetch_add(1);
+                lastVersion = snap->version;
+                for (unsigned w = 0; w < kWriters; ++w) {
+                    const EffectStateRecord* rec = snap->find(instance(w));
+                    if (rec && !consistent(*rec, w)) torn.fetch_add(1);
+                }
+            }
+        });
+    }
+
+    // Start-state reader: lastIterations is always a Start stamp (i % 8 == 0).
+    threads.emplace_back([&] {
+        while (!go.load()) std::this_thread::yield();
+        while (writing.load() > 0) {
+            for (unsigned w = 0; w < kWriters; ++w) {
+                DWORD iterations = 0, flags = 0;
+                if (reg.wasRunning(h, instance(w), iterations, flags) &&
+                    ((iterations >> 24) != w || (iterations & 0xFFFFFF) % 8 != 0))
+                    badStart.fetch_add(1);
+            }
+        }
+    });
+
+    go.store(true);
+    for (auto& t : threads) t.join();
+
+    CHECK_EQ(torn.load(), 0);
+    CHECK_EQ(backwards.load(), 0);
+    CHECK_EQ(badStart.load(), 0);
+
+    // Once the writers are done, a snapshot holds exactly their last write.
+    FFBDeviceSnapshotPtr last = reg.snapshot(h);
+    for (unsigned w = 0; w < kWriters; ++w) {
+        const EffectStateRecord* rec = last->find(instance(w));
+        CHECK(rec != nullptr);
+        if (!rec) continue;
+        CHECK(consistent(*rec, w));
+        CHECK_EQ(rec->params.dwGain, stamp(w, kUpdates - 1));
+        CHECK(!rec->wasRunning);   // (kUpdates - 1) % 8 == 7: after a Stop
+    }
+    CHECK(reg.snapshot(h) == last);   // unchanged: the same snapshot object
+
+    reg.releaseDevice(h);
+    return TEST_RESULT();
+}
@@ -0,0 +1,123 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026 Valmantas Paliksa
+//
+// [FFB] RestoreRampMs on a simulated clock. A restored ConstantForce starts
+// at zero gain and the restore thread raises it in proportion to the
+// simulated time since the verified start; the real time between steps
+// does not matter. The game's own SetParameters during the ramp is scaled
+// by the current position, and once the window is over it passes through
+// unchanged.
+//
+// Windows only (dinput8_win_test); it needs the restore thread and the
+// wrapper objects from dinput8_core.
+
+#include "mock_dinput.h"
+#include "test_util.h"
+#include "wrapper_effect.h"
+
+#include <cstring>
+
+namespace {
+
+constexpr DWORD kRampMs = 1000;
+
+std::atomic<ULONGLONG> g_now{ 5000000 };
+ULONGLONG simulatedTick() { return g_now.load(); }
+
+HRESULT setConstant(IDirectInputEffect* effect, LONG magnitude, DWORD gain) {
+    DICONSTANTFORCE cf = { magnitude };
+    DIEFFECT p = {};
+    p.dwSize = sizeof(DIEFFECT);
+    p.dwDuration = INFINITE;
+    p.dwGain = gain;
+    p.cbTypeSpecificParams = sizeof(cf);
+    p.lpvTypeSpecificParams = &cf;
+    return effect->SetParameters(&p, DIEP_DURATION | DIEP_GAIN | DIEP_TYPESPECIFICPARAMS);
+}
+
+HRESULT setGain(IDirectInputEffect* effect, DWORD gain) {
+    DIEFFECT p = {};
+    p.dwSize = sizeof(DIEFFECT);
+    p.dwGain = gain;
+    return effect->SetParameters(&p, DIEP_GAIN);
+}
+
+// Wait (real time) for the restore thread to send gain to the device.
+bool waitGain(MockEffect* mock, DWORD gain) {
+    for (int i = 0; i < 200; ++i) {
+        if (mock->lastParams().gain == gain) return true;
+        Sleep(5);
+    }
+    std::fprintf(stderr, "gain %lu, expected %lu\n",
+                 static_cast<unsigned long>(mock->lastParams().gain),
+                 static_cast<unsigned long>(gain));
+    return false;
+}
+
+} // namespace
+
+int main() {
+    Config::instance().ffbDefaultScale  = 100;
+    Config::instance().ffbRestoreRampMs = kRampMs;
+
+    FFBPolicy policy = mockPolicy();
+    policy.autoRestart = true;
+    const DeviceIdentity identity = mockIdentity(L"Ramp Wheel");
+
+    {
+        MockDeviceSession first(policy, identity);
+        IDirectInputEffect* e = first.create(GUID_ConstantForce);
+        CHECK(e != nullptr);
+        if (!e) return TEST_RESULT();
+        CHECK_EQ(setConstant(e, 5000, DI_FFNOMINALMAX), DI_OK);
+        CHECK_EQ(e->Start(1, 0), DI_OK);
+    }
+
+    MockDeviceSession s(policy, identity);
+    FFBRestoreScheduler* restore = s.filter->restoreScheduler();
+    CHECK(restore != nullptr);
+    if (!restore) return TEST_RESULT();
+    restore->setTickSource(&simulatedTick);
+
+    IDirectInputEffect* e = s.create(GUID_ConstantForce);
+    CHECK(e != nullptr);
+    if (!e) return TEST_RESULT();
+    MockEffect* mock = s.mock(0);
+
+    // Restarted at zero gain with the recorded magnitude.
+    for (int i = 0; i < 200 && !mock->playing(); ++i) Sleep(5);
+    CHECK(mock->playing());
+    CHECK(waitGain(mock, 0));
+    DICONSTANTFORCE cf;
+    std::memcpy(&cf, mock->lastParams().typeSpecific, sizeof(cf));
+    CHECK_EQ(cf.lMagnitude, 5000);
+
+    // Real time alone does not move the ramp.
+    Sleep(100);
+    CHECK_EQ(mock->lastParams().gain, 0u);
+
+    g_now += kRampMs / 4;
+    CHECK(waitGain(mock, DI_FFNOMINALMAX / 4));
+
+    // The game lowers the gain mid-ramp: scaled to the ramp position, and
+    // later steps build on the new value.
+    CHECK_EQ(setGain(e, 8000), DI_OK);
+    CHECK_EQ(mock->lastParams().gain, 2000u);
+
+    g_now += kRampMs / 4;
+    CHECK(waitGain(mock, 4000));
+
+    g_now += kRampMs / 2;
+    CHECK(waitGain(mock, 8000));
+
+    // Past the window the ramp is gone: the game's gain goes through as is.
+    g_now += kRampMs;
+    Sleep(50);
+    CHECK_EQ(setGain(e, 6000), DI_OK);
+    CHECK_EQ(mock->lastParams().gain, 6000u);
+    Sleep(50);
+    CHECK_EQ(mock->lastParams().gain, 6000u);
+    CHECK(mock->playing());
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,167 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026 Valmantas Paliksa
+//
+// Auto-restart on a flaky reconnect. After the device comes back, one
+// effect's Start fails a few times before it takes (finishBatch retries it
+// with backoff), another never starts (given up after the attempt limit, no
+// longer pending, and the device is not hammered further), and a device
+// released while its retries are still pending shuts the restore thread
+// down promptly. The game may also release an effect while its restart is
+// due or being replayed: once Release returns, the restore thread never
+// touches it again.
+
+#include "mock_dinput.h"
+#include "test_util.h"
+#include "wrapper_effect.h"
+
+#include <algorithm>
+#include <random>
+
+namespace {
+
+constexpr int kMaxAttempts = 6;   // FFBRestoreScheduler::kMaxAttempts
+
+HRESULT setConstant(IDirectInputEffect* effect, LONG magnitude) {
+    DICONSTANTFORCE cf = { magnitude };
+    DIEFFECT p = {};
+    p.dwSize = sizeof(DIEFFECT);
+    p.dwDuration = INFINITE;
+    p.cbTypeSpecificParams = sizeof(cf);
+    p.lpvTypeSpecificParams = &cf;
+    return effect->SetParameters(&p, DIEP_DURATION | DIEP_TYPESPECIFICPARAMS);
+}
+
+// The first session: two ConstantForces playing when the device goes away.
+void playTwo(const FFBPolicy& policy, const DeviceIdentity& identity) {
+    MockDeviceSession s(policy, identity);
+    for (LONG magnitude : { 2000, -3000 }) {
+        IDirectInputEffect* e = s.create(GUID_ConstantForce);
+        CHECK(e != nullptr);
+        if (!e) return;
+        CHECK_EQ(setConstant(e, magnitude), DI_OK);
+        CHECK_EQ(e->Start(1, 0), DI_OK);
+    }
+}
+
+bool pending(IDirectInputEffect* effect) {
+    return (static_cast<WrapperEffect*>(effect)->restoreState() &
+            WrapperEffect::kRestorePending) != 0;
+}
+
+template <typename Pred>
+bool waitFor(Pred pred, DWORD timeoutMs) {
+    ULONGLONG until = GetTickCount64() + timeoutMs;
+    while (!pred()) {
+        if (GetTickCount64() > until) return false;
+        Sleep(5);
+    }
+    return true;
+}
+
+void testRetryThenAbandon(const FFBPolicy& policy) {
+    const DeviceIdentity identity = mockIdentity(L"Flaky Wheel");
+    playTwo(policy, identity);
+
+    MockDeviceSession s(policy, identity);
+    s.device->effectStartFailures = 2;                 // ConstantForce#0: third try works
+    IDirectInputEffect* flaky = s.create(GUID_ConstantForce);
+    s.device->effectStartFailures = 1000;              // ConstantForce#1: never
+    IDirectInputEffect* dead = s.create(GUID_ConstantForce);
+    CHECK(flaky && dead);
+    if (!flaky || !dead) return;
+
+    // Backoff is 50 + 100 + 200 + 400 + 800 ms before the last attempt.
+    CHECK(waitFor([&] { return !pending(flaky) && !pending(dead); }, 5000));
+
+    MockEffect* flakyMock = s.mock(0);
+    MockEffect* deadMock  = s.mock(1);
+    CHECK_EQ(flakyMock->startCalls.load(), 3);
+    CHECK(flakyMock->playing());
+    CHECK_EQ(deadMock->startCalls.load(), kMaxAttempts);
+    CHECK(!deadMock->playing());
+
+    // Given up for good: no further attempts.
+    Sleep(300);
+    CHECK_EQ(deadMock->startCalls.load(), kMaxAttempts);
+
+    // The game's own Start still reaches the device once it recovers.
+    deadMock->startFailures = 0;
+    CHECK_EQ(dead->Start(1, 0), DI_OK);
+    CHECK(deadMock->playing());
+}
+
+// Device released while a retry is waiting out its backoff: the restore
+// thread is stopped and joined, and nothing touches the freed effects.
+void testReleaseDuringBackoff(const FFBPolicy& policy) {
+    const DeviceIdentity identity = mockIdentity(L"Unplugged Wheel");
+    playTwo(policy, identity);
+
+    ULONGLONG released;
+    {
+        MockDeviceSession s(policy, identity);
+        s.device->effectStartFailures = 1000;
+        CHECK(s.create(GUID_ConstantForce) != nullptr);
+        CHECK(s.create(GUID_ConstantForce) != nullptr);
+        if (s.effects.size() != 2) return;
+        CHECK(waitFor([&] { return s.mock(0)->startCalls.load() >= 2; }, 2000));
+        released = GetTickCount64();
+    }
+    CHECK(GetTickCount64() - released < 400);
+}
+
+int deviceCalls(MockEffect* m) {
+    return m->setParametersCalls.load() + m->downloadCalls.load() +
+           m->startCalls.load() + m->statusCalls.load();
+}
+
+// The game releases each restored effect at a random point between its
+// CreateEffect (restart due at once) and the end of the replay. Whatever the
+// restore thread had already taken, nothing reaches the device through the
+// freed wrapper afterwards.
+void testReleaseWhileDue(const FFBPolicy& policy) {
+    std::mt19937 rng(15);
+    std::uniform_int_distribution<int> delayUs(0, 400);
+    int late = 0;
+    for (int round = 0; round < 100; ++round) {
+        const DeviceIdentity identity = mockIdentity(L"Released Wheel");
+        playTwo(policy, identity);
+
+        MockDeviceSession s(policy, identity);
+        s.device->latencyMs = round % 4 == 0 ? 1 : 0;
+        CHECK(s.create(GUID_ConstantForce) != nullptr);
+        CHECK(s.create(GUID_ConstantForce) != nullptr);
+        if (s.effects.size() != 2) return;
+
+        std::vector<IDirectInputEffect*> effects;
+        effects.swap(s.effects);   // released here, not by the session
+        size_t order[2] = { 0, 1 };
+        std::shuffle(order, order + 2, rng);
+        int calls[2] = {};
+        for (size_t i : order) {
+            auto until = std::chrono::steady_clock::now() +
+                         std::chrono::microseconds(delayUs(rng));
+            while (std::chrono::steady_clock::now() < until) {}
+            effects[i]->Release();
+            calls[i] = deviceCalls(s.mock(i));
+        }
+        Sleep(5);
+        for (size_t i : order)
+            if (deviceCalls(s.mock(i)) != calls[i]) ++late;
+    }
+    CHECK_EQ(late, 0);
+}
+
+} // namespace
+
+int main() {
+    Config::instance().ffbDefaultScale  = 100;
+    Config::instance().ffbRestoreRampMs = 0;
+
+    FFBPolicy policy = mockPolicy();
+    policy.autoRestart = true;
+
+    testRetryThenAbandon(policy);
+    testReleaseDuringBackoff(policy);
+    testReleaseWhileDue(policy);
+    return TEST_RESULT();
+}
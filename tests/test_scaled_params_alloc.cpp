@@ -0,0 +1,172 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026 Valmantas Paliksa
+//
+// The scaled SetParameters path (WrapperEffect::buildScaledParams) works in
+// per-effect scratch storage: after the first call has sized it, a stream of
+// updates must not touch the heap. Also checks that the game's buffers are
+// never written and that only flagged members are scaled.
+
+#include "mock_dinput.h"
+#include "test_util.h"
+#include "wrapper_effect.h"
+
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+// ---------------------------------------------------------------------------
+// Allocation counting (this thread only, while armed)
+// ---------------------------------------------------------------------------
+namespace {
+thread_local bool g_counting = false;
+thread_local long g_allocations = 0;
+
+struct CountAllocations {
+    CountAllocations()  { g_allocations = 0; g_counting = true; }
+    ~CountAllocations() { g_counting = false; }
+    long count() const  { return g_allocations; }
+};
+} // namespace
+
+void* operator new(size_t size) {
+    if (g_counting) ++g_allocations;
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+void* operator new[](size_t size) { return operator new(size); }
+void  operator delete(void* p) noexcept { std::free(p); }
+void  operator delete[](void* p) noexcept { std::free(p); }
+void  operator delete(void* p, size_t) noexcept { operator delete(p); }
+void  operator delete[](void* p, size_t) noexcept { operator delete[](p); }
+
+namespace {
+
+constexpr int kUpdates = 1000;
+
+struct Fixture {
+    MockDevice*                device = new MockDevice;
+    std::shared_ptr<FFBFilter> filter;
+
+    Fixture() {
+        Config::instance().ffbDefaultScale = 50;
+        filter = makeMockFilter(mockPolicy());
+    }
+
+    ~Fixture() { device->Release(); }
+
+    WrapperEffect* create(REFGUID guid, MockEffect*& mock) {
+        IDirectInputEffect* real = nullptr;
+        device->CreateEffect(guid, nullptr, &real, nullptr);
+        mock = static_cast<MockEffect*>(real);
+        return new WrapperEffect(real, filter);
+    }
+};
+
+void testConstantWithEnvelope(Fixture& f) {
+    MockEffect* mock;
+    WrapperEffect* effect = f.create(GUID_ConstantForce, mock);
+
+    DICONSTANTFORCE cf = { 8000 };
+    DIENVELOPE env = { sizeof(DIENVELOPE), 6000, 100000, 4000, 200000 };
+    DIEFFECT p = {};
+    p.dwSize = sizeof(DIEFFECT);
+    p.dwGain = DI_FFNOMINALMAX;
+    p.lpEnvelope = &env;
+    p.cbTypeSpecificParams = sizeof(cf);
+    p.lpvTypeSpecificParams = &cf;
+    const DWORD flags = DIEP_GAIN | DIEP_ENVELOPE | DIEP_TYPESPECIFICPARAMS;
+
+    CHECK_EQ(effect->SetParameters(&p, flags), DI_OK);   // sizes the scratch
+    {
+        CountAllocations allocs;
+        for (int i = 0; i < kUpdates; ++i) {
+            cf.lMagnitude = (i % 2 ? 1 : -1) * (1000 + i);
+            effect->SetParameters(&p, flags);
+        }
+        CHECK_EQ(allocs.count(), 0);
+    }
+
+    // The device got half of everything; the game's buffers are untouched.
+    MockEffect::Params last = mock->lastParams();
+    DICONSTANTFORCE sent;
+    std::memcpy(&sent, last.typeSpecific, sizeof(sent));
+    CHECK_EQ(sent.lMagnitude, cf.lMagnitude / 2);
+    CHECK_EQ(last.gain, static_cast<DWORD>(DI_FFNOMINALMAX / 2));
+    CHECK(last.hasEnvelope);
+    CHECK_EQ(last.envelope.dwAttackLevel, 3000u);
+    CHECK_EQ(last.envelope.dwFadeLevel, 2000u);
+    CHECK_EQ(env.dwAttackLevel, 6000u);
+    CHECK_EQ(p.dwGain, static_cast<DWORD>(DI_FFNOMINALMAX));
+
+    // Without DIEP_ENVELOPE the envelope is neither scaled nor passed on.
+    cf.lMagnitude = 1234;
+    CHECK_EQ(effect->SetParameters(&p, DIEP_TYPESPECIFICPARAMS), DI_OK);
+    last = mock->lastParams();
+    CHECK_EQ(last.flags, static_cast<DWORD>(DIEP_TYPESPECIFICPARAMS));
+    CHECK_EQ(env.dwAttackLevel, 6000u);
+
+    effect->Release();
+}
+
+void testCondition(Fixture& f) {
+    MockEffect* mock;
+    WrapperEffect* effect = f.create(GUID_Spring, mock);
+
+    DICONDITION cond[2] = {};
+    DIEFFECT p = {};
+    p.dwSize = sizeof(DIEFFECT);
+    p.cbTypeSpecificParams = sizeof(cond);
+    p.lpvTypeSpecificParams = cond;
+
+    CHECK_EQ(effect->SetParameters(&p, DIEP_TYPESPECIFICPARAMS), DI_OK);
+    {
+        CountAllocations allocs;
+        for (int i = 0; i < kUpdates; ++i) {
+            cond[0].lPositiveCoefficient = 2000 + i;
+            cond[1].dwPositiveSaturation = 5000 + i;
+            effect->SetParameters(&p, DIEP_TYPESPECIFICPARAMS);
+        }
+        CHECK_EQ(allocs.count(), 0);
+    }
+
+    DICONDITION sent[2];
+    std::memcpy(sent, mock->lastParams().typeSpecific, sizeof(sent));
+    CHECK_EQ(sent[0].lPositiveCoefficient, cond[0].lPositiveCoefficient / 2);
+    CHECK_EQ(sent[1].dwPositiveSaturation, cond[1].dwPositiveSaturation / 2);
+    effect->Release();
+}
+
+void testCustomForce(Fixture& f) {
+    MockEffect* mock;
+    WrapperEffect* effect = f.create(GUID_CustomForce, mock);
+
+    std::vector<LONG> samples(512, 0);
+    DICUSTOMFORCE cf = { 1, 1000, static_cast<DWORD>(samples.size()), samples.data() };
+    DIEFFECT p = {};
+    p.dwSize = sizeof(DIEFFECT);
+    p.cbTypeSpecificParams = sizeof(cf);
+    p.lpvTypeSpecificParams = &cf;
+
+    CHECK_EQ(effect->SetParameters(&p, DIEP_TYPESPECIFICPARAMS), DI_OK);   // grows once
+    {
+        CountAllocations allocs;
+        for (int i = 0; i < kUpdates; ++i) {
+            samples[0] = 4000 + i;
+            effect->SetParameters(&p, DIEP_TYPESPECIFICPARAMS);
+        }
+        CHECK_EQ(allocs.count(), 0);
+    }
+    CHECK_EQ(mock->lastParams().firstSample, samples[0] / 2);
+    CHECK_EQ(samples[0], 4000 + kUpdates - 1);   // game samples untouched
+    effect->Release();
+}
+
+} // namespace
+
+int main() {
+    Fixture f;
+    testConstantWithEnvelope(f);
+    testCondition(f);
+    testCustomForce(f);
+    return TEST_RESULT();
+}
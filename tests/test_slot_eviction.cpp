@@ -0,0 +1,139 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026 Valmantas Paliksa
+//
+// [FFB] EvictOnDeviceFull against a mock device with two effect slots. A
+// DIERR_DEVICEFULL evicts the least recently used idle effect; an effect
+// whose finite run has ended counts as idle once the device says so; with
+// everything playing the error reaches the game. An evicted effect must not
+// look downloaded to the wrapper: the game's next SetParameters, even an
+// identical one, goes through and brings it back, and its status reads as
+// stopped.
+//
+// Windows only (dinput8_win_test): it drives WrapperDevice8 and needs the
+// DirectInput headers.
+
+#include "mock_dinput.h"
+#include "test_util.h"
+
+namespace {
+
+struct Params {
+    DICONSTANTFORCE cf = {};
+    DIEFFECT        eff = {};
+    Params(LONG magnitude, DWORD durationUs) {
+        cf.lMagnitude = magnitude;
+        eff.dwSize = sizeof(DIEFFECT);
+        eff.dwDuration = durationUs;
+        eff.dwGain = DI_FFNOMINALMAX;
+        eff.cbTypeSpecificParams = sizeof(cf);
+        eff.lpvTypeSpecificParams = &cf;
+    }
+    HRESULT setOn(IDirectInputEffect* e) {
+        return e->SetParameters(&eff, DIEP_DURATION | DIEP_GAIN | DIEP_TYPESPECIFICPARAMS);
+    }
+};
+
+DWORD status(IDirectInputEffect* e) {
+    DWORD s = 0;
+    CHECK_EQ(e->GetEffectStatus(&s), DI_OK);
+    return s;
+}
+
+FFBPolicy slotPolicy() {
+    FFBPolicy p = mockPolicy();
+    p.evictOnFull = true;
+    return p;
+}
+
+// Least recently used idle effect goes; the evicted one comes back on its
+// next SetParameters, identical or not.
+void testLruIdle() {
+    MockDeviceSession s(slotPolicy(), mockIdentity(L"Two Slot Wheel"));
+    s.device->slotLimit = 2;
+
+    Params pa(1000, INFINITE), pb(2000, INFINITE), pc(3000, INFINITE);
+    IDirectInputEffect* a = s.create(GUID_ConstantForce);
+    IDirectInputEffect* b = s.create(GUID_ConstantForce);
+    IDirectInputEffect* c = s.create(GUID_ConstantForce);
+    CHECK(a && b && c);
+    if (!a || !b || !c) return;
+    MockEffect *ma = s.mock(0), *mb = s.mock(1), *mc = s.mock(2);
+    CHECK_EQ(pa.setOn(a), DI_OK);
+    CHECK_EQ(pb.setOn(b), DI_OK);   // now in b's parameter cache
+
+    CHECK_EQ(b->Start(1, 0), DI_OK);
+    CHECK_EQ(b->Stop(), DI_OK);          // b idle but used after a
+    CHECK_EQ(a->Start(1, 0), DI_OK);     // a playing
+    CHECK_EQ(s.device->slotsUsed.load(), 2);
+
+    // c needs a slot: b is the only idle one.
+    CHECK_EQ(pc.setOn(c), DI_OK);
+    CHECK(mc->downloaded());
+    CHECK_EQ(mb->unloadCalls.load(), 1);
+    CHECK(!mb->downloaded());
+    CHECK(ma->playing());
+    CHECK_EQ(ma->unloadCalls.load(), 0);
+    CHECK_EQ(status(b) & DIEGES_PLAYING, 0u);
+
+    // The game repeats b's parameters unchanged: they are not suppressed,
+    // and downloading b evicts c (idle) in turn.
+    int before = mb->setParametersCalls.load();
+    CHECK_EQ(pb.setOn(b), DI_OK);
+    int after = mb->setParametersCalls.load();   // DEVICEFULL, evict, retry
+    CHECK(after > before);
+    CHECK(mb->downloaded());
+    CHECK_EQ(mc->unloadCalls.load(), 1);
+    CHECK(!mc->downloaded());
+
+    // A second identical call is redundant again.
+    CHECK_EQ(pb.setOn(b), DI_OK);
+    CHECK_EQ(mb->setParametersCalls.load(), after);
+
+    // b and a both playing: c's Start has nothing to evict.
+    CHECK_EQ(b->Start(1, 0), DI_OK);
+    CHECK_EQ(c->Start(1, 0), DIERR_DEVICEFULL);
+    CHECK(!mc->playing());
+    CHECK(ma->playing() && mb->playing());
+    CHECK_EQ(s.device->slotsUsed.load(), 2);
+}
+
+// A finite effect the wrapper still counts as playing is evicted once
+// GetEffectStatus shows it has run out; its shadow then reads stopped.
+void testFiniteRunOut() {
+    Config::instance().ffbStatusMaxAgeMs = 1000;   // answer from the shadow
+    MockDeviceSession s(slotPolicy(), mockIdentity(L"Finite Wheel"));
+    s.device->slotLimit = 2;
+
+    Params shortRun(1000, 30000), forever(2000, INFINITE), next(3000, INFINITE);
+    IDirectInputEffect* a = s.create(GUID_ConstantForce, &shortRun.eff);
+    IDirectInputEffect* b = s.create(GUID_ConstantForce, &forever.eff);
+    IDirectInputEffect* c = s.create(GUID_ConstantForce);
+    CHECK(a && b && c);
+    if (!a || !b || !c) return;
+    MockEffect *ma = s.mock(0), *mb = s.mock(1);
+
+    CHECK_EQ(a->Start(1, 0), DI_OK);
+    CHECK_EQ(b->Start(1, 0), DI_OK);
+    Sleep(60);   // a's 30 ms run is over; nobody told the wrapper
+    CHECK(!ma->playing());
+
+    int queries = ma->statusCalls.load();
+    CHECK_EQ(next.setOn(c), DI_OK);
+    CHECK(ma->statusCalls.load() > queries);   // asked the device
+    CHECK_EQ(ma->unloadCalls.load(), 1);
+    CHECK(mb->playing());
+    CHECK_EQ(mb->unloadCalls.load(), 0);
+
+    queries = ma->statusCalls.load();
+    CHECK_EQ(status(a) & DIEGES_PLAYING, 0u);
+    CHECK_EQ(ma->statusCalls.load(), queries);   // from the shadow
+    Config::instance().ffbStatusMaxAgeMs = 0;
+}
+
+} // namespace
+
+int main() {
+    testLruIdle();
+    testFiniteRunOut();
+    return TEST_RESULT();
+}
@@ -0,0 +1,273 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026 Valmantas Paliksa
+//
+// FFBStateJournal recovery: records written in one session come back intact
+// in the next, slots torn by a crash or with a bad checksum are dropped, a
+// file of another layout version is ignored and started over, and the
+// registry restores recovered records under a device's new handle.
+//
+// The damage is done through a second mapping of the file. Slots are
+// {seq, checksum, record} (see FFBStateJournal::Slot); the version word
+// follows the 8-byte magic.
+
+#include "ffb_state_journal.h"
+#include "ffb_state_registry.h"
+#include "test_util.h"
+
+#include <cstring>
+
+namespace {
+
+const wchar_t* const kDir  = L".";
+const wchar_t* const kFile = L".\\dinput8_ffb_state.bin";
+
+DeviceIdentity wheel() {
+    DeviceIdentity d;
+    d.instanceGuid.Data1 = 0x10A1;
+    d.productGuid.Data1  = 0x20B2;
+    d.productName        = L"Journal Wheel";
+    return d;
+}
+
+DeviceIdentity pedals() {
+    DeviceIdentity d;
+    d.instanceGuid.Data1 = 0x30C3;
+    d.productGuid.Data1  = 0x40D4;
+    d.productName        = L"Journal Pedals";
+    return d;
+}
+
+EffectInstanceId instance(EffectKind kind, REFGUID guid, uint32_t ordinal) {
+    EffectInstanceId id;
+    id.kind    = kind;
+    id.guid    = guid;
+    id.ordinal = ordinal;
+    return id;
+}
+
+EffectStateRecord makeRecord(const EffectInstanceId& id, LONG magnitude, bool running) {
+    EffectStateRecord rec;
+    rec.guid           = id.guid;
+    rec.kind           = id.kind;
+    rec.ordinal        = id.ordinal;
+    rec.wasRunning     = running;
+    rec.lastIterations = running ? 3 : 0;
+    rec.lastStartFlags = running ? DIES_SOLO : 0;
+    rec.hasParams      = true;
+    rec.params.dwSize  = sizeof(DIEFFECT);
+    rec.params.dwGain  = 7500;
+    rec.params.dwDuration = INFINITE;
+    rec.params.cAxes   = 1;
+    rec.axes[0]        = DIJOFS_X;
+    rec.directions[0]  = 9000;
+    rec.params.cbTypeSpecificParams = sizeof(DICONSTANTFORCE);
+    DICONSTANTFORCE cf = { magnitude };
+    std::memcpy(rec.typeSpecific, &cf, sizeof(cf));
+    return rec;
+}
+
+bool sameRecord(const EffectStateRecord& a, const EffectStateRecord& b) {
+    return std::memcmp(&a, &b, sizeof(EffectStateRecord)) == 0;
+}
+
+// Second read/write mapping of the journal file, for inflicting damage.
+class FileView {
+public:
+    FileView() {
+        m_file = CreateFileW(kFile, GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ,
+                             nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (m_file == INVALID_HANDLE_VALUE) return;
+        m_mapping = CreateFileMappingW(m_file, nullptr, PAGE_READWRITE, 0, 0, nullptr);
+        if (m_mapping)
+            m_data = static_cast<uint8_t*>(MapViewOfFile(m_mapping, FILE_MAP_WRITE, 0, 0, 0));
+    }
+    ~FileView() {
+        if (m_data) UnmapViewOfFile(m_data);
+        if (m_mapping) CloseHandle(m_mapping);
+        if (m_file != INVALID_HANDLE_VALUE) CloseHandle(m_file);
+    }
+
+    uint8_t* data() const { return m_data; }
+
+    // The journal slot holding exactly rec, or nullptr.
+    uint8_t* findSlot(const EffectStateRecord& rec, size_t bytes) const {
+        const size_t recOffset = 8;   // after seq and checksum
+        for (size_t off = 0; m_data && off + sizeof(rec) <= bytes; off += 8)
+            if (off >= recOffset && std::memcmp(m_data + off, &rec, sizeof(rec)) == 0)
+                return m_data + off - recOffset;
+        return nullptr;
+    }
+
+private:
+    HANDLE   m_file    = INVALID_HANDLE_VALUE;
+    HANDLE   m_mapping = nullptr;
+    uint8_t* m_data    = nullptr;
+};
+
+// Bytes of the journal file: header plus every slot.
+constexpr size_t kJournalBytes =
+    12288 + FFBStateRegistry::kMaxDevices * kDenseRecordCount * (8 + sizeof(EffectStateRecord));
+
+FFBStateJournal& journal() { return FFBStateJournal::instance(); }
+
+// Open (recovering whatever the last step left) and return the recovered set.
+std::vector<FFBStateJournal::Recovered> reopen() {
+    journal().close();
+    CHECK(journal().open(kDir, 0));
+    return journal().takeRecovered();
+}
+
+const FFBStateJournal::Recovered* findRecovered(
+    const std::vector<FFBStateJournal::Recovered>& all, const EffectInstanceId& id)
+{
+    for (const auto& r : all)
+        if (r.id.kind == id.kind && r.id.ordinal == id.ordinal &&
+            r.id.guid == id.guid)
+            return &r;
+    return nullptr;
+}
+
+const EffectInstanceId kConstant0 = instance(EffectKind::ConstantForce, GUID_ConstantForce, 0);
+const EffectInstanceId kConstant1 = instance(EffectKind::ConstantForce, GUID_ConstantForce, 1);
+const EffectInstanceId kSpring2   = instance(EffectKind::Spring, GUID_Spring, 2);
+const EffectInstanceId kSine0     = instance(EffectKind::Sine, GUID_Sine, 0);
+
+void testRoundTrip() {
+    reopen();   // start from a clean file
+
+    EffectStateRecord a = makeRecord(kConstant0, 4000, true);
+    EffectStateRecord b = makeRecord(kConstant1, -2500, false);
+    EffectStateRecord c = makeRecord(kSine0, 1234, true);
+    EffectStateRecord idle;   // neither running nor parameterised: not restored
+    idle.guid = GUID_Spring;
+    idle.kind = EffectKind::Spring;
+
+    journal().registerDevice(3, wheel());
+    journal().registerDevice(7, pedals());
+    journal().write(3, denseRecordIndex(kConstant0), a);
+    journal().write(3, denseRecordIndex(kConstant1), b);
+    journal().write(3, denseRecordIndex(kSpring2), idle);
+    journal().write(7, denseRecordIndex(kSine0), c);
+
+    auto rec = reopen();
+    CHECK_EQ(rec.size(), 3u);
+
+    const FFBStateJournal::Recovered* ra = findRecovered(rec, kConstant0);
+    const FFBStateJournal::Recovered* rb = findRecovered(rec, kConstant1);
+    const FFBStateJournal::Recovered* rc = findRecovered(rec, kSine0);
+    CHECK(ra && rb && rc);
+    if (!ra || !rb || !rc) return;
+    CHECK(sameRecord(ra->record, a));
+    CHECK(sameRecord(rb->record, b));
+    CHECK(sameRecord(rc->record, c));
+    CHECK(ra->device.productName == L"Journal Wheel");
+    CHECK(ra->device.instanceGuid == wheel().instanceGuid);
+    CHECK(ra->device.productGuid == wheel().productGuid);
+    CHECK(rc->device.productName == L"Journal Pedals");
+
+    // Recovery consumed the previous session; the file starts over.
+    CHECK_EQ(reopen().size(), 0u);
+}
+
+void testTornAndCorruptSlots() {
+    reopen();
+
+    EffectStateRecord torn    = makeRecord(kConstant0, 1111, true);
+    EffectStateRecord corrupt = makeRecord(kConstant1, 2222, true);
+    EffectStateRecord intact  = makeRecord(kSine0, 3333, true);
+    journal().registerDevice(0, wheel());
+    journal().write(0, denseRecordIndex(kConstant0), torn);
+    journal().write(0, denseRecordIndex(kConstant1), corrupt);
+    journal().write(0, denseRecordIndex(kSine0), intact);
+    journal().close();
+
+    {
+        FileView file;
+        CHECK(file.data() != nullptr);
+        uint8_t* tornSlot    = file.findSlot(torn, kJournalBytes);
+        uint8_t* corruptSlot = file.findSlot(corrupt, kJournalBytes);
+        CHECK(tornSlot && corruptSlot);
+        if (!tornSlot || !corruptSlot) return;
+
+        // A crash between the two sequence stores leaves it odd.
+        uint32_t seq;
+        std::memcpy(&seq, tornSlot, sizeof(seq));
+        seq += 1;
+        std::memcpy(tornSlot, &seq, sizeof(seq));
+
+        // A lost page or stray write changes the record under its checksum.
+        corruptSlot[8 + offsetof(EffectStateRecord, typeSpecific)] ^= 0x40;
+    }
+
+    CHECK(journal().open(kDir, 0));
+    auto rec = journal().takeRecovered();
+    CHECK_EQ(rec.size(), 1u);
+    CHECK(findRecovered(rec, kConstant0) == nullptr);
+    CHECK(findRecovered(rec, kConstant1) == nullptr);
+    const FFBStateJournal::Recovered* ri = findRecovered(rec, kSine0);
+    CHECK(ri && sameRecord(ri->record, intact));
+}
+
+void testVersionMismatch() {
+    reopen();
+    journal().registerDevice(1, wheel());
+    journal().write(1, denseRecordIndex(kConstant0), makeRecord(kConstant0, 5000, true));
+    journal().close();
+
+    {
+        FileView file;
+        CHECK(file.data() != nullptr);
+        if (!file.data()) return;
+        uint32_t version;
+        std::memcpy(&version, file.data() + 8, sizeof(version));
+        version += 1;   // a journal from another build
+        std::memcpy(file.data() + 8, &version, sizeof(version));
+    }
+
+    CHECK_EQ(reopen().size(), 0u);
+
+    // The file was started over in the current layout and works again.
+    EffectStateRecord again = makeRecord(kConstant0, 6000, true);
+    journal().registerDevice(1, wheel());
+    journal().write(1, denseRecordIndex(kConstant0), again);
+    auto rec = reopen();
+    CHECK_EQ(rec.size(), 1u);
+    CHECK(rec.size() == 1 && sameRecord(rec[0].record, again));
+}
+
+// The registry takes the recovered records and hands them to the device
+// when it is interned again, whatever handle the old session used.
+void testRegistryRestore() {
+    reopen();
+    EffectStateRecord a = makeRecord(kConstant0, 4321, true);
+    journal().registerDevice(42, wheel());
+    journal().write(42, denseRecordIndex(kConstant0), a);
+    journal().close();
+    CHECK(journal().open(kDir, 0));
+
+    FFBStateRegistry& reg = FFBStateRegistry::instance();
+    reg.restoreFromJournal();
+    FFBDeviceHandle h = reg.internDevice(wheel());
+    CHECK(h != kInvalidDeviceHandle);
+
+    DWORD iterations = 0, flags = 0;
+    CHECK(reg.wasRunning(h, kConstant0, iterations, flags));
+    CHECK_EQ(iterations, 3u);
+    CHECK_EQ(flags, static_cast<DWORD>(DIES_SOLO));
+
+    FFBDeviceSnapshotPtr snap = reg.snapshot(h);
+    const EffectStateRecord* r = snap->find(kConstant0);
+    CHECK(r && sameRecord(*r, a));
+    reg.releaseDevice(h);
+    journal().close();
+}
+
+} // namespace
+
+int main() {
+    testRoundTrip();
+    testTornAndCorruptSlots();
+    testVersionMismatch();
+    testRegistryRestore();
+    return TEST_RESULT();
+}
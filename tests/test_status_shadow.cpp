@@ -0,0 +1,190 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026 Valmantas Paliksa
+//
+// Status shadows ([FFB] StatusMaxAgeMs) against the mock device's own state.
+// Changes the wrapper sees (Start, Stop, Unload, DISFFC_* commands) keep
+// GetEffectStatus and GetForceFeedbackState in step with the device without
+// asking it. A change behind the wrapper's back (the device dropping an
+// effect) shows once the shadow is older than the bound; with AsyncCommands
+// a stale answer may be given while its refresh is queued, but never past
+// twice the bound, even when the worker is stuck behind slow device calls.
+
+#include "mock_dinput.h"
+#include "test_util.h"
+
+namespace {
+
+constexpr DWORD kMaxAgeMs = 40;
+
+bool reportsPlaying(IDirectInputEffect* e) {
+    DWORD s = 0;
+    CHECK_EQ(e->GetEffectStatus(&s), DI_OK);
+    return (s & DIEGES_PLAYING) != 0;
+}
+
+DWORD ffState(MockDeviceSession& s) {
+    DWORD flags = 0;
+    CHECK_EQ(s.wrapper->GetForceFeedbackState(&flags), DI_OK);
+    return flags;
+}
+
+void settle(MockDeviceSession& s) {
+    if (FFBDeviceWorker* worker = s.filter->worker())
+        worker->waitIdle();
+}
+
+// The device's answer, to compare with the wrapper's.
+bool devicePlaying(MockEffect* m, MockDevice* d) { return m->playing() && !d->paused(); }
+
+constexpr DWORD kStateMask = DIGFFS_PAUSED | DIGFFS_STOPPED | DIGFFS_EMPTY |
+                             DIGFFS_ACTUATORSON | DIGFFS_ACTUATORSOFF;
+
+// Each step through the wrapper, then both answers against the device's.
+// Only a Stop or Unload may cost one GetForceFeedbackState: whether the
+// last playing effect went is the device's to say.
+void testVisibleTransitions(bool async) {
+    std::printf("-- visible transitions (%s)\n", async ? "async" : "sync");
+    Config::instance().ffbStatusMaxAgeMs = 1000;   // no refresh during the test
+    FFBPolicy policy = mockPolicy();
+    policy.asyncCommands = async;
+    MockDeviceSession s(policy, mockIdentity(async ? L"Shadow Wheel A" : L"Shadow Wheel S"));
+    IDirectInputEffect* a = s.create(GUID_ConstantForce);
+    IDirectInputEffect* b = s.create(GUID_Sine);
+    CHECK(a && b);
+    if (!a || !b) return;
+    MockEffect *ma = s.mock(0), *mb = s.mock(1);
+
+    // Nothing known yet: these ask the device and fill the shadows.
+    CHECK(!reportsPlaying(a) && !reportsPlaying(b));
+    ffState(s);
+
+    auto step = [&](const char* what, bool mayQueryState, auto&& op) {
+        op();
+        settle(s);
+        int status = ma->statusCalls.load() + mb->statusCalls.load();
+        int state  = s.device->stateCalls.load();
+        bool pa = reportsPlaying(a), pb = reportsPlaying(b);
+        DWORD flags = ffState(s);
+        if (pa != devicePlaying(ma, s.device) || pb != devicePlaying(mb, s.device) ||
+            (flags & kStateMask) != (s.device->ffState() & kStateMask))
+            std::fprintf(stderr, "  shadow differs after %s\n", what);
+        CHECK_EQ(pa, devicePlaying(ma, s.device));
+        CHECK_EQ(pb, devicePlaying(mb, s.device));
+        CHECK_EQ(flags & kStateMask, s.device->ffState() & kStateMask);
+        CHECK_EQ(ma->statusCalls.load() + mb->statusCalls.load(), status);
+        CHECK(s.device->stateCalls.load() - state <= (mayQueryState ? 1 : 0));
+    };
+    auto command = [&](DWORD c) { CHECK_EQ(s.wrapper->SendForceFeedbackCommand(c), DI_OK); };
+
+    step("Start a",      false, [&] { CHECK_EQ(a->Start(1, 0), DI_OK); });
+    step("Start b",      false, [&] { CHECK_EQ(b->Start(INFINITE, 0), DI_OK); });
+    step("Stop a",       true,  [&] { CHECK_EQ(a->Stop(), DI_OK); });
+    step("PAUSE",        false, [&] { command(DISFFC_PAUSE); });
+    step("CONTINUE",     false, [&] { command(DISFFC_CONTINUE); });
+    step("STOPALL",      false, [&] { command(DISFFC_STOPALL); });
+    step("Start a",      false, [&] { CHECK_EQ(a->Start(1, 0), DI_OK); });
+    step("Unload a",     true,  [&] { CHECK_EQ(a->Unload(), DI_OK); });
+    step("Start b",      false, [&] { CHECK_EQ(b->Start(1, 0), DI_OK); });
+    step("ACTUATORSOFF", false, [&] { command(DISFFC_SETACTUATORSOFF); });
+    step("ACTUATORSON",  false, [&] { command(DISFFC_SETACTUATORSON); });
+    step("RESET",        false, [&] { command(DISFFC_RESET); });
+}
+
+// The device drops an effect on its own; synchronous mode sees it as soon as
+// the shadow is older than the bound.
+void testHiddenChangeSync() {
+    std::printf("-- hidden change (sync)\n");
+    Config::instance().ffbStatusMaxAgeMs = kMaxAgeMs;
+    MockDeviceSession s(mockPolicy(), mockIdentity(L"Hidden Sync Wheel"));
+    IDirectInputEffect* a = s.create(GUID_ConstantForce);
+    CHECK(a != nullptr);
+    if (!a) return;
+    MockEffect* ma = s.mock(0);
+
+    CHECK_EQ(a->Start(1, 0), DI_OK);
+    ULONGLONG synced = GetTickCount64();
+    ma->deviceStop();
+    while (GetTickCount64() - synced <= kMaxAgeMs) {
+        reportsPlaying(a);   // may still say playing: within the bound
+        Sleep(5);
+    }
+    CHECK(!reportsPlaying(a));
+}
+
+// AsyncCommands with the worker stuck behind a slow Start: a stale answer
+// comes from the shadow, but past twice the bound the device is asked.
+void testHiddenChangeAsyncBounded() {
+    std::printf("-- hidden change, stuck worker (async)\n");
+    Config::instance().ffbStatusMaxAgeMs = kMaxAgeMs;
+    FFBPolicy policy = mockPolicy();
+    policy.asyncCommands = true;
+    MockDeviceSession s(policy, mockIdentity(L"Hidden Async Wheel"));
+    IDirectInputEffect* a = s.create(GUID_ConstantForce);
+    IDirectInputEffect* b = s.create(GUID_ConstantForce);
+    CHECK(a && b);
+    if (!a || !b) return;
+    MockEffect* ma = s.mock(0);
+
+    CHECK_EQ(a->Start(1, 0), DI_OK);
+    settle(s);
+    ULONGLONG synced = GetTickCount64();
+    ma->deviceStop();                       // behind the wrapper's back
+
+    s.device->latencyMs = 300;
+    CHECK_EQ(b->Start(1, 0), DI_OK);       // occupies the worker for a while
+
+    // Within the bound and while the refresh waits: the shadow answers at once.
+    Sleep(kMaxAgeMs + 10);
+    auto t = std::chrono::steady_clock::now();
+    reportsPlaying(a);
+    CHECK(secondsSince(t) < 0.1);
+
+    // Past twice the bound the answer is the device's, however long it takes.
+    while (GetTickCount64() - synced <= 2 * kMaxAgeMs) Sleep(5);
+    CHECK(!reportsPlaying(a));
+    s.device->latencyMs = 0;
+    settle(s);
+}
+
+// The same bound for GetForceFeedbackState: the device's actuators switched
+// off behind the wrapper's back.
+void testDeviceStateAsyncBounded() {
+    std::printf("-- device state, stuck worker (async)\n");
+    Config::instance().ffbStatusMaxAgeMs = kMaxAgeMs;
+    FFBPolicy policy = mockPolicy();
+    policy.asyncCommands = true;
+    MockDeviceSession s(policy, mockIdentity(L"State Async Wheel"));
+    IDirectInputEffect* b = s.create(GUID_ConstantForce);
+    CHECK(b != nullptr);
+    if (!b) return;
+
+    ffState(s);                             // nothing known: syncs the shadow
+    ULONGLONG synced = GetTickCount64();
+    CHECK(ffState(s) & DIGFFS_ACTUATORSON);
+
+    s.device->SendForceFeedbackCommand(DISFFC_SETACTUATORSOFF);   // not through the wrapper
+    s.device->latencyMs = 300;
+    CHECK_EQ(b->Start(1, 0), DI_OK);
+
+    Sleep(kMaxAgeMs + 10);
+    auto t = std::chrono::steady_clock::now();
+    ffState(s);
+    CHECK(secondsSince(t) < 0.1);
+
+    while (GetTickCount64() - synced <= 2 * kMaxAgeMs) Sleep(5);
+    CHECK(ffState(s) & DIGFFS_ACTUATORSOFF);
+    s.device->latencyMs = 0;
+    settle(s);
+}
+
+} // namespace
+
+int main() {
+    testVisibleTransitions(false);
+    testVisibleTransitions(true);
+    testHiddenChangeSync();
+    testHiddenChangeAsyncBounded();
+    testDeviceStateAsyncBounded();
+    Config::instance().ffbStatusMaxAgeMs = 0;
+    return TEST_RESULT();
+}
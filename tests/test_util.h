@@ -0,0 +1,47 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026 Valmantas Paliksa
+#pragma once
+
+#include <chrono>
+#include <cstdio>
+
+// Minimal check macros for the unit tests. A failed check prints the
+// location and keeps going; TEST_RESULT() turns the failure count into the
+// process exit code CTest looks at.
+
+inline int& testFailures() {
+    static int failures = 0;
+    return failures;
+}
+
+#define CHECK(cond)                                                          \
+    do {                                                                     \
+        if (!(cond)) {                                                       \
+            std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n",                \
+                         __FILE__, __LINE__, #cond);                         \
+            ++testFailures();                                                \
+        }                                                                    \
+    } while (0)
+
+#define CHECK_EQ(a, b)                                                       \
+    do {                                                                     \
+        auto va_ = (a);                                                      \
+        auto vb_ = (b);                                                      \
+        if (!(va_ == vb_)) {                                                 \
+            std::fprintf(stderr, "%s:%d: CHECK_EQ(%s, %s) failed: %lld != %lld\n", \
+                         __FILE__, __LINE__, #a, #b,                         \
+                         static_cast<long long>(va_),                        \
+                         static_cast<long long>(vb_));                       \
+            ++testFailures();                                                \
+        }                                                                    \
+    } while (0)
+
+#define TEST_RESULT()                                                        \
+    (testFailures() ? (std::fprintf(stderr, "%d check(s) failed\n",         \
+                                    testFailures()), 1)                      \
+                    : (std::printf("all checks passed\n"), 0))
+
+// Wall-clock helper for the benchmarks.
+inline double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
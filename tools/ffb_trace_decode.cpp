@@ -0,0 +1,334 @@
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2026 Valmantas Paliksa
+//
+// ffb_trace_decode — turn a dinput8_ffb_trace.bin into text or CSV.
+//
+// Portable C++17 (no Windows headers), so traces captured on the rig can be
+// analysed on Linux:
+//
+//   ffb_trace_decode dinput8_ffb_trace.bin            # human-readable text
+//   ffb_trace_decode --csv dinput8_ffb_trace.bin > trace.csv
+//
+#include "ffb_trace_format.h"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// ============================================================================
+// Helpers
+// ============================================================================
+
+// UTF-16LE device name → UTF-8
+static std::string utf16ToUtf8(const uint16_t* s, size_t max) {
+    std::string out;
+    for (size_t i = 0; i < max && s[i]; ++i) {
+        uint32_t cp = s[i];
+        if (cp >= 0xD800 && cp <= 0xDBFF && i + 1 < max &&
+            s[i + 1] >= 0xDC00 && s[i + 1] <= 0xDFFF) {
+            cp = 0x10000 + ((cp - 0xD800) << 10) + (s[i + 1] - 0xDC00);
+            ++i;
+        }
+        if (cp < 0x80) {
+            out += static_cast<char>(cp);
+        } else if (cp < 0x800) {
+            out += static_cast<char>(0xC0 | (cp >> 6));
+            out += static_cast<char>(0x80 | (cp & 0x3F));
+        } else if (cp < 0x10000) {
+            out += static_cast<char>(0xE0 | (cp >> 12));
+            out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (cp & 0x3F));
+        } else {
+            out += static_cast<char>(0xF0 | (cp >> 18));
+            out += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+            out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (cp & 0x3F));
+        }
+    }
+    return out;
+}
+
+static int32_t readI32(const uint8_t* p) {
+    int32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static uint32_t readU32(const uint8_t* p) {
+    uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static void appendf(std::string& out, const char* fmt, ...) {
+    char buf[256];
+    va_list args;
+    va_start(args, fmt);
+    vsnprintf(buf, sizeof(buf), fmt, args);
+    va_end(args);
+    out += buf;
+}
+
+// Decode the flattened type-specific block according to the effect type.
+// sep separates fields (" " for text, ";" inside a CSV cell).
+static std::string decodeTypeSpecific(const FFBTraceRecord& r, const char* sep) {
+    std::string out;
+    const uint8_t* p = r.typeSpecific;
+    uint32_t n = std::min<uint32_t>(r.typeSpecificBytes, kFFBTraceTypeSpecificBytes);
+    auto effect = static_cast<FFBTraceEffect>(r.effect);
+
+    switch (effect) {
+    case FFBTraceEffect::ConstantForce:
+        if (n >= 4) appendf(out, "magnitude=%d", readI32(p));
+        break;
+    case FFBTraceEffect::RampForce:
+        if (n >= 8) appendf(out, "start=%d%send=%d", readI32(p), sep, readI32(p + 4));
+        break;
+    case FFBTraceEffect::Square:
+    case FFBTraceEffect::Sine:
+    case FFBTraceEffect::Triangle:
+    case FFBTraceEffect::SawtoothUp:
+    case FFBTraceEffect::SawtoothDown:
+        if (n >= 16)
+            appendf(out, "magnitude=%u%soffset=%d%sphase=%u%speriod=%u",
+                    readU32(p), sep, readI32(p + 4), sep, readU32(p + 8), sep,
+                    readU32(p + 12));
+        break;
+    case FFBTraceEffect::Spring:
+    case FFBTraceEffect::Damper:
+    case FFBTraceEffect::Inertia:
+    case FFBTraceEffect::Friction:
+        for (uint32_t off = 0, axis = 0; off + 24 <= n; off += 24, ++axis) {
+            if (axis) out += sep;
+            appendf(out, "cond%u={offset=%d%spos=%d%sneg=%d%spsat=%u%snsat=%u%sdeadband=%d}",
+                    axis, readI32(p + off), sep, readI32(p + off + 4), sep,
+                    readI32(p + off + 8), sep, readU32(p + off + 12), sep,
+                    readU32(p + off + 16), sep, readI32(p + off + 20));
+        }
+        break;
+    case FFBTraceEffect::CustomForce:
+        if (n >= 12) {
+            appendf(out, "channels=%u%ssamplePeriod=%u%ssamples=%u%sdata=[",
+                    readU32(p), sep, readU32(p + 4), sep, readU32(p + 8), sep);
+            for (uint32_t off = 12; off + 4 <= n; off += 4) {
+                if (off > 12) out += ' ';
+                appendf(out, "%d", readI32(p + off));
+            }
+            out += ']';
+        }
+        break;
+    default:
+        for (uint32_t i = 0; i < n; ++i) appendf(out, "%02x", p[i]);
+        break;
+    }
+
+    if (r.payloadFlags & kFFBTraceTypeSpecTruncated) {
+        if (!out.empty()) out += sep;
+        out += "truncated";
+    }
+    return out;
+}
+
+static std::string joinAxes(const FFBTraceRecord& r, bool directions) {
+    std::string out;
+    uint32_t n = std::min<uint32_t>(r.cAxes, kFFBTraceMaxAxes);
+    for (uint32_t i = 0; i < n; ++i) {
+        if (i) out += ' ';
+        if (directions) appendf(out, "%d", r.directions[i]);
+        else            appendf(out, "0x%x", r.axes[i]);
+    }
+    return out;
+}
+
+// ============================================================================
+// Output
+// ============================================================================
+struct DecodeContext {
+    FFBTraceFileHeader       header;
+    std::vector<std::string> deviceNames;
+};
+
+static double seconds(const DecodeContext& ctx, const FFBTraceRecord& r) {
+    if (!ctx.header.ticksPerSecond) return 0.0;
+    return static_cast<double>(static_cast<int64_t>(r.timestamp - ctx.header.startTicks)) /
+           static_cast<double>(ctx.header.ticksPerSecond);
+}
+
+static const std::string& deviceName(const DecodeContext& ctx, uint16_t id) {
+    static const std::string unknown = "<unknown>";
+    return id < ctx.deviceNames.size() ? ctx.deviceNames[id] : unknown;
+}
+
+static void printText(const DecodeContext& ctx, const FFBTraceRecord& r) {
+    std::string line;
+    appendf(line, "[%12.6f] #%-8" PRIu64 " [%s] %s#%u %s hr=0x%08x",
+            seconds(ctx, r), r.sequence, deviceName(ctx, r.deviceId).c_str(),
+            ffbTraceEffectName(r.effect), r.effectSerial,
+            ffbTraceMethodName(r.method), static_cast<uint32_t>(r.hresult));
+
+    switch (static_cast<FFBTraceMethod>(r.method)) {
+    case FFBTraceMethod::Start:
+    case FFBTraceMethod::AutoRestart:
+        appendf(line, " iterations=%u flags=0x%x", r.arg0, r.arg1);
+        break;
+    case FFBTraceMethod::SetParameters:
+        appendf(line, " diep=0x%x%s", r.arg0,
+                r.arg1 == kFFBTraceParamsSuppressed ? " suppressed" :
+                r.arg1 == kFFBTraceParamsQueued     ? " queued"     : "");
+        break;
+    case FFBTraceMethod::SendCommand:
+        appendf(line, " command=0x%x", r.arg0);
+        break;
+    case FFBTraceMethod::GetEffectStatus:
+    case FFBTraceMethod::GetForceFeedbackState:
+        appendf(line, " status=0x%x%s", r.arg1,
+                r.arg0 == kFFBTraceStatusShadow ? " shadow" : "");
+        break;
+    default:
+        break;
+    }
+
+    if (r.payloadFlags & kFFBTraceHasParams) {
+        appendf(line, " | flags=0x%x duration=%u gain=%u samplePeriod=%u startDelay=%u"
+                      " trigger=%u/%u axes=[%s] dir=[%s]",
+                r.dwFlags, r.dwDuration, r.dwGain, r.dwSamplePeriod, r.dwStartDelay,
+                r.dwTriggerButton, r.dwTriggerRepeatInterval,
+                joinAxes(r, false).c_str(), joinAxes(r, true).c_str());
+        if (r.payloadFlags & kFFBTraceHasEnvelope)
+            appendf(line, " env={attack=%u/%u fade=%u/%u}",
+                    r.attackLevel, r.attackTime, r.fadeLevel, r.fadeTime);
+        std::string ts = decodeTypeSpecific(r, " ");
+        if (!ts.empty()) line += " " + ts;
+    }
+
+    puts(line.c_str());
+}
+
+static void printCsvHeader() {
+    puts("sequence,time_s,device_id,device,effect_serial,effect,method,hresult,"
+         "arg0,arg1,has_params,flags,duration,gain,sample_period,start_delay,"
+         "trigger_button,trigger_repeat,axes,directions,attack_level,attack_time,"
+         "fade_level,fade_time,type_specific_bytes,type_specific");
+}
+
+static std::string csvQuote(const std::string& s) {
+    std::string out = "\"";
+    for (char c : s) {
+        if (c == '"') out += '"';
+        out += c;
+    }
+    out += '"';
+    return out;
+}
+
+static void printCsv(const DecodeContext& ctx, const FFBTraceRecord& r) {
+    bool hasParams = (r.payloadFlags & kFFBTraceHasParams) != 0;
+    bool hasEnv    = (r.payloadFlags & kFFBTraceHasEnvelope) != 0;
+
+    std::string line;
+    appendf(line, "%" PRIu64 ",%.6f,%u,", r.sequence, seconds(ctx, r), r.deviceId);
+    line += csvQuote(deviceName(ctx, r.deviceId));
+    appendf(line, ",%u,%s,%s,0x%08x,%u,%u,%d,",
+            r.effectSerial, ffbTraceEffectName(r.effect), ffbTraceMethodName(r.method),
+            static_cast<uint32_t>(r.hresult), r.arg0, r.arg1, hasParams ? 1 : 0);
+    if (hasParams) {
+        appendf(line, "0x%x,%u,%u,%u,%u,%u,%u,", r.dwFlags, r.dwDuration, r.dwGain,
+                r.dwSamplePeriod, r.dwStartDelay, r.dwTriggerButton,
+                r.dwTriggerRepeatInterval);
+        line += csvQuote(joinAxes(r, false)) + "," + csvQuote(joinAxes(r, true)) + ",";
+    } else {
+        line += ",,,,,,,,,";
+    }
+    if (hasEnv)
+        appendf(line, "%u,%u,%u,%u,", r.attackLevel, r.attackTime, r.fadeLevel, r.fadeTime);
+    else
+        line += ",,,,";
+    if (hasParams) {
+        appendf(line, "%u,", r.cbTypeSpecific);
+        line += csvQuote(decodeTypeSpecific(r, ";"));
+    } else {
+        line += ",";
+    }
+    puts(line.c_str());
+}
+
+// ============================================================================
+// main
+// ============================================================================
+static int usage(const char* argv0) {
+    fprintf(stderr, "usage: %s [--csv] <dinput8_ffb_trace.bin>\n", argv0);
+    return 2;
+}
+
+int main(int argc, char** argv) {
+    bool csv = false;
+    const char* path = nullptr;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--csv") == 0) csv = true;
+        else if (argv[i][0] == '-')             return usage(argv[0]);
+        else if (!path)                         path = argv[i];
+        else                                    return usage(argv[0]);
+    }
+    if (!path) return usage(argv[0]);
+
+    FILE* f = fopen(path, "rb");
+    if (!f) {
+        fprintf(stderr, "cannot open %s\n", path);
+        return 1;
+    }
+
+    DecodeContext ctx;
+    if (fread(&ctx.header, sizeof(ctx.header), 1, f) != 1 ||
+        std::memcmp(ctx.header.magic, kFFBTraceMagic, sizeof(kFFBTraceMagic)) != 0)
+    {
+        fprintf(stderr, "%s: not an FFB trace file\n", path);
+        fclose(f);
+        return 1;
+    }
+    if (ctx.header.version != kFFBTraceVersion ||
+        ctx.header.recordSize != sizeof(FFBTraceRecord) ||
+        ctx.header.headerSize < sizeof(FFBTraceFileHeader))
+    {
+        fprintf(stderr, "%s: unsupported trace version %u (record size %u)\n",
+                path, ctx.header.version, ctx.header.recordSize);
+        fclose(f);
+        return 1;
+    }
+
+    uint32_t devices = std::min(ctx.header.deviceCount, kFFBTraceMaxDevices);
+    for (uint32_t i = 0; i < devices; ++i)
+        ctx.deviceNames.push_back(utf16ToUtf8(ctx.header.devices[i].name, kFFBTraceNameChars));
+
+    // Read every slot, keep the written ones and restore call order. The file
+    // may have wrapped, so slot order is not sequence order.
+    std::vector<FFBTraceRecord> records;
+    if (fseek(f, static_cast<long>(ctx.header.headerSize), SEEK_SET) == 0) {
+        FFBTraceRecord r;
+        for (uint64_t i = 0; i < ctx.header.capacity &&
+                             fread(&r, sizeof(r), 1, f) == 1; ++i) {
+            if (r.sequence) records.push_back(r);
+        }
+    }
+    fclose(f);
+
+    std::sort(records.begin(), records.end(),
+              [](const FFBTraceRecord& a, const FFBTraceRecord& b) {
+                  return a.sequence < b.sequence;
+              });
+
+    if (csv) {
+        printCsvHeader();
+        for (const auto& r : records) printCsv(ctx, r);
+    } else {
+        printf("# %zu record(s), %u device(s), capacity %" PRIu64 "\n",
+               records.size(), devices, ctx.header.capacity);
+        for (uint32_t i = 0; i < devices; ++i)
+            printf("# device %u: %s\n", i, ctx.deviceNames[i].c_str());
+        for (const auto& r : records) printText(ctx, r);
+    }
+    return 0;
+}